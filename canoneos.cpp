@@ -157,36 +157,66 @@ uint16_t CanonEOS::SetExtendedEventInfo(uint8_t mode)
 	return Operation(EOS_OC_SetExtendedEventInfo, 1, params);
 }
 
-uint16_t CanonEOS::StartBulb()
+uint16_t CanonEOS::PCHDDCapacity(uint32_t free_clusters, uint32_t cluster_size, uint32_t flags)
 {
 	uint32_t	params[3];
 
-	params[0] = 0xfffffff8;
-	params[1] = 0x00001000;
-	params[2] = 0x00000000;
+	params[0] = free_clusters;
+	params[1] = cluster_size;
+	params[2] = flags;
+
+	return Operation(EOS_OC_PCHDDCapacity, 3, params);
+}
+
+uint16_t CanonEOS::SetUILock()
+{
+	return Operation(EOS_OC_SetUILock, 0, NULL);
+}
+
+uint16_t CanonEOS::ResetUILock()
+{
+	return Operation(EOS_OC_ResetUILock, 0, NULL);
+}
+
+uint16_t CanonEOS::BulbStart()
+{
+	return Operation(EOS_OC_BulbStart, 0, NULL);
+}
+
+uint16_t CanonEOS::BulbEnd()
+{
+	return Operation(EOS_OC_BulbEnd, 0, NULL);
+}
+
+uint16_t CanonEOS::StartBulb()
+{
+	uint16_t	ptp_error;
 
-	Operation(0x911A, 3, params);
-	Operation(0x911B, 0, NULL);
-	Operation(0x9125, 0, NULL);
+	if ((ptp_error = PCHDDCapacity(0xfffffff8)) != PTP_RC_OK
+		|| (ptp_error = SetUILock()) != PTP_RC_OK
+		|| (ptp_error = BulbStart()) != PTP_RC_OK)
+		PTPTRACE2("StartBulb error:", ptp_error);
 
-	return PTP_RC_OK;
+	return ptp_error;
 }
 
 uint16_t CanonEOS::StopBulb()
 {
-	uint32_t	params[3];
+	uint16_t	ptp_error;
+
+	PCHDDCapacity(0xffffffff);
+	PCHDDCapacity(0xfffffffc);
+
+	// the shutter has to be closed and the UI unlocked no matter what
+	if ((ptp_error = BulbEnd()) != PTP_RC_OK)
+		PTPTRACE2("BulbEnd error:", ptp_error);
+
+	uint16_t	rc = ResetUILock();
+
+	if (rc != PTP_RC_OK)
+		PTPTRACE2("ResetUILock error:", rc);
 
-    params[0] = 0xffffffff;
-	params[1] = 0x00001000;
-	params[2] = 0x00000000;
-	Operation(0x911A, 3, params);
-    
-    params[0] = 0xfffffffc;
-	Operation(0x911A, 3, params);
-	Operation(0x9126, 0, NULL);
-	Operation(0x911C, 0, NULL);
-
-	return PTP_RC_OK;
+	return (ptp_error != PTP_RC_OK) ? ptp_error : rc;
 }
 
 uint16_t CanonEOS::CancelTransfer(uint32_t object_id)
@@ -205,6 +235,14 @@ uint16_t CanonEOS::ResetTransfer(uint32_t object_id)
 	return Operation(EOS_OC_ResetTransfer, 1, params);
 }
 
+uint16_t CanonEOS::TransferComplete(uint32_t object_id)
+{
+	uint32_t	params[1];
+	params[0] = object_id;
+
+	return Operation(EOS_OC_TransferComplete, 1, params);
+}
+
 uint16_t CanonEOS::SwitchLiveView(bool on)
 {
 	uint16_t	ptp_error = PTP_RC_GeneralError;
@@ -310,3 +348,27 @@ uint16_t CanonEOS::GetObject(uint32_t object_id, uint32_t parent_id, PTPReadPars
 
 	return ptp_error;
 }
+
+uint16_t CanonEOS::DigitalZoom(uint16_t magnify)
+{
+	uint16_t	ptp_error	= PTP_RC_GeneralError;
+	OperFlags	flags		= { 1, 0, 0, 0, 0, 0 };
+	uint32_t	params[1];
+
+	params[0] = (uint32_t) magnify;
+
+	if ( (ptp_error = Transaction(EOS_OC_Zoom, &flags, params, NULL)) != PTP_RC_OK)
+		PTPTRACE2("DigitalZoom error: ", ptp_error);
+
+	return ptp_error;
+}
+
+uint16_t CanonEOS::GetLiveViewPicture(PTPReadParser *parser)
+{
+	OperFlags	flags		= { 1, 0, 0, 1, 1, 0 };
+	uint32_t	params[1];
+
+	params[0] = 0x00100000;
+
+	return Transaction(EOS_OC_GetLiveViewPicture, &flags, params, parser);
+}
@@ -39,9 +39,22 @@ e-mail   :  support@circuitsathome.com
 #define EOS_OC_TransferComplete				0x9117
 #define EOS_OC_CancelTransfer				0x9118
 #define EOS_OC_ResetTransfer				0x9119
+#define EOS_OC_PCHDDCapacity				0x911A
+#define EOS_OC_SetUILock				0x911B
+#define EOS_OC_ResetUILock				0x911C
+#define EOS_OC_BulbStart				0x9125
+#define EOS_OC_BulbEnd					0x9126
 #define EOS_OC_GetDevicePropValue 			0x9127
 #define EOS_OC_GetLiveViewPicture			0x9153
 #define EOS_OC_MoveFocus				0x9155
+#define EOS_OC_Zoom					0x9158
+#define EOS_OC_ZoomPosition				0x9159
+
+// Object Format Codes (EOS specific)
+#define EOS_OFC_CRW					0xB101
+#define EOS_OFC_CR2					0xB103
+#define EOS_OFC_MOV					0xB104
+#define EOS_OFC_CR3					0xB108
 
 // PTP Device Properties
 #define EOS_DPC_CameraDescription			0xD402
@@ -138,6 +151,12 @@ public:
 	uint16_t Capture();
 	uint16_t StartBulb();
 	uint16_t StopBulb();
+	// single steps of the bulb sequence, StartBulb/StopBulb issue all of them
+	uint16_t PCHDDCapacity(uint32_t free_clusters, uint32_t cluster_size = 0x1000, uint32_t flags = 0);
+	uint16_t SetUILock();
+	uint16_t ResetUILock();
+	uint16_t BulbStart();
+	uint16_t BulbEnd();
 	uint16_t SwitchLiveView(bool on);
 	uint16_t MoveFocus(uint16_t step);
 	uint16_t SetProperty(uint16_t prop, uint32_t val);
@@ -150,9 +169,13 @@ public:
 	uint16_t GetObject(uint32_t object_id, uint32_t parent_id, PTPReadParser *parser);
 	uint16_t ResetTransfer(uint32_t object_id);
 	uint16_t CancelTransfer(uint32_t object_id);
+	uint16_t TransferComplete(uint32_t object_id);
 
 	virtual uint16_t EventCheck(PTPReadParser *parser);
+	// live view magnification: 1 - off, 5 or 10
 	uint16_t DigitalZoom(uint16_t magnify);
+	// one live view frame, the JPEG wrapped in EOS records
+	uint16_t GetLiveViewPicture(PTPReadParser *parser);
 
 };
 
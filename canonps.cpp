@@ -74,3 +74,87 @@ uint16_t CanonPS::Capture()
 	return ptp_error;
 }
 
+uint16_t CanonPS::ViewfinderOn()
+{
+	uint16_t	ptp_error;
+
+	if ((ptp_error = Operation(PS_OC_ViewfinderOn, 0, NULL)) != PTP_RC_OK)
+		PTPTRACE2("ViewfinderOn failed: ", ptp_error);
+
+	return ptp_error;
+}
+
+uint16_t CanonPS::ViewfinderOff()
+{
+	uint16_t	ptp_error;
+
+	if ((ptp_error = Operation(PS_OC_ViewfinderOff, 0, NULL)) != PTP_RC_OK)
+		PTPTRACE2("ViewfinderOff failed: ", ptp_error);
+
+	return ptp_error;
+}
+
+uint16_t CanonPS::GetViewfinderImage(PTPReadParser *parser)
+{
+	OperFlags	flags = { 0, 0, 0, 1, 1, 0 };
+
+	return Transaction(PS_OC_GetViewfinderImage, &flags, NULL, parser);
+}
+
+uint16_t CanonPS::GetChanges(PTPReadParser *parser)
+{
+	uint16_t	ptp_error;
+	OperFlags	flags = { 0, 0, 0, 1, 1, 0 };
+
+	if ((ptp_error = Transaction(PS_OC_GetChanges, &flags, NULL, parser)) != PTP_RC_OK)
+		PTPTRACE2("GetChanges failed: ", ptp_error);
+
+	return ptp_error;
+}
+
+uint16_t CanonPS::GetObjectSize(uint32_t handle, uint32_t &size)
+{
+	uint16_t	ptp_error;
+	OperFlags	flags = { 2, 1, 0, 0, 0, 0 };
+	uint32_t	params[2];
+
+	params[0] = handle;
+	params[1] = 0;
+
+	if ((ptp_error = Transaction(PS_OC_GetObjectSize, &flags, params, NULL)) == PTP_RC_OK)
+		size = params[0];
+	else
+		PTPTRACE2("GetObjectSize failed: ", ptp_error);
+
+	return ptp_error;
+}
+
+uint16_t CanonPS::GetFolderEntries(uint32_t storage_id, uint32_t parent, PTPReadParser *parser)
+{
+	uint16_t	ptp_error;
+	OperFlags	flags = { 4, 0, 0, 1, 1, 0 };
+	uint32_t	params[4];
+
+	params[0] = storage_id;
+	params[1] = 0;
+	params[2] = parent;
+	params[3] = 0;				// all entries
+
+	if ((ptp_error = Transaction(PS_OC_GetFolderEntries, &flags, params, parser)) != PTP_RC_OK)
+		PTPTRACE2("GetFolderEntries failed: ", ptp_error);
+
+	return ptp_error;
+}
+
+uint16_t CanonPS::GetPartialObject(uint32_t handle, uint32_t offset, uint32_t size, uint32_t pos, PTPReadParser *parser)
+{
+	OperFlags	flags = { 4, 0, 0, 1, 1, 0 };
+	uint32_t	params[4];
+
+	params[0] = handle;
+	params[1] = offset;
+	params[2] = size;
+	params[3] = pos;
+
+	return Transaction(PS_OC_GetPartialObject, &flags, params, parser);
+}
@@ -34,6 +34,11 @@ e-mail   :  support@circuitsathome.com
 #define PS_OC_GetViewfinderImage			0x901d
 #define PS_OC_GetChanges					0x9020
 #define PS_OC_GetFolderEntries				0x9021
+
+// PS_OC_GetPartialObject transfer position
+#define PS_PARTIAL_FIRST					1
+#define PS_PARTIAL_MIDDLE					2
+#define PS_PARTIAL_LAST						3
  
 // PTP PowerShot Extention Events
 #define PS_EC_ShutDownCFDoorWasOpened		0xC001		/* The Device has shut down due to the opening of the SD card cover.*/
@@ -160,6 +165,24 @@ public:
 
 	uint16_t Capture();
 	uint16_t EventCheck(PTPReadParser *parser);
+
+	uint16_t ViewfinderOn();
+	uint16_t ViewfinderOff();
+	// One viewfinder frame (JPEG) per call, the viewfinder has to be turned on
+	uint16_t GetViewfinderImage(PTPReadParser *parser);
+
+	// Codes of the properties changed since the last call, uint32_t count followed by uint16_t codes
+	uint16_t GetChanges(PTPReadParser *parser);
+
+	// Object size without GetObjectInfo
+	uint16_t GetObjectSize(uint32_t handle, uint32_t &size);
+
+	// All entries of a folder in one transaction, see PSFolderEntryParser
+	uint16_t GetFolderEntries(uint32_t storage_id, uint32_t parent, PTPReadParser *parser);
+
+	// pos: PS_PARTIAL_FIRST, PS_PARTIAL_MIDDLE or PS_PARTIAL_LAST chunk of the object
+	using PTP::GetPartialObject;
+	uint16_t GetPartialObject(uint32_t handle, uint32_t offset, uint32_t size, uint32_t pos, PTPReadParser *parser);
 };
 
 #endif // __CANONPS_H__
\ No newline at end of file
@@ -0,0 +1,276 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "eosbracket.h"
+
+EOSBracket::EOSBracket(CanonEOS *eos, EOSEventHandlers *next) :
+	EOSEventForwarder(next),
+	pEOS(eos),
+	evtParser(this),
+	ecCount(0),
+	ecCurrent(0),
+	bracketMode(0),
+	seqSize(0),
+	seqPos(0),
+	theState(stIdle),
+	setsLeft(0),
+	setInterval(0),
+	timeSetStart(0)
+{
+	ResetStats();
+}
+
+void EOSBracket::ResetStats()
+{
+	theStats.numSets	= 0;
+	theStats.numFrames	= 0;
+	theStats.numErrors	= 0;
+	theStats.numBusy	= 0;
+	theStats.timeLast	= 0;
+	theStats.timeMin	= 0xFFFFFFFF;
+	theStats.timeMax	= 0;
+	theStats.timeSum	= 0;
+}
+
+uint16_t EOSBracket::PollEvents()
+{
+	evtParser.Reset();
+	return pEOS->EventCheck(&evtParser);
+}
+
+// Exposure compensation values are signed, 8 units per EV
+void EOSBracket::InsertValue(uint8_t val)
+{
+	if (ecCount >= EOS_BKT_MAX_VALUES)
+		return;
+
+	uint8_t		i = ecCount++;
+
+	for (; i && (int8_t)ecValues[i-1] > (int8_t)val; i--)
+		ecValues[i] = ecValues[i-1];
+
+	ecValues[i] = val;
+}
+
+uint8_t EOSBracket::SetBracket(uint8_t frames, uint8_t step)
+{
+	if (IsRunning() || !frames || frames > EOS_BKT_MAX_FRAMES)
+		return 0;
+
+	// the camera shifts the exposure itself
+	if (IsNative())
+		return (seqSize = frames);
+
+	seqSize = 0;
+
+	uint8_t		center = 0;
+
+	while (center < ecCount && ecValues[center] != ecCurrent)
+		center ++;
+
+	if (center == ecCount)
+		return 0;
+
+	int16_t		first	= (int16_t)center - (int16_t)(frames >> 1) * step;
+	int16_t		last	= first + (int16_t)(frames - 1) * step;
+
+	if (first < 0 || last >= ecCount)
+		return 0;
+
+	for (uint8_t i = 0; i < frames; i++)
+		theSequence[i] = ecValues[first + i * step];
+
+	return (seqSize = frames);
+}
+
+uint16_t EOSBracket::Start(uint16_t sets, uint32_t interval)
+{
+	if (!seqSize || !sets)
+		return PTP_RC_InvalidParameter;
+
+	setsLeft		= sets;
+	setInterval		= interval;
+	seqPos			= 0;
+	timeSetStart	= millis();
+	theState		= stSetValue;
+
+	theBackOff.Reset();
+
+	return PTP_RC_OK;
+}
+
+void EOSBracket::Stop()
+{
+	if (!IsRunning())
+		return;
+
+	theBackOff.Reset();
+	theState = (IsNative()) ? stIdle : stRestore;
+}
+
+void EOSBracket::Finish(uint16_t rc)
+{
+	if (rc != PTP_RC_OK)
+		theStats.numErrors ++;
+
+	theState = (IsNative()) ? stIdle : stRestore;
+}
+
+// Returns true if the operation has to be repeated later
+bool EOSBracket::BusyWait(uint16_t rc)
+{
+	if (rc != PTP_RC_DeviceBusy)
+	{
+		theBackOff.Succeeded();
+		return false;
+	}
+	theStats.numBusy ++;
+	theBackOff.Failed();
+	return true;
+}
+
+uint16_t EOSBracket::OnSetValue()
+{
+	if (IsNative())
+	{
+		theState = stCapture;
+		return OnCapture();
+	}
+	uint16_t	ptp_error = pEOS->SetProperty(EOS_DPC_ExposureCompensation, theSequence[seqPos]);
+
+	if (BusyWait(ptp_error))
+		return PTP_RC_OK;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("Bracket SetProperty error:", ptp_error);
+		Finish(ptp_error);
+		return ptp_error;
+	}
+	// the value is accepted, there is nothing to wait for
+	theState = stCapture;
+	return OnCapture();
+}
+
+uint16_t EOSBracket::OnCapture()
+{
+	uint16_t	ptp_error = pEOS->Capture();
+
+	if (BusyWait(ptp_error))
+		return PTP_RC_OK;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("Bracket Capture error:", ptp_error);
+		Finish(ptp_error);
+		return ptp_error;
+	}
+	theStats.numFrames ++;
+
+	if (++seqPos < seqSize)
+	{
+		theState = stSetValue;
+		return ptp_error;
+	}
+	uint32_t	t = millis() - timeSetStart;
+
+	theStats.numSets ++;
+	theStats.timeLast	= t;
+	theStats.timeSum	+= t;
+
+	if (t < theStats.timeMin)
+		theStats.timeMin = t;
+	if (t > theStats.timeMax)
+		theStats.timeMax = t;
+
+	seqPos = 0;
+
+	if (--setsLeft)
+	{
+		theBackOff.WaitUntil(timeSetStart + setInterval);
+		theState	= stWait;
+	}
+	else
+		Finish(PTP_RC_OK);
+
+	return ptp_error;
+}
+
+uint16_t EOSBracket::Task()
+{
+	if (theState == stIdle)
+		return PTP_RC_OK;
+
+	if (!theBackOff.IsDue())
+		return PTP_RC_OK;
+
+	uint16_t	ptp_error = PTP_RC_OK;
+
+	switch (theState)
+	{
+	case stWait:
+		timeSetStart	= millis();
+		theState		= stSetValue;
+		// fall through
+	case stSetValue:
+		return OnSetValue();
+	case stCapture:
+		return OnCapture();
+	case stRestore:
+		ptp_error = pEOS->SetProperty(EOS_DPC_ExposureCompensation, ecCurrent);
+
+		if (BusyWait(ptp_error))
+			return PTP_RC_OK;
+
+		if (ptp_error != PTP_RC_OK)
+			PTPTRACE2("Bracket restore error:", ptp_error);
+
+		theState = stIdle;
+	}
+	return ptp_error;
+}
+
+void EOSBracket::OnPropertyChanged(const EOSEvent *evt)
+{
+	switch (evt->propCode)
+	{
+	case EOS_DPC_ExposureCompensation:
+		// own changes made while bracketing are not the user's setting
+		if (!IsRunning())
+			ecCurrent = (uint8_t)evt->propValue;
+		break;
+	case EOS_DPC_BracketMode:
+		bracketMode = evt->propValue;
+		break;
+	}
+	EOSEventForwarder::OnPropertyChanged(evt);
+}
+
+void EOSBracket::OnAcceptedListSize(const EOSEvent *evt, const uint16_t size)
+{
+	if (evt->propCode == EOS_DPC_ExposureCompensation)
+		ecCount = 0;
+
+	EOSEventForwarder::OnAcceptedListSize(evt, size);
+}
+
+void EOSBracket::OnPropertyValuesAccepted(const EOSEvent *evt, const uint16_t index, const uint32_t &val)
+{
+	if (evt->propCode == EOS_DPC_ExposureCompensation)
+		InsertValue((uint8_t)val);
+
+	EOSEventForwarder::OnPropertyValuesAccepted(evt, index, val);
+}
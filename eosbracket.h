@@ -0,0 +1,110 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __EOSBRACKET_H__
+#define __EOSBRACKET_H__
+
+#include <canoneos.h>
+#include <eoseventparser.h>
+#include <ptppacing.h>
+
+#define EOS_BKT_MAX_VALUES			40		// accepted exposure compensation values kept
+#define EOS_BKT_MAX_FRAMES			9		// frames per bracket set
+
+struct EOSBracketStats
+{
+	uint16_t	numSets;			// bracket sets completed
+	uint16_t	numFrames;			// capture commands accepted
+	uint16_t	numErrors;
+	uint16_t	numBusy;			// DeviceBusy responses received
+	uint32_t	timeLast;			// first command to the last capture of a set, ms
+	uint32_t	timeMin;
+	uint32_t	timeMax;
+	uint32_t	timeSum;			// timeSum / numSets gives the average
+};
+
+// Exposure bracketing. The exposure compensation sequence is computed up front
+// from the values the camera reports as accepted for EOS_DPC_ExposureCompensation,
+// so during a set every SetProperty goes out as soon as the previous capture is
+// accepted and DeviceBusy is retried after a few milliseconds rather than after
+// a fixed timeout. If the camera reports its own bracketing switched on
+// (EOS_DPC_BracketMode), only the capture commands are sent.
+class EOSBracket : public EOSEventForwarder
+{
+	enum { stIdle, stSetValue, stCapture, stWait, stRestore };
+
+	CanonEOS			*pEOS;
+	EOSEventParser		evtParser;
+
+	uint8_t				ecValues[EOS_BKT_MAX_VALUES];	// accepted values sorted from -EV to +EV
+	uint8_t				ecCount;
+	uint8_t				ecCurrent;		// value set before bracketing, restored afterwards
+	uint32_t			bracketMode;	// last reported EOS_DPC_BracketMode value
+
+	uint8_t				theSequence[EOS_BKT_MAX_FRAMES];
+	uint8_t				seqSize;
+	uint8_t				seqPos;
+
+	uint8_t				theState;
+	uint16_t			setsLeft;
+	uint32_t			setInterval;	// ms between the starts of two sets
+	uint32_t			timeSetStart;
+	PTPBackOff			theBackOff;
+
+	EOSBracketStats		theStats;
+
+	bool BusyWait(uint16_t rc);
+	void InsertValue(uint8_t val);
+	void Finish(uint16_t rc);
+
+	uint16_t OnSetValue();
+	uint16_t OnCapture();
+
+public:
+	EOSBracket(CanonEOS *eos, EOSEventHandlers *next = NULL);
+
+	// Reads the camera event queue. Accepted values and the current exposure
+	// compensation are reported by the camera once after the connection is
+	// established and then on every change, so events have to be polled
+	// before SetBracket() is called.
+	uint16_t PollEvents();
+
+	uint8_t GetValueCount() { return ecCount; };
+	bool IsNative() { return (bracketMode != 0); };
+
+	// Computes a set of frames centred on the current exposure compensation,
+	// step is the distance between frames in accepted value positions
+	// (1/3 or 1/2 EV). Returns the number of frames or 0 if the set does not
+	// fit into the accepted range.
+	uint8_t SetBracket(uint8_t frames, uint8_t step);
+
+	uint16_t Start(uint16_t sets = 1, uint32_t interval = 0);
+	void Stop();
+	bool IsRunning() { return (theState != stIdle); };
+
+	// Should be called from OnDeviceInitializedState
+	uint16_t Task();
+
+	const EOSBracketStats* GetStats() { return &theStats; };
+	void ResetStats();
+
+	// EOSEventForwarder overrides
+	virtual void OnPropertyChanged(const EOSEvent *evt);
+	virtual void OnAcceptedListSize(const EOSEvent *evt, const uint16_t size);
+	virtual void OnPropertyValuesAccepted(const EOSEvent *evt, const uint16_t index, const uint32_t &val);
+};
+
+#endif // __EOSBRACKET_H__
@@ -0,0 +1,178 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "eosbulb.h"
+
+EOSBulb::EOSBulb(CanonEOS *eos) :
+	pEOS(eos),
+	theState(stIdle),
+	timeExposure(0),
+	timeOpen(0),
+	latStopEstimate(0),
+	latPreClose(0)
+{
+	memset(&theResult, 0, sizeof(theResult));
+}
+
+uint16_t EOSBulb::Arm()
+{
+	if (theState != stIdle)
+		return (theState == stArmed) ? PTP_RC_OK : PTP_RC_DeviceBusy;
+
+	uint32_t	t = micros();
+	uint16_t	ptp_error = pEOS->PCHDDCapacity(0xfffffff8);
+
+	// the same command is sent twice before BulbEnd, nothing better is known before the first exposure
+	if (!latPreClose)
+		latPreClose = (micros() - t) << 1;
+
+	if (ptp_error != PTP_RC_OK || (ptp_error = pEOS->SetUILock()) != PTP_RC_OK)
+	{
+		PTPTRACE2("Bulb arm error:", ptp_error);
+		return ptp_error;
+	}
+	theState = stArmed;
+	return ptp_error;
+}
+
+uint16_t EOSBulb::Start(uint32_t exposure_ms)
+{
+	if (!exposure_ms || exposure_ms > EOS_BULB_MAX_EXPOSURE)
+		return PTP_RC_InvalidParameter;
+
+	uint16_t	ptp_error = Arm();
+
+	if (ptp_error != PTP_RC_OK)
+		return ptp_error;
+
+	memset(&theResult, 0, sizeof(theResult));
+
+	timeExposure			= exposure_ms * 1000;
+	theResult.timeRequested	= timeExposure;
+
+	uint32_t	t = micros();
+
+	ptp_error = pEOS->BulbStart();
+
+	theResult.latStart	= micros() - t;
+	theResult.rcStart	= ptp_error;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("BulbStart error:", ptp_error);
+		pEOS->ResetUILock();
+		theState = stIdle;
+		return ptp_error;
+	}
+	timeOpen = t + (theResult.latStart >> 1);
+
+	// nothing better is known before the first exposure
+	if (!latStopEstimate)
+		latStopEstimate = theResult.latStart;
+
+	theState = stOpen;
+	return ptp_error;
+}
+
+uint32_t EOSBulb::TimeLeft()
+{
+	if (!IsExposing())
+		return 0;
+
+	// unsigned, exposures longer than 2^31 us would turn a signed difference negative
+	uint32_t	elapsed	= micros() - timeOpen;
+	uint32_t	lead	= latStopEstimate >> 1;
+	uint32_t	target	= (timeExposure > lead) ? timeExposure - lead : 0;
+
+	return (target > elapsed) ? target - elapsed : 0;
+}
+
+uint16_t EOSBulb::Close()
+{
+	uint32_t	t = micros();
+	uint16_t	ptp_error = pEOS->BulbEnd();
+
+	theResult.latStop	= micros() - t;
+	theResult.rcStop	= ptp_error;
+
+	if (ptp_error != PTP_RC_OK)
+		PTPTRACE2("BulbEnd error:", ptp_error);
+
+	uint32_t	time_close = t + (theResult.latStop >> 1);
+
+	theResult.timeAchieved		= time_close - timeOpen;
+	theResult.timeError			= (int32_t)(theResult.timeAchieved - theResult.timeRequested);
+	theResult.timeUncertainty	= (theResult.latStart + theResult.latStop) >> 1;
+
+	latStopEstimate += ((int32_t)theResult.latStop - (int32_t)latStopEstimate) / EOS_BULB_LAT_DIVIDER;
+
+	uint16_t	rc = pEOS->ResetUILock();
+
+	if (rc != PTP_RC_OK)
+		PTPTRACE2("ResetUILock error:", rc);
+
+	theState = stIdle;
+	return (ptp_error != PTP_RC_OK) ? ptp_error : rc;
+}
+
+uint16_t EOSBulb::Stop()
+{
+	if (theState == stArmed)
+	{
+		theState = stIdle;
+		return pEOS->ResetUILock();
+	}
+	return (IsExposing()) ? Close() : PTP_RC_OK;
+}
+
+uint16_t EOSBulb::Task()
+{
+	if (!IsExposing())
+		return PTP_RC_OK;
+
+	uint32_t	left = TimeLeft();
+
+	// The commands preceding BulbEnd are sent once, ahead of the spin window by
+	// their own transaction time, so that they neither delay BulbEnd nor add to the exposure.
+	if (theState == stOpen)
+	{
+		if (left > EOS_BULB_SPIN_TIME + latPreClose)
+			return PTP_RC_OK;
+
+		uint32_t	t = micros();
+
+		pEOS->PCHDDCapacity(0xffffffff);
+		pEOS->PCHDDCapacity(0xfffffffc);
+
+		uint32_t	lat = micros() - t;
+
+		// follows a slower camera at once, a faster one gradually
+		if (lat > latPreClose)
+			latPreClose = lat;
+		else
+			latPreClose -= (latPreClose - lat) / EOS_BULB_LAT_DIVIDER;
+
+		theState = stClosing;
+		return PTP_RC_OK;
+	}
+	if (left > EOS_BULB_SPIN_TIME)
+		return PTP_RC_OK;
+
+	while (TimeLeft())
+		;
+
+	return Close();
+}
@@ -0,0 +1,82 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __EOSBULB_H__
+#define __EOSBULB_H__
+
+#include <canoneos.h>
+
+#define EOS_BULB_SPIN_TIME			20000		// the stop deadline is waited for in a busy loop for the last 20 ms, us
+#define EOS_BULB_MAX_EXPOSURE		4200000		// micros() wraps around in 71 minutes, ms
+#define EOS_BULB_LAT_DIVIDER		4			// stop latency estimate moves by 1/4 of the difference per exposure
+
+// All times are in microseconds. The camera is assumed to act on a command
+// half way through its transaction, so every edge is known to within half of
+// the transaction time.
+struct EOSBulbResult
+{
+	uint32_t	timeRequested;		// exposure asked for
+	uint32_t	timeAchieved;		// estimated shutter open to shutter close time
+	int32_t		timeError;			// timeAchieved - timeRequested
+	uint32_t	timeUncertainty;	// +/- bound of timeAchieved
+	uint32_t	latStart;			// BulbStart transaction time
+	uint32_t	latStop;			// BulbEnd transaction time
+	uint16_t	rcStart;
+	uint16_t	rcStop;
+};
+
+// Bulb exposure timed against micros(). Everything the camera needs before
+// the shutter opens or closes is sent ahead of time, so only BulbStart and
+// BulbEnd are on the critical path. BulbEnd is issued early by the expected
+// half of its transaction time, measured on every exposure.
+class EOSBulb
+{
+	enum { stIdle, stArmed, stOpen, stClosing };
+
+	CanonEOS		*pEOS;
+	uint8_t			theState;
+
+	uint32_t		timeExposure;	// requested exposure, us
+	uint32_t		timeOpen;		// estimated shutter open time, micros()
+	uint32_t		latStopEstimate;
+	uint32_t		latPreClose;	// the two commands preceding BulbEnd, us
+
+	EOSBulbResult	theResult;
+
+	uint16_t Close();
+
+public:
+	EOSBulb(CanonEOS *eos);
+
+	// Sends the commands preceding BulbStart. Start() calls it if it has not been called before.
+	uint16_t Arm();
+	uint16_t Start(uint32_t exposure_ms);
+	// Closes the shutter right away
+	uint16_t Stop();
+
+	bool IsExposing() { return (theState == stOpen || theState == stClosing); };
+	// microseconds left until the shutter closes
+	uint32_t TimeLeft();
+
+	// Should be called from OnDeviceInitializedState. Blocks for up to
+	// EOS_BULB_SPIN_TIME right before the shutter is closed. The commands
+	// preceding BulbEnd are sent before that, early by their measured time.
+	uint16_t Task();
+
+	const EOSBulbResult* GetResult() { return &theResult; };
+};
+
+#endif // __EOSBULB_H__
@@ -0,0 +1,39 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "eoscontrastaf.h"
+
+uint16_t EOSContrastAF::DriveFocus(int16_t steps, int16_t *taken)
+{
+	int16_t		n		= (steps < 0) ? -steps : steps;
+	uint16_t	level	= 1;
+	int16_t		units	= EOS_CAF_LEVEL1_STEPS;
+
+	if (n >= EOS_CAF_LEVEL3_STEPS)
+	{
+		level	= 3;
+		units	= EOS_CAF_LEVEL3_STEPS;
+	}
+	else if (n >= EOS_CAF_LEVEL2_STEPS)
+	{
+		level	= 2;
+		units	= EOS_CAF_LEVEL2_STEPS;
+	}
+	uint16_t	ptp_error = pEOS->MoveFocus((steps > 0) ? 0x8000 | level : level);
+
+	*taken = (ptp_error != PTP_RC_OK) ? 0 : (steps > 0) ? units : -units;
+	return ptp_error;
+}
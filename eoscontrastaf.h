@@ -0,0 +1,45 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __EOSCONTRASTAF_H__
+#define __EOSCONTRASTAF_H__
+
+#include <canoneos.h>
+#include <ptpcontrastaf.h>
+
+// Nominal drive units of the MoveFocus levels 1 to 3
+#define EOS_CAF_LEVEL1_STEPS		1
+#define EOS_CAF_LEVEL2_STEPS		10
+#define EOS_CAF_LEVEL3_STEPS		100
+
+// PTPContrastAF for Canon EOS. Live view has to be on. A drive is one
+// MoveFocus command of the largest level which does not exceed the requested
+// steps, in the nominal units above, so Start(100, 1, 10) searches with the
+// large, medium and small levels in turn. DigitalZoom(5) before Start()
+// scores the magnified region only, which is both sharper and cheaper.
+class EOSContrastAF : public PTPContrastAF
+{
+	CanonEOS	*pEOS;
+
+protected:
+	virtual uint16_t DriveFocus(int16_t steps, int16_t *taken);
+	virtual uint16_t GetFrame(PTPReadParser *parser) { return pEOS->GetLiveViewPicture(parser); };
+
+public:
+	EOSContrastAF(CanonEOS *eos) : pEOS(eos) {};
+};
+
+#endif // __EOSCONTRASTAF_H__
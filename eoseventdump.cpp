@@ -23,13 +23,26 @@ void EOSEventDump::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t
 
 	switch (parseStage) {
             case 0:
+		valueParser.Initialize(&valueBuffer);
+		parseStage ++;
+            case 1:
 		// Get PTP data packet size
-		ptppktSize = *((uint32_t*)p);
+		if (!valueParser.Parse(&p, &cntdn))
+			return;
+
+		ptppktSize	= theBuffer;
+		recordSize	= 8;		// the rest of the container header
 
-		// Return if the packet has only one empty record
+		// Skip the packet if it has only one empty record
 		if (ptppktSize == 0x14)
-			return;
+		{
+			recordSize = 0x14 - 4;
+
+			for (; recordSize && cntdn; recordSize--, cntdn--, p++);
 
+			parseStage = (recordSize) ? 4 : 0;
+			return;
+		}
 		Serial.println("\r\n");
 
 		for (uint8_t i=0; i<4; i++) {
@@ -37,15 +50,17 @@ void EOSEventDump::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t
                     PrintHex<uint8_t>(((uint8_t*)&ptppktSize)[i], 0x80);
                     Serial.print(" ");
 		}
-
-		// Skip PTP packet header
-		p		+= 12;
-		cntdn	-= 12;
 		parseStage ++;
-            case 1:
+            case 2:
+		// Skip the rest of PTP packet header
+		for (; recordSize && cntdn; recordSize--, cntdn--, p++);
+
+		if (recordSize)
+			return;
+
 		parseSubstage = 0;
 		parseStage ++;
-            case 2:
+            case 3:
 		while (1) {
 			switch (parseSubstage)
 			{
@@ -84,7 +99,7 @@ void EOSEventDump::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t
 				recordSize -= 4;
 
 				// Return if empty(last) record
-				if (recordSize == 0x08 && (uint32_t)theBuffer == 0)
+				if (recordSize == 0 && (uint32_t)theBuffer == 0)
 				{
 					parseSubstage	= 0;
 					parseStage		= 0;
@@ -106,5 +121,11 @@ void EOSEventDump::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t
 
 			} // switch (parseSubstage)
 		} // while(1)
+            case 4:
+		// Rest of the packet with no events
+		for (; recordSize && cntdn; recordSize--, cntdn--, p++);
+
+		if (!recordSize)
+			parseStage = 0;
 	} // switch (parseStage)
 }
@@ -31,7 +31,8 @@ bool EOSEventParser::EventRecordParse(uint8_t **pp, uint16_t *pcntdn)
                 //     return true;
                 // }
 
-                PTPTRACE2("Event Record Size: ",nRecSize);
+                // PTPTRACE2 costs delay(1) per record when debugging is off
+                // PTPTRACE2("Event Record Size: ",nRecSize);
                 
 		// calculates the number of event parameters ( size / 4 - 1 )
 		paramCountdown	= (nRecSize >> 2) - 1;
@@ -76,16 +77,27 @@ bool EOSEventParser::EventRecordParse(uint8_t **pp, uint16_t *pcntdn)
 				}
 				break;
 			// C18A/enumType == 3 - Size of enumerator array
+			// C181 - Object Format Code
 			case 4:
 				if (eosEvent.eventCode == EOS_EC_DevPropValuesAccepted)
 					if (pHandler)
 						pHandler->OnAcceptedListSize(&eosEvent, (const uint16_t)varBuffer);
+				if (eosEvent.eventCode == EOS_EC_ObjectCreated)
+					objInfo.formatCode = (uint16_t)varBuffer;
 				break;
 			// C18A/enumType == 3 - Enumerator Values
+			// C181 - Object Size and Parent Object ID
 			default:
 				if (eosEvent.eventCode == EOS_EC_DevPropValuesAccepted)
 					if (pHandler)
 						pHandler->OnPropertyValuesAccepted(&eosEvent, paramCount-5, varBuffer);
+				if (eosEvent.eventCode == EOS_EC_ObjectCreated)
+				{
+					if (paramCount == 7)
+						objInfo.objectSize = varBuffer;
+					if (paramCount == 8)
+						objInfo.parentID = varBuffer;
+				}
 			} // switch (paramCount)
 		} // for
 		nRecStage ++;
@@ -94,6 +106,13 @@ bool EOSEventParser::EventRecordParse(uint8_t **pp, uint16_t *pcntdn)
 			if (!byteSkipper.Skip(pp, pcntdn, nRecSize))
 				return false;
 
+		if (eosEvent.eventCode == EOS_EC_ObjectCreated && pHandler)
+		{
+			objInfo.objectID	= eosEvent.propCode;
+			objInfo.storageID	= eosEvent.propValue;
+			objInfo.timeCreated	= millis();
+			pHandler->OnObjectInfo(&eosEvent, &objInfo);
+		}
 		nRecSize = 0;
 		nRecStage = 0;
 	} // switch(nRecStage...
@@ -105,6 +124,13 @@ void EOSEventParser::InitEOSEventStruct()
 	eosEvent.eventCode	= constInitialEventCode;
 	eosEvent.propCode	= 0;
 	eosEvent.propValue	= 0;
+
+	objInfo.objectID	= 0;
+	objInfo.storageID	= 0;
+	objInfo.formatCode	= 0;
+	objInfo.objectSize	= 0;
+	objInfo.parentID	= 0;
+	objInfo.timeCreated	= 0;
 }
 
 
@@ -116,8 +142,9 @@ void EOSEventParser::Parse(const uint16_t len, const uint8_t *pbuf,
 
 	switch (nStage) {
 	case 0:
-		p += 12;
-		cntdn -= 12;
+		// PTP container header, may arrive split into several chunks
+		if (!byteSkipper.Skip(&p, &cntdn, 12))
+			return;
 		nStage ++;
 	case 1:
 		theBuffer.valueSize = 4;
@@ -27,6 +27,17 @@ struct EOSEvent
 	uint32_t	propValue;
 };
 
+// Object description taken from EOS_EC_ObjectCreated event record
+struct EOSObjectInfo
+{
+	uint32_t	objectID;		// record offset 0x08
+	uint32_t	storageID;		// record offset 0x0C
+	uint16_t	formatCode;		// record offset 0x10
+	uint32_t	objectSize;		// record offset 0x1C
+	uint32_t	parentID;		// record offset 0x20
+	uint32_t	timeCreated;	// millis() when the record was parsed
+};
+
 class EOSEventHandlers
 {
 public:
@@ -34,10 +45,30 @@ public:
 	virtual void OnAcceptedListSize(const EOSEvent *evt, const uint16_t size) = 0;
 	virtual void OnPropertyValuesAccepted(const EOSEvent *evt, const uint16_t index, const uint32_t &val) = 0;
 	virtual void OnObjectCreated(const EOSEvent *evt, uint8_t* buf) = 0;
+	// called once the whole ObjectCreated record has been parsed
+	virtual void OnObjectInfo(const EOSEvent *evt __attribute__ ((unused)), const EOSObjectInfo *obj __attribute__ ((unused))) {};
 	//void OnCaptureComplete() = 0;
 };
 
-class EOSEventParser : public PTPReadParser
+// Passes every event on to the next handlers, which may be NULL. Engines
+// sitting between the parser and the application handlers derive from it and
+// override the events they use only, calling the base to pass them on.
+class EOSEventForwarder : public EOSEventHandlers
+{
+protected:
+	EOSEventHandlers	*pNext;			// application event handlers, may be NULL
+
+public:
+	EOSEventForwarder(EOSEventHandlers *next = NULL) : pNext(next) {};
+
+	virtual void OnPropertyChanged(const EOSEvent *evt) { if (pNext) pNext->OnPropertyChanged(evt); };
+	virtual void OnAcceptedListSize(const EOSEvent *evt, const uint16_t size) { if (pNext) pNext->OnAcceptedListSize(evt, size); };
+	virtual void OnPropertyValuesAccepted(const EOSEvent *evt, const uint16_t index, const uint32_t &val) { if (pNext) pNext->OnPropertyValuesAccepted(evt, index, val); };
+	virtual void OnObjectCreated(const EOSEvent *evt, uint8_t* buf) { if (pNext) pNext->OnObjectCreated(evt, buf); };
+	virtual void OnObjectInfo(const EOSEvent *evt, const EOSObjectInfo *obj) { if (pNext) pNext->OnObjectInfo(evt, obj); };
+};
+
+class EOSEventParser : public PTPResettableParser
 {
 
     EOSEventHandlers		*pHandler;
@@ -52,6 +83,7 @@ class EOSEventParser : public PTPReadParser
 	MultiValueBuffer		theBuffer;
 	uint32_t				varBuffer;
 	EOSEvent				eosEvent;
+	EOSObjectInfo			objInfo;
 	uint16_t				paramCountdown;
 	uint16_t				paramCount;
         uint8_t					paramsChanged;
@@ -77,7 +109,7 @@ public:
 			theBuffer.pValue = &varBuffer;
 		};
 
-	void Reset()
+	virtual void Reset()
 	{
 		nStage			= 0;
 		nRecStage		= 0;
@@ -85,6 +117,9 @@ public:
 		varBuffer		= 0;
 		paramCountdown	= 0;
 		paramsChanged	= 0;
+
+		// a skip cut short would otherwise resume with its old count
+		byteSkipper		= ByteSkipper();
 	};
 
 	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
@@ -0,0 +1,66 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "eosfocusstack.h"
+
+EOSFocusStack::EOSFocusStack(CanonEOS *eos, uint8_t level, EOSEventHandlers *next) :
+	EOSEventForwarder(next),
+	pEOS(eos),
+	evtParser(this),
+	driveLevel((level < 1) ? 1 : (level > 3) ? 3 : level),
+	bCreated(false),
+	timeCapture(0)
+{
+}
+
+uint16_t EOSFocusStack::DriveFocus(int16_t steps, int16_t *taken)
+{
+	uint16_t	ptp_error = pEOS->MoveFocus((steps > 0) ? 0x8000 | driveLevel : driveLevel);
+
+	*taken = (ptp_error != PTP_RC_OK) ? 0 : (steps > 0) ? 1 : -1;
+	return ptp_error;
+}
+
+uint16_t EOSFocusStack::Capture()
+{
+	bCreated	= false;
+	timeCapture	= millis();
+
+	return pEOS->Capture();
+}
+
+uint16_t EOSFocusStack::CaptureReady()
+{
+	evtParser.Reset();
+
+	uint16_t	ptp_error = pEOS->EventCheck(&evtParser);
+
+	if (ptp_error != PTP_RC_OK)
+		return ptp_error;
+
+	// cameras which report no object, i.e. with no card inserted, still get going
+	if (bCreated || millis() - timeCapture > EOS_FSTACK_CREATE_TIMEOUT)
+		return PTP_RC_OK;
+
+	return PTP_RC_DeviceBusy;
+}
+
+void EOSFocusStack::OnObjectInfo(const EOSEvent *evt, const EOSObjectInfo *obj)
+{
+	bCreated = true;
+
+	EOSEventForwarder::OnObjectInfo(evt, obj);
+}
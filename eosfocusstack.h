@@ -0,0 +1,50 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __EOSFOCUSSTACK_H__
+#define __EOSFOCUSSTACK_H__
+
+#include <canoneos.h>
+#include <eoseventparser.h>
+#include <ptpfocusstack.h>
+
+#define EOS_FSTACK_CREATE_TIMEOUT	5000	// longest wait for ObjectCreated after a capture, ms
+
+// PTPFocusStack for Canon EOS. Live view has to be on for MoveFocus to be
+// accepted. Each step is one MoveFocus command of the given level (1 to 3,
+// small to large). The next drive is issued once the camera reports the
+// object of the last frame created.
+class EOSFocusStack : public PTPFocusStack, public EOSEventForwarder
+{
+	CanonEOS			*pEOS;
+	EOSEventParser		evtParser;
+	uint8_t				driveLevel;
+	bool				bCreated;		// ObjectCreated received since the last capture
+	uint32_t			timeCapture;
+
+protected:
+	virtual uint16_t DriveFocus(int16_t steps, int16_t *taken);
+	virtual uint16_t Capture();
+	virtual uint16_t CaptureReady();
+
+public:
+	EOSFocusStack(CanonEOS *eos, uint8_t level = 1, EOSEventHandlers *next = NULL);
+
+	// EOSEventForwarder overrides
+	virtual void OnObjectInfo(const EOSEvent *evt, const EOSObjectInfo *obj);
+};
+
+#endif // __EOSFOCUSSTACK_H__
@@ -0,0 +1,52 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "eosintervalometer.h"
+
+EOSIntervalometer::EOSIntervalometer(CanonEOS *eos, EOSEventHandlers *next, bool poll) :
+	EOSEventForwarder(next),
+	pEOS(eos),
+	evtParser(this),
+	bPoll(poll),
+	nextPollTime(0)
+{
+}
+
+uint16_t EOSIntervalometer::Task()
+{
+	uint16_t	ptp_error = PTPIntervalometer::Task();
+
+	if (!bPoll || (int32_t)(millis() - nextPollTime) < 0)
+		return ptp_error;
+
+	// a poll right before the deadline would delay the capture command
+	if (IsRunning() && TimeToNext() < EOS_INTERVAL_POLL_GUARD)
+		return ptp_error;
+
+	nextPollTime = millis() + EOS_INTERVAL_POLL_INTERVAL;
+
+	evtParser.Reset();
+	pEOS->EventCheck(&evtParser);
+
+	return ptp_error;
+}
+
+void EOSIntervalometer::OnObjectInfo(const EOSEvent *evt, const EOSObjectInfo *obj)
+{
+	OnFrameCreated();
+
+	EOSEventForwarder::OnObjectInfo(evt, obj);
+}
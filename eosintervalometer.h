@@ -0,0 +1,50 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __EOSINTERVALOMETER_H__
+#define __EOSINTERVALOMETER_H__
+
+#include <canoneos.h>
+#include <eoseventparser.h>
+#include <ptpintervalometer.h>
+
+#define EOS_INTERVAL_POLL_INTERVAL		50		// event poll interval, ms
+#define EOS_INTERVAL_POLL_GUARD			20		// no polls that close to the next capture command, ms
+
+// PTPIntervalometer for Canon EOS. Object creation is taken from
+// EOS_EC_ObjectCreated events. The intervalometer either polls the camera
+// itself or, when used together with EOSTether, is passed to it as the next
+// event handler with polling switched off.
+class EOSIntervalometer : public PTPIntervalometer, public EOSEventForwarder
+{
+	CanonEOS			*pEOS;
+	EOSEventParser		evtParser;
+	bool				bPoll;
+	uint32_t			nextPollTime;
+
+protected:
+	virtual uint16_t Fire() { return pEOS->Capture(); };
+
+public:
+	EOSIntervalometer(CanonEOS *eos, EOSEventHandlers *next = NULL, bool poll = true);
+
+	uint16_t Task();
+
+	// EOSEventForwarder overrides
+	virtual void OnObjectInfo(const EOSEvent *evt, const EOSObjectInfo *obj);
+};
+
+#endif // __EOSINTERVALOMETER_H__
@@ -0,0 +1,239 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "eostether.h"
+
+uint8_t EOSFormatFilter::Decide(const EOSObjectInfo *obj)
+{
+	uint8_t		act = actDownload;
+
+	switch (obj->formatCode)
+	{
+	case PTP_OFC_EXIF_JPEG:
+		break;
+	case EOS_OFC_CRW:
+	case EOS_OFC_CR2:
+	case EOS_OFC_CR3:
+		act = actRaw;
+		break;
+	default:
+		act = actOther;
+	}
+	if (act == actDownload && maxSize && obj->objectSize > maxSize)
+		act = actDefer;
+
+	return act;
+}
+
+EOSTether::EOSTether(CanonEOS *eos, EOSTetherSink *sink, EOSEventHandlers *next) :
+	EOSEventForwarder(next),
+	pEOS(eos),
+	pSink(sink),
+	pFilter(NULL),
+	evtParser(this),
+	timeCapture(0),
+	bCaptureMarked(false),
+	nextPollTime(0)
+{
+	ResetStats();
+}
+
+void EOSTether::ResetStats()
+{
+	theStats.numFrames		= 0;
+	theStats.numErrors		= 0;
+	theStats.numDropped		= 0;
+	theStats.numSkipped		= 0;
+	theStats.numDeferred	= 0;
+	theStats.numRetries		= 0;
+	theStats.maxQueue		= 0;
+	theStats.numBytes		= 0;
+	theStats.latLast		= 0;
+	theStats.latMin			= 0xFFFFFFFF;
+	theStats.latMax			= 0;
+	theStats.latSum			= 0;
+}
+
+uint16_t EOSTether::Capture()
+{
+	MarkCapture();
+	return pEOS->Capture();
+}
+
+void EOSTether::Push(const EOSObjectInfo *obj)
+{
+	EOSTetherFrame	*frm = theQueue.Push();
+
+	if (!frm)
+	{
+		PTPTRACE2("Tether queue full, object dropped:", obj->objectID);
+		theStats.numDropped ++;
+		return;
+	}
+	frm->info			= *obj;
+	frm->timeCapture	= (bCaptureMarked) ? timeCapture : obj->timeCreated;
+	frm->action			= (pFilter) ? pFilter->Decide(obj) : EOSTetherFilter::actDownload;
+	frm->retries		= 0;
+
+	if (theQueue.Size() > theStats.maxQueue)
+		theStats.maxQueue = theQueue.Size();
+}
+
+void EOSTether::Defer(const EOSTetherFrame *frm, bool retry)
+{
+	EOSTetherFrame	*p = idleQueue.Push();
+
+	if (!p)
+	{
+		// nowhere to keep it, free the camera buffer rather than stall it
+		PTPTRACE2("Tether idle queue full, object cancelled:", frm->info.objectID);
+		pEOS->CancelTransfer(frm->info.objectID);
+		theStats.numDropped ++;
+		return;
+	}
+	*p			= *frm;
+	p->action	= EOSTetherFilter::actDefer;
+
+	if (retry)
+		theStats.numRetries ++;
+	else
+		theStats.numDeferred ++;
+}
+
+uint16_t EOSTether::PollEvents()
+{
+	uint8_t		queued = theQueue.Size();
+
+	nextPollTime = millis() + EOS_TETHER_POLL_INTERVAL;
+
+	evtParser.Reset();
+	uint16_t	ptp_error = pEOS->EventCheck(&evtParser);
+
+	// all objects of one release (i.e. RAW+JPEG) are reported in the same event packet
+	if (theQueue.Size() != queued)
+		bCaptureMarked = false;
+
+	return ptp_error;
+}
+
+uint16_t EOSTether::ApplyFilter()
+{
+	uint16_t		ptp_error = PTP_RC_OK;
+	EOSTetherFrame	*frm;
+
+	// Skipping and deferring cost one short transaction at most, so all of them
+	// are handled before the next download starts.
+	while ((frm = theQueue.Front()) && frm->action != EOSTetherFilter::actDownload)
+	{
+		if (frm->action == EOSTetherFilter::actSkip)
+		{
+			if ((ptp_error = pEOS->CancelTransfer(frm->info.objectID)) != PTP_RC_OK)
+				PTPTRACE2("CancelTransfer error:", ptp_error);
+
+			theStats.numSkipped ++;
+		}
+		else
+			Defer(frm);
+
+		theQueue.Pop();
+	}
+	return ptp_error;
+}
+
+uint16_t EOSTether::Download(EOSTetherFrame *frm)
+{
+	if (pSink)
+		pSink->OnObjectBegin(&frm->info);
+
+	uint16_t	ptp_error = pEOS->GetObject(frm->info.objectID, frm->info.parentID, pSink);
+
+	// The camera keeps the object in its buffer until TransferComplete is received,
+	// so it is sent before anything else is done on the host side.
+	if (ptp_error == PTP_RC_OK)
+		ptp_error = pEOS->TransferComplete(frm->info.objectID);
+
+	if (ptp_error == PTP_RC_OK)
+	{
+		uint32_t	latency = millis() - frm->timeCapture;
+
+		theStats.numFrames	++;
+		theStats.numBytes	+= frm->info.objectSize;
+		theStats.latLast	= latency;
+		theStats.latSum		+= latency;
+
+		if (latency < theStats.latMin)
+			theStats.latMin = latency;
+		if (latency > theStats.latMax)
+			theStats.latMax = latency;
+	}
+	else
+	{
+		PTPTRACE2("Tether download error:", ptp_error);
+		theStats.numErrors ++;
+	}
+	if (pSink)
+		pSink->OnObjectEnd(&frm->info, ptp_error);
+
+	// rewind the camera side of the transfer and try once more at idle time
+	if (ptp_error != PTP_RC_OK && frm->retries < EOS_TETHER_MAX_RETRIES)
+	{
+		frm->retries ++;
+		pEOS->ResetTransfer(frm->info.objectID);
+		Defer(frm, true);
+	}
+	return ptp_error;
+}
+
+uint16_t EOSTether::Task()
+{
+	uint16_t	ptp_error = ApplyFilter();
+
+	// The frame leaves its queue before the download, so that a failed one
+	// queued again for a retry finds the slot it had free.
+	EOSTetherFrame	frm;
+
+	if (theQueue.Size())
+	{
+		frm = *theQueue.Front();
+		theQueue.Pop();
+		ptp_error = Download(&frm);
+
+		// A single PTP session cannot run two transactions at once, so the next
+		// poll is issued right after the current download instead of waiting for
+		// the poll timer. This keeps the queue filled during a burst.
+		PollEvents();
+		return ptp_error;
+	}
+	if ((int32_t)(millis() - nextPollTime) >= 0)
+		return PollEvents();
+
+	// nothing new from the camera - time for deferred objects
+	if (idleQueue.Size())
+	{
+		frm = *idleQueue.Front();
+		idleQueue.Pop();
+		ptp_error = Download(&frm);
+		PollEvents();
+	}
+	return ptp_error;
+}
+
+void EOSTether::OnObjectInfo(const EOSEvent *evt, const EOSObjectInfo *obj)
+{
+	Push(obj);
+
+	EOSEventForwarder::OnObjectInfo(evt, obj);
+}
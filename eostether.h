@@ -0,0 +1,168 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __EOSTETHER_H__
+#define __EOSTETHER_H__
+
+#include <canoneos.h>
+#include <eoseventparser.h>
+
+#define EOS_TETHER_QUEUE_SIZE		8		// number of created objects waiting for download
+#define EOS_TETHER_IDLE_QUEUE_SIZE	8		// number of objects deferred to idle time
+#define EOS_TETHER_POLL_INTERVAL	100		// event poll interval while the queue is empty, ms
+#define EOS_TETHER_MAX_RETRIES		1		// failed downloads are retried at idle time
+
+// Destination of downloaded objects. Parse() receives the GetObject data stage
+// including the 12 byte PTP container header, same as any other PTPReadParser.
+class EOSTetherSink : public PTPReadParser
+{
+public:
+	virtual void OnObjectBegin(const EOSObjectInfo *obj __attribute__ ((unused))) {};
+	virtual void OnObjectEnd(const EOSObjectInfo *obj __attribute__ ((unused)), uint16_t rc __attribute__ ((unused))) {};
+};
+
+// Download policy. Decide() is called while the event packet is being parsed,
+// so it must not issue any PTP transactions.
+class EOSTetherFilter
+{
+public:
+	enum { actDownload, actSkip, actDefer };
+
+	virtual uint8_t Decide(const EOSObjectInfo *obj) = 0;
+};
+
+// Decides by object format code and size taken from the ObjectCreated record.
+// The default is to download JPEGs right away and leave RAWs for idle time.
+class EOSFormatFilter : public EOSTetherFilter
+{
+	uint8_t		actRaw;			// action for CRW/CR2/CR3 objects
+	uint8_t		actOther;		// action for anything but JPEG and RAW, i.e. movies
+	uint32_t	maxSize;		// objects larger than maxSize are deferred, 0 - no limit
+
+public:
+	EOSFormatFilter(uint8_t raw = actDefer, uint8_t other = actSkip, uint32_t max_size = 0) :
+		actRaw(raw), actOther(other), maxSize(max_size) {};
+
+	void SetRawAction(uint8_t act) { actRaw = act; };
+	void SetOtherAction(uint8_t act) { actOther = act; };
+	void SetMaxSize(uint32_t size) { maxSize = size; };
+
+	virtual uint8_t Decide(const EOSObjectInfo *obj);
+};
+
+struct EOSTetherStats
+{
+	uint16_t	numFrames;			// objects downloaded
+	uint16_t	numErrors;			// failed downloads
+	uint16_t	numDropped;			// objects lost because the queue was full
+	uint16_t	numSkipped;			// objects cancelled by the filter
+	uint16_t	numDeferred;		// objects moved to the idle queue by the filter
+	uint16_t	numRetries;			// failed downloads queued again at idle time
+	uint8_t		maxQueue;			// queue high-water mark
+	uint32_t	numBytes;			// object bytes downloaded
+	uint32_t	latLast;			// capture-to-host latency of the last frame, ms
+	uint32_t	latMin;
+	uint32_t	latMax;
+	uint32_t	latSum;				// latSum / numFrames gives the average
+};
+
+struct EOSTetherFrame
+{
+	EOSObjectInfo	info;
+	uint32_t		timeCapture;	// MarkCapture() time or object creation time
+	uint8_t			action;			// EOSTetherFilter action
+	uint8_t			retries;
+};
+
+template <const uint8_t SIZE>
+class EOSFrameQueue
+{
+	EOSTetherFrame	theBuffer[SIZE];
+	uint8_t			head, size;
+
+public:
+	EOSFrameQueue() : head(0), size(0) {};
+
+	uint8_t Size() { return size; };
+	void Empty() { head = size = 0; };
+
+	// returns a pointer to the new tail element or NULL if the queue is full
+	EOSTetherFrame* Push()
+	{
+		if (size >= SIZE)
+			return NULL;
+
+		return theBuffer + ((head + size++) % SIZE);
+	};
+	EOSTetherFrame* Front() { return (size) ? theBuffer + head : NULL; };
+	void Pop()
+	{
+		if (!size)
+			return;
+
+		head = (head + 1) % SIZE;
+		size --;
+	};
+};
+
+class EOSTether : public EOSEventForwarder
+{
+	CanonEOS			*pEOS;
+	EOSTetherSink		*pSink;
+	EOSTetherFilter		*pFilter;		// download everything if NULL
+
+	EOSEventParser		evtParser;
+
+	EOSFrameQueue<EOS_TETHER_QUEUE_SIZE>		theQueue;
+	EOSFrameQueue<EOS_TETHER_IDLE_QUEUE_SIZE>	idleQueue;
+
+	uint32_t			timeCapture;	// time of the last MarkCapture() call
+	bool				bCaptureMarked;	// timeCapture applies to the next created objects
+	uint32_t			nextPollTime;
+	EOSTetherStats		theStats;
+
+	void Push(const EOSObjectInfo *obj);
+	void Defer(const EOSTetherFrame *frm, bool retry = false);
+	uint16_t Download(EOSTetherFrame *frm);
+	uint16_t ApplyFilter();
+
+public:
+	EOSTether(CanonEOS *eos, EOSTetherSink *sink, EOSEventHandlers *next = NULL);
+
+	void SetFilter(EOSTetherFilter *filter) { pFilter = filter; };
+
+	// Remembers the shutter release time for capture-to-host latency of the next object(s)
+	void MarkCapture() { timeCapture = millis(); bCaptureMarked = true; };
+	uint16_t Capture();
+
+	uint16_t PollEvents();
+
+	// Should be called from OnDeviceInitializedState. Downloads one queued object
+	// per call and polls for new objects right after it, so the camera keeps
+	// reporting while the host is busy with the queue. Deferred objects are
+	// downloaded only when there is nothing else to do.
+	uint16_t Task();
+
+	uint8_t GetQueueSize() { return theQueue.Size(); };
+	uint8_t GetIdleQueueSize() { return idleQueue.Size(); };
+	const EOSTetherStats* GetStats() { return &theStats; };
+	void ResetStats();
+
+	// EOSEventForwarder overrides
+	virtual void OnObjectInfo(const EOSEvent *evt, const EOSObjectInfo *obj);
+};
+
+#endif // __EOSTETHER_H__
@@ -0,0 +1,43 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __EOSTRIGGER_H__
+#define __EOSTRIGGER_H__
+
+#include <canoneos.h>
+#include <eoseventparser.h>
+#include <ptptrigger.h>
+
+// Canon EOS member of PTPTriggerGroup. The capture is reported by EOS_EC_ObjectCreated.
+class EOSTriggerCamera : public PTPTriggerCamera, public EOSEventForwarder
+{
+	CanonEOS			*pEOS;
+	EOSEventParser		evtParser;
+
+public:
+	EOSTriggerCamera(CanonEOS *eos, EOSEventHandlers *next = NULL) : EOSEventForwarder(next), pEOS(eos), evtParser(this) {};
+
+	// PTPTriggerCamera implementation
+	virtual uint16_t Arm() { return Poll(); };
+	virtual uint16_t BeginFire() { return pEOS->BeginOperation(EOS_OC_Capture); };
+	virtual uint16_t EndFire() { return pEOS->EndOperation(); };
+	virtual uint16_t Poll();
+
+	// EOSEventForwarder overrides
+	virtual void OnObjectInfo(const EOSEvent *evt, const EOSObjectInfo *obj);
+};
+
+#endif // __EOSTRIGGER_H__
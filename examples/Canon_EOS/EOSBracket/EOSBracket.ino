@@ -0,0 +1,99 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <canoneos.h>
+#include <eosbracket.h>
+
+#define BKT_FRAMES      5
+#define BKT_STEP        3           // 1 EV with 1/3 EV steps
+#define BKT_SETS        10
+#define BKT_INTERVAL    10000       // ms
+
+class CamStateHandlers : public EOSStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+CanonEOS            Eos(&Usb, &CamStates);
+EOSBracket          Bracket(&Eos);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        Bracket.Stop();
+        E_Notify(PSTR("\r\nCamera disconnected\r\n"),0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    static bool     started = false;
+    static uint16_t sets_reported = 0;
+
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        started = false;
+        E_Notify(PSTR("\r\nCamera connected\r\n"),0x80);
+    }
+    if (!started)
+    {
+        // the camera reports accepted values right after the connection
+        Bracket.PollEvents();
+
+        if (!Bracket.SetBracket(BKT_FRAMES, BKT_STEP))
+            return;
+
+        Bracket.ResetStats();
+        sets_reported = 0;
+        started = (Bracket.Start(BKT_SETS, BKT_INTERVAL) == PTP_RC_OK);
+
+        E_Notify((Bracket.IsNative()) ? PSTR("\r\nCamera AEB") : PSTR("\r\nLibrary bracketing"),0x80);
+        return;
+    }
+    Bracket.Task();
+
+    const EOSBracketStats *st = Bracket.GetStats();
+
+    if (st->numSets != sets_reported)
+    {
+        sets_reported = st->numSets;
+
+        E_Notify(PSTR("\r\nSet: "),0x80);
+        Serial.print(st->numSets, DEC);
+        E_Notify(PSTR(" time, ms: "),0x80);
+        Serial.print(st->timeLast, DEC);
+        E_Notify(PSTR(" avg: "),0x80);
+        Serial.print(st->timeSum / st->numSets, DEC);
+        E_Notify(PSTR(" busy: "),0x80);
+        Serial.print(st->numBusy, DEC);
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -0,0 +1,105 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <canoneos.h>
+#include <eosbulb.h>
+
+#define SHUTTER_SPEED_BULB       0x0c
+#define EXPOSURE_TIME            30000      // ms
+#define EXPOSURE_PAUSE           5000       // ms between exposures
+
+class CamStateHandlers : public EOSStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+} CamStates;
+
+USB                 Usb;
+USBHub              Hub1(&Usb);
+CanonEOS            Eos(&Usb, &CamStates);
+EOSBulb             Bulb(&Eos);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("Camera disconnected\r\n"),0x80);
+    }
+}
+
+void PrintResult()
+{
+    const EOSBulbResult *res = Bulb.GetResult();
+
+    E_Notify(PSTR("\r\nExposure, us: "),0x80);
+    Serial.print(res->timeAchieved, DEC);
+    E_Notify(PSTR(" error: "),0x80);
+    Serial.print(res->timeError, DEC);
+    E_Notify(PSTR(" +/-"),0x80);
+    Serial.print(res->timeUncertainty, DEC);
+
+    if (res->rcStop != PTP_RC_OK)
+        ErrorMessage<uint16_t>(" Error", res->rcStop);
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    static uint32_t next_start = 0;
+
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("Camera connected\r\n"),0x80);
+
+        uint16_t rc = Eos.SetProperty(EOS_DPC_ShutterSpeed,SHUTTER_SPEED_BULB);
+
+        if (rc != PTP_RC_OK)
+            ErrorMessage<uint16_t>("Error", rc);
+
+        next_start = millis() + EXPOSURE_PAUSE;
+    }
+    if (Bulb.IsExposing())
+    {
+        Bulb.Task();
+
+        if (!Bulb.IsExposing())
+        {
+            PrintResult();
+            next_start = millis() + EXPOSURE_PAUSE;
+        }
+        return;
+    }
+    if ((int32_t)(millis() - next_start) >= 0)
+    {
+        uint16_t rc = Bulb.Start(EXPOSURE_TIME);
+
+        if (rc != PTP_RC_OK)
+        {
+            ErrorMessage<uint16_t>("Bulb start error", rc);
+            next_start = millis() + EXPOSURE_PAUSE;
+        }
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -5,6 +5,7 @@
 
 #include <valuelist.h>
 #include <canoneos.h>
+#include <ptppoller.h>
 #include <qp_port.h>
 
 #include "camcontroller.h"
@@ -74,6 +75,9 @@ CamStateHandlers      CamStates;
 USB                   Usb;
 Max_LCD               LCD(&Usb);
 CanonEOS              Eos(&Usb, &CamStates);
+EosEventHandlers      EosHandlers;
+EOSEventParser        EosParser(&EosHandlers);
+PTPEventPoller        EosPoller(&Eos, &EosParser, EOS_EVENT_EMPTY_SIZE);
 
 CamHDRCapture         hdrCapture(Eos);
 GPInRegister          ExtControls(&Usb);
@@ -525,14 +529,13 @@ void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
     }
     if ((bmPollEnable & 2) && current_time >= pollTime)
     {
-        EosEventHandlers  hnd;
-        EOSEventParser    prs(&hnd);
-        Eos.EventCheck(&prs);
         diLeftTimer.SetUpdated(true);
         diIntTimer.SetUpdated(true);
 
         pollTime = current_time + 300;
     }
+    if (bmPollEnable & 2)
+        EosPoller.Task();
     hdrCapture.Run();
 }
 
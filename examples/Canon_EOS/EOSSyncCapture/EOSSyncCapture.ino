@@ -0,0 +1,114 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <canoneos.h>
+#include <eostrigger.h>
+
+#define SHOT_INTERVAL   5000        // ms
+
+class CamStateHandlers : public EOSStateHandlers
+{
+public:
+      bool  bConnected;
+
+      CamStateHandlers() : bConnected(false) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+CamStateHandlers    CamStates1, CamStates2;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+CanonEOS            Eos1(&Usb, &CamStates1);
+CanonEOS            Eos2(&Usb, &CamStates2);
+EOSTriggerCamera    Cam1(&Eos1);
+EOSTriggerCamera    Cam2(&Eos2);
+PTPTriggerGroup     Group;
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (bConnected)
+    {
+        bConnected = false;
+        E_Notify(PSTR("\r\nCamera at: "),0x80);
+        Serial.print(ptp->GetAddress(),HEX);
+        E_Notify(PSTR(" disconnected"),0x80);
+    }
+}
+
+void PrintStats()
+{
+    const PTPTriggerStats *st = Group.GetStats();
+
+    E_Notify(PSTR("\r\nShot: "),0x80);
+    Serial.print(st->numShots, DEC);
+    E_Notify(PSTR(" command skew, us: "),0x80);
+    Serial.print(st->cmdSkewLast, DEC);
+    E_Notify(PSTR(" event skew: "),0x80);
+    Serial.print(st->evtSkewLast, DEC);
+    E_Notify(PSTR(" max: "),0x80);
+    Serial.print(st->evtSkewMax, DEC);
+
+    for (uint8_t i=0; i<Group.GetCameraCount(); i++)
+    {
+        E_Notify(PSTR(" lag: "),0x80);
+        Serial.print(Group.GetCameraStats(i)->lagLast, DEC);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    static uint32_t next_time = 0;
+
+    if (!bConnected)
+    {
+        bConnected = true;
+        E_Notify(PSTR("\r\nCamera at: "),0x80);
+        Serial.print(ptp->GetAddress(),HEX);
+        E_Notify(PSTR(" connected"),0x80);
+    }
+    if (!CamStates1.bConnected || !CamStates2.bConnected)
+        return;
+
+    if (Group.IsWaiting())
+    {
+        Group.Task();
+
+        if (!Group.IsWaiting())
+            PrintStats();
+
+        return;
+    }
+    if ((int32_t)(millis() - next_time) < 0)
+        return;
+
+    next_time = millis() + SHOT_INTERVAL;
+
+    Group.Arm();
+
+    uint16_t rc = Group.Fire();
+
+    if (rc != PTP_RC_OK)
+        ErrorMessage<uint16_t>("Error", rc);
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    Group.Add(&Cam1);
+    Group.Add(&Cam2);
+    Group.SetReorder(true);
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -0,0 +1,112 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <canoneos.h>
+#include <eostether.h>
+
+class CamStateHandlers : public EOSStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+// Counts the bytes of each downloaded object. Replace with an SD card writer.
+class ByteCountSink : public EOSTetherSink
+{
+      uint32_t  numBytes;
+
+public:
+      ByteCountSink() : numBytes(0) {};
+
+      virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+      {
+          numBytes += (offset) ? len : len - 12;
+      };
+      virtual void OnObjectBegin(const EOSObjectInfo *obj)
+      {
+          numBytes = 0;
+          E_Notify(PSTR("\r\nObject: "),0x80);
+          PrintHex<uint32_t>(obj->objectID, 0x80);
+      };
+      virtual void OnObjectEnd(const EOSObjectInfo *obj, uint16_t rc)
+      {
+          E_Notify(PSTR(" bytes: "),0x80);
+          Serial.print(numBytes, DEC);
+
+          if (rc != PTP_RC_OK)
+              ErrorMessage<uint16_t>(" Error", rc);
+      };
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+CanonEOS            Eos(&Usb, &CamStates);
+ByteCountSink       Sink;
+EOSFormatFilter     Filter;     // JPEGs right away, RAWs at idle time, movies skipped
+EOSTether           Tether(&Eos, &Sink);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("\r\nCamera disconnected\r\n"),0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    static uint32_t next_report = 0;
+
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("\r\nCamera connected\r\n"),0x80);
+        Tether.ResetStats();
+    }
+    Tether.Task();
+
+    uint32_t  time_now = millis();
+
+    if (time_now > next_report)
+    {
+        next_report = time_now + 10000;
+
+        const EOSTetherStats  *st = Tether.GetStats();
+
+        E_Notify(PSTR("\r\nFrames: "),0x80);
+        Serial.print(st->numFrames, DEC);
+
+        if (st->numFrames)
+        {
+            E_Notify(PSTR(" avg latency, ms: "),0x80);
+            Serial.print(st->latSum / st->numFrames, DEC);
+            E_Notify(PSTR(" max: "),0x80);
+            Serial.print(st->latMax, DEC);
+        }
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    Tether.SetFilter(&Filter);
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -0,0 +1,86 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <canoneos.h>
+#include <eosintervalometer.h>
+
+#define TL_INTERVAL     5000    // ms
+#define TL_FRAMES       100
+
+class CamStateHandlers : public EOSStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+CanonEOS            Eos(&Usb, &CamStates);
+EOSIntervalometer   Timelapse(&Eos);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        Timelapse.Stop();
+        E_Notify(PSTR("\r\nCamera disconnected\r\n"),0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    static uint32_t last_frame = 0;
+
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("\r\nCamera connected\r\n"),0x80);
+        Timelapse.Start(TL_INTERVAL, TL_FRAMES, 1000);
+        last_frame = 0;
+    }
+    Timelapse.Task();
+
+    const PTPIntervalStats  *st = Timelapse.GetStats();
+
+    if (st->numMeasured != last_frame)
+    {
+        last_frame = st->numMeasured;
+
+        E_Notify(PSTR("\r\nFrame: "),0x80);
+        Serial.print(st->numMeasured, DEC);
+        E_Notify(PSTR(" lag, ms: "),0x80);
+        Serial.print(st->lagLast, DEC);
+        E_Notify(PSTR(" error min/max: "),0x80);
+        Serial.print(st->errMin, DEC);
+        Serial.print("/");
+        Serial.print(st->errMax, DEC);
+        E_Notify(PSTR(" jitter: "),0x80);
+        Serial.print(st->errAbsSum / st->numMeasured, DEC);
+        E_Notify(PSTR(" missed: "),0x80);
+        Serial.print(st->numMissed, DEC);
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -4,7 +4,7 @@
 #include <ptpdebug.h>
 #include <canonps.h>
 #include <simpletimer.h>
-#include "pseventparser.h"
+#include <pseventparser.h>
 #include "ptpobjinfoparser.h"
 
 class CamStateHandlers : public PSStateHandlers
@@ -19,9 +19,16 @@ public:
       virtual void OnDeviceInitializedState(PTP *ptp);
 } CamStates;
 
+class EventHandlers : public PSEventHandlers
+{
+public:
+      virtual void OnEvents(const PSEvent *events, uint8_t num);
+} EvtHandlers;
+
 USB                 Usb;
 USBHub              Hub1(&Usb);
 CanonPS             Ps(&Usb, &CamStates);
+PSEventDrain        EvtDrain(&Ps, &EvtHandlers);
 
 SimpleTimer  eventTimer, captureTimer;
 
@@ -78,16 +85,28 @@ void OnCaptureTimer()
         ErrorMessage<uint16_t>("Error", rc);
 }
 
-void OnEventTimer()
+void EventHandlers::OnEvents(const PSEvent *events, uint8_t num)
 {
-    PSEventParser  prs;
-    Ps.EventCheck(&prs);
-
-    if (uint32_t handle = prs.GetObjHandle())
+    for (uint8_t i=0; i<num; i++)
     {
-                PTPObjInfoParser     inf;
-                Ps.GetObjectInfo(handle, &inf);
+        if (events[i].eventCode == PTP_EC_ObjectAdded)
+        {
+            E_Notify(PSTR("\r\nObject Added:\t\t"),0x80);
+            PrintHex<uint32_t>(events[i].params[0],0x80);
+            E_Notify(PSTR("\r\n"),0x80);
+
+            PTPObjInfoParser     inf;
+            Ps.GetObjectInfo(events[i].params[0], &inf);
+        }
+        if (events[i].eventCode == PTP_EC_CaptureComplete)
+            E_Notify(PSTR("\r\nCapture complete.\r\n"),0x80);
     }
 }
 
+void OnEventTimer()
+{
+    // all pending events in one go
+    EvtDrain.Drain();
+}
+
 
@@ -0,0 +1,154 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <canonps.h>
+#include <psstorage.h>
+#include <ptphash.h>
+
+class CamStateHandlers : public PSStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+// Prints the folder and remembers the first file for download
+class EntryPrinter : public PSFolderEntryHandlers
+{
+public:
+      uint32_t  fileHandle;
+      uint32_t  fileSize;
+
+      EntryPrinter() : fileHandle(0), fileSize(0) {};
+
+      virtual void OnFolderEntry(const PSFolderEntry *entry)
+      {
+          E_Notify(PSTR("\r\n"),0x80);
+          PrintHex<uint32_t>(entry->objectHandle, 0x80);
+          Serial.print(" ");
+          Serial.print(entry->fileName);
+
+          if (entry->IsFolder())
+              E_Notify(PSTR(" <DIR>"),0x80);
+          else
+          {
+              Serial.print(" ");
+              Serial.print(entry->objectSize, DEC);
+
+              if (!fileHandle)
+              {
+                  fileHandle  = entry->objectHandle;
+                  fileSize    = entry->objectSize;
+              }
+          }
+      };
+};
+
+// Counts the bytes of the downloaded file. Replace with an SD card writer.
+class ByteCountSink : public PTPReadParser
+{
+public:
+      uint32_t  numBytes;
+
+      ByteCountSink() : numBytes(0) {};
+
+      virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+      {
+          numBytes += (offset) ? len : len - 12;
+      };
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+CanonPS             Ps(&Usb, &CamStates);
+EntryPrinter        Printer;
+PSFolderEntryParser EntryParser(&Printer);
+ByteCountSink       Sink;
+PTPHashParser       Hash(&Sink);
+PSChunkedDownload   Download;
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("\r\nCamera disconnected\r\n"),0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("\r\nCamera connected\r\n"),0x80);
+
+        // container header, number of IDs, the first ID
+        uint8_t   buf[20];
+        uint16_t  rc = Ps.GetStorageIDs(sizeof(buf), buf);
+
+        if (rc != PTP_RC_OK)
+        {
+            ErrorMessage<uint16_t>("GetStorageIDs", rc);
+            return;
+        }
+        uint32_t  storage = *((uint32_t*)(buf + 16));
+        uint32_t  time_start = millis();
+
+        // the whole root folder in one transaction
+        EntryParser.Reset();
+
+        if ((rc = Ps.GetFolderEntries(storage, 0, &EntryParser)) != PTP_RC_OK)
+            ErrorMessage<uint16_t>("GetFolderEntries", rc);
+
+        E_Notify(PSTR("\r\nEntries: "),0x80);
+        Serial.print(EntryParser.GetNumEntries(), DEC);
+        E_Notify(PSTR(" ms: "),0x80);
+        Serial.print(millis() - time_start, DEC);
+
+        // the checksum is taken on the way to the sink, no need to read the file back
+        if (Printer.fileHandle)
+        {
+            Hash.Reset();
+            Download.Setup(Printer.fileHandle, &Hash, Printer.fileSize);
+        }
+    }
+    // one chunk per call
+    if (!Download.IsDone())
+    {
+        Download.Step(ptp);
+
+        if (Download.IsDone())
+        {
+            E_Notify(PSTR("\r\nDownloaded: "),0x80);
+            Serial.print(Sink.numBytes, DEC);
+            E_Notify(PSTR(" CRC32: "),0x80);
+            PrintHex<uint32_t>(Hash.GetCrc32(), 0x80);
+
+            if (Download.GetResult() != PTP_RC_OK)
+                ErrorMessage<uint16_t>(" Error", Download.GetResult());
+        }
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -8,7 +8,7 @@
 
 #include "ptpdpparser.h"
 #include "ptpobjinfoparser.h"
-#include "pseventparser.h"
+#include <pseventparser.h>
 #include "psconsole.h"
 
 using namespace QP;
@@ -86,9 +86,15 @@ void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
 
         if (uint32_t handle = prs.GetObjHandle())
         {
+                    E_Notify(PSTR("\r\nObject Added:\t\t"),0x80);
+                    PrintHex<uint32_t>(handle,0x80);
+                    E_Notify(PSTR("\r\n"),0x80);
+
                     PTPObjInfoParser     inf;
                     Ps.GetObjectInfo(handle, &inf);
         }
+        if (prs.IsEvent() && prs.GetEvent()->eventCode == PTP_EC_CaptureComplete)
+                    E_Notify(PSTR("\r\nCapture complete.\r\n"),0x80);
     }
 }
 
@@ -0,0 +1,119 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <canonps.h>
+#include <psviewfinder.h>
+
+class CamStateHandlers : public PSStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+// Counts viewfinder bytes. Frames are passed through as they arrive, which
+// needs no frame buffer. Replace with a serial or SD writer.
+class ByteCountSink : public PTPReadParser
+{
+public:
+      uint32_t  numBytes;
+
+      ByteCountSink() : numBytes(0) {};
+
+      virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+      {
+          numBytes += (offset) ? len : len - 12;
+      };
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+CanonPS             Ps(&Usb, &CamStates);
+ByteCountSink       Sink;
+PSViewfinder        Viewfinder(&Ps, &Sink);
+
+// On boards with enough RAM whole frames can be kept in a buffer pool:
+//   uint8_t  frameBuf[2][16384];
+//   Viewfinder.AddBuffer(frameBuf[0], sizeof(frameBuf[0])); ...
+// and taken with GetFrame() / ReleaseFrame().
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("\r\nCamera disconnected\r\n"),0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    static uint32_t next_report = 0;
+
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("\r\nCamera connected\r\n"),0x80);
+
+        uint16_t  rc = Viewfinder.Start();
+
+        if (rc != PTP_RC_OK)
+            ErrorMessage<uint16_t>("Viewfinder", rc);
+    }
+    Viewfinder.Task();
+
+    uint32_t  time_now = millis();
+
+    if (time_now > next_report)
+    {
+        next_report = time_now + 5000;
+
+        const PSViewfinderStats  *st = Viewfinder.GetStats();
+        uint16_t  fps = Viewfinder.GetFrameRate();
+
+        E_Notify(PSTR("\r\nFrames: "),0x80);
+        Serial.print(st->numFrames, DEC);
+        E_Notify(PSTR(" fps: "),0x80);
+        Serial.print(fps / 100, DEC);
+        Serial.print(".");
+        Serial.print(fps % 100, DEC);
+        E_Notify(PSTR(" bytes: "),0x80);
+        Serial.print(Sink.numBytes, DEC);
+        E_Notify(PSTR(" errors: "),0x80);
+        Serial.print(st->numErrors, DEC);
+
+        if (st->numFrames)
+        {
+            E_Notify(PSTR(" latency, us avg: "),0x80);
+            Serial.print(Viewfinder.GetLatency(), DEC);
+            E_Notify(PSTR(" min: "),0x80);
+            Serial.print(st->latMin, DEC);
+            E_Notify(PSTR(" max: "),0x80);
+            Serial.print(st->latMax, DEC);
+        }
+        if (!Viewfinder.IsRunning())
+            E_Notify(PSTR(" stopped"),0x80);
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
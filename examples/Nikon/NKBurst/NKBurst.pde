@@ -0,0 +1,105 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <nikon.h>
+#include <nkburst.h>
+
+#define BURST_FRAMES    10
+
+class CamStateHandlers : public PTPStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+// Prints frame numbers only. Replace with an SD card writer.
+class FrameSink : public NKBurstSink
+{
+public:
+      virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset) {};
+      virtual void OnFrameEnd(uint16_t frame, uint16_t rc)
+      {
+          E_Notify(PSTR("\r\nFrame: "),0x80);
+          Serial.print(frame, DEC);
+
+          if (rc != PTP_RC_OK)
+              ErrorMessage<uint16_t>(" Error", rc);
+      };
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+NikonDSLR           Nik(&Usb, &CamStates);
+FrameSink           Sink;
+NKBurst             Burst(&Nik, &Sink);
+
+void PrintStage(const char *name, const NKStageTime *st, uint16_t frames)
+{
+    E_Notify(name,0x80);
+    Serial.print(st->Average(frames), DEC);
+    E_Notify(PSTR(" max: "),0x80);
+    Serial.print(st->max, DEC);
+}
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        Burst.Stop();
+        E_Notify(PSTR("\r\nDevice disconnected.\r\n"),0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("\r\nDevice connected.\r\n"),0x80);
+        Burst.Start(BURST_FRAMES);
+    }
+    if (!Burst.IsRunning())
+        return;
+
+    Burst.Task();
+
+    if (Burst.IsRunning())
+        return;
+
+    const NKBurstStats  *st = Burst.GetStats();
+
+    E_Notify(PSTR("\r\nFrames/sec x100: "),0x80);
+    Serial.print(Burst.GetFrameRate(), DEC);
+
+    if (!st->numFrames)
+        return;
+
+    PrintStage(PSTR("\r\nCapture, us: "), &st->stCapture, st->numFrames);
+    PrintStage(PSTR("\r\nReady, us: "), &st->stReady, st->numFrames);
+    PrintStage(PSTR("\r\nDownload, us: "), &st->stDownload, st->numFrames);
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -0,0 +1,95 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <nikon.h>
+#include <nkfileindex.h>
+
+// 27 bytes per object, mind the RAM of the board
+#define INDEX_SIZE      32
+// NK_OC_GetFileInfoInBlock data layout is assumed, the index falls back to
+// GetObjectInfo if the camera sends something else
+#define BLOCK_INFO      true
+
+class CamStateHandlers : public PTPStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+NikonDSLR           Nik(&Usb, &CamStates);
+NKFileInfo          Records[INDEX_SIZE];
+NKFileIndex         Index(&Nik, Records, INDEX_SIZE);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        Index.Stop();
+        E_Notify(PSTR("\r\nDevice disconnected.\r\n"),0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("\r\nDevice connected.\r\n"),0x80);
+        Index.Start(0xFFFFFFFF, BLOCK_INFO);
+    }
+    if (!Index.IsRunning())
+        return;
+
+    Index.Task();
+
+    if (Index.IsRunning())
+        return;
+
+    const NKFileIndexStats  *st = Index.GetStats();
+
+    for (uint16_t i=0; i<Index.GetCount(); i++)
+    {
+        E_Notify(PSTR("\r\n"),0x80);
+        PrintHex<uint32_t>(Records[i].handle, 0x80);
+        Serial.print(" ");
+        Serial.print(Records[i].fileName);
+        Serial.print(" ");
+        Serial.print(Records[i].size, DEC);
+    }
+    E_Notify(PSTR("\r\nObjects: "),0x80);
+    Serial.print(st->numObjects, DEC);
+    E_Notify(PSTR(" transactions: "),0x80);
+    Serial.print(st->numTransactions, DEC);
+    E_Notify(PSTR(" ms: "),0x80);
+    Serial.print(st->timeEnd - st->timeStart, DEC);
+
+    if (BLOCK_INFO && !Index.IsBlockSupported())
+        E_Notify(PSTR(" (no block info)"),0x80);
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
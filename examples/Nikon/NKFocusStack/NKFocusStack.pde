@@ -0,0 +1,105 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <nikon.h>
+#include <nkfocusstack.h>
+
+#define STACK_START     -2000       // steps towards the closest distance before the first frame
+#define STACK_STEP      100         // steps towards infinity between frames
+#define STACK_FRAMES    40
+
+class CamStateHandlers : public PTPStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+NikonDSLR           Nikon(&Usb, &CamStates);
+NKFocusStack        Stack(&Nikon);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        Stack.Stop();
+        E_Notify(PSTR("\r\nDevice disconnected.\r\n"),0x80);
+    }
+}
+
+void PrintStage(const char *name, const PTPFocusStageTime *st, uint16_t frames)
+{
+    Serial.print(name);
+    Serial.print(st->sum / frames, DEC);
+    Serial.print("/");
+    Serial.print(st->max, DEC);
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("\r\nDevice connected.\r\n"),0x80);
+
+        uint16_t  rc = Nikon.Operation(PTP_OC_NIKON_StartLiveView, 0, NULL);
+
+        if (rc != PTP_RC_OK)
+        {
+            ErrorMessage<uint16_t>("StartLiveView", rc);
+            return;
+        }
+        Stack.Start(STACK_START, STACK_STEP, STACK_FRAMES);
+    }
+    if (!Stack.IsRunning())
+        return;
+
+    Stack.Task();
+
+    if (Stack.IsRunning())
+        return;
+
+    const PTPFocusStackStats  *st = Stack.GetStats();
+
+    E_Notify(PSTR("\r\nFrames: "),0x80);
+    Serial.print(st->numFrames, DEC);
+    E_Notify(PSTR(" total, ms: "),0x80);
+    Serial.print(st->timeEnd - st->timeStart, DEC);
+
+    if (!st->numFrames)
+        return;
+
+    E_Notify(PSTR(" frame min/max: "),0x80);
+    Serial.print(st->frameMin, DEC);
+    Serial.print("/");
+    Serial.print(st->frameMax, DEC);
+    PrintStage("\r\ndrive avg/max: ", &st->stDrive, st->numFrames);
+    PrintStage(" settle: ", &st->stSettle, st->numFrames);
+    PrintStage(" capture: ", &st->stCapture, st->numFrames);
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -1,10 +1,9 @@
 #include <usbhub.h>
 
-#include <eoseventdump.h>
-
 #include <ptp.h>
 #include <ptpdebug.h>
 #include <nikon.h>
+#include <nkcontrastaf.h>
 
 class CamStateHandlers : public PTPStateHandlers
 {
@@ -18,55 +17,19 @@ public:
       virtual void OnDeviceInitializedState(PTP *ptp);
 };
 
-class Nikon : public NikonDSLR
-{
-    uint32_t     nextPollTime;   // Time of the next poll to occure
-
-public:
-    bool         bPollEnabled;   // Enables or disables camera poll
-    bool         bLVEnabled;
-    uint32_t     nStep;
-
-    Nikon(USB *pusb, PTPStateHandlers *pstates) : NikonDSLR(pusb, pstates), nextPollTime(0), bPollEnabled(false), bLVEnabled(false), nStep(0)
-    {
-    };
-
-    virtual uint8_t Poll()
-    {
-        static bool first_time = true;
-        PTP::Poll();
-
-        if (!bPollEnabled)
-            return 0;
-
-        uint32_t  current_time = millis();
-
-        if (current_time >= nextPollTime)
-        {
-            Serial.println("\r\n");
-
-            HexDump  hex;
-            //GetLiveViewImage(&hex);
-
-            nextPollTime = current_time + 1000;
-        }
-        first_time = false;
-        return 0;
-    };
-};
-
 CamStateHandlers    CamStates;
 USB                 Usb;
 USBHub              Hub1(&Usb);
-Nikon               Nik(&Usb, &CamStates);
+NikonDSLR           Nik(&Usb, &CamStates);
+NKContrastAF        Focus(&Nik);
 
 void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
 {
     PTPTRACE("Disconnected\r\n");
     if (stateConnected == stConnected || stateConnected == stInitial)
     {
-        ((Nikon*)ptp)->bPollEnabled = false;
         stateConnected = stDisconnected;
+        Focus.Stop();
         E_Notify(PSTR("\r\nDevice disconnected.\r\n"),0x80);
     }
 }
@@ -77,18 +40,38 @@ void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
     {
         stateConnected = stConnected;
         E_Notify(PSTR("\r\nDevice connected.\r\n"),0x80);
-        ((Nikon*)ptp)->bPollEnabled = true;
 
-        uint16_t  ret = ptp->Operation(PTP_OC_NIKON_StartLiveView, 0, NULL);
+        uint16_t  ret = Nik.StartLiveView();
 
-        ((Nikon*)ptp)->bLVEnabled = (ret == PTP_RC_OK);
+        if (ret != PTP_RC_OK)
+        {
+            ErrorMessage<uint16_t>("Live view", ret);
+            return;
+        }
+        // 256 MfDrive steps at first down to single steps, one frame skipped after each move
+        Focus.Start(256, 1, 2, 1);
     }
-    if (!((Nikon*)ptp)->bLVEnabled)
+    if (!Focus.IsRunning())
         return;
 
-    ((Nikon*)ptp)->MoveFocus(((((Nikon*)ptp)->nStep % 10) ? 1 : 2), 64);
-    ((Nikon*)ptp)->nStep ++;
-    delay(100);
+    Focus.Task();
+
+    if (Focus.IsRunning())
+        return;
+
+    const PTPContrastAFStats  *st = Focus.GetStats();
+
+    E_Notify((Focus.IsConverged()) ? PSTR("\r\nIn focus") : PSTR("\r\nGave up"),0x80);
+    E_Notify(PSTR(", ms: "),0x80);
+    Serial.print(Focus.GetConvergenceTime(), DEC);
+    E_Notify(PSTR(" moves: "),0x80);
+    Serial.print(st->numMoves, DEC);
+    E_Notify(PSTR(" frames: "),0x80);
+    Serial.print(st->numFrames, DEC);
+    E_Notify(PSTR(" position: "),0x80);
+    Serial.print(st->bestPos, DEC);
+    E_Notify(PSTR(" score: "),0x80);
+    Serial.print(st->bestValue, DEC);
 }
 
 void setup()
@@ -106,4 +89,3 @@ void loop()
 {
     Usb.Task();
 }
-
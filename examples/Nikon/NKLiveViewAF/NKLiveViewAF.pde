@@ -0,0 +1,124 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <nikon.h>
+#include <nkliveview.h>
+
+class CamStateHandlers : public PTPStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+};
+
+// Counts JPEG bytes and keeps the AF area of the last frame.
+// Replace Parse() with a serial or SD writer.
+class FrameSink : public NKLiveViewSink
+{
+public:
+      uint32_t  numBytes;
+      uint16_t  afX, afY;
+
+      FrameSink() : numBytes(0), afX(0), afY(0) {};
+
+      virtual void OnHeader(const NKLiveViewHeader *hdr)
+      {
+          afX = hdr->afCenterX;
+          afY = hdr->afCenterY;
+      };
+      virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+      {
+          numBytes += len;
+      };
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+NikonDSLR           Nik(&Usb, &CamStates);
+FrameSink           Sink;
+NKLiveView          LiveView(&Nik, &Sink);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp)
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("\r\nDevice disconnected.\r\n"),0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    static uint32_t next_report = 0;
+
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("\r\nDevice connected.\r\n"),0x80);
+
+        uint16_t  rc = LiveView.Start();
+
+        if (rc != PTP_RC_OK)
+            ErrorMessage<uint16_t>("Live view", rc);
+    }
+    LiveView.Task();
+
+    // '1'..'9' moves the AF area to the matching cell of a 3x3 grid
+    if (Serial.available())
+    {
+        uint8_t  c = Serial.read();
+
+        if (c >= '1' && c <= '9')
+        {
+            const NKLiveViewHeader  *hdr = LiveView.GetHeader();
+            uint8_t   cell = c - '1';
+
+            LiveView.MoveAfArea(hdr->jpegWidth * (1 + 2 * (cell % 3)) / 6, hdr->jpegHeight * (1 + 2 * (cell / 3)) / 6);
+        }
+    }
+    uint32_t  time_now = millis();
+
+    if (time_now > next_report)
+    {
+        next_report = time_now + 2000;
+
+        const NKLiveViewStats  *st = LiveView.GetStats();
+        uint16_t  fps = LiveView.GetFrameRate();
+
+        E_Notify(PSTR("\r\nFrames: "),0x80);
+        Serial.print(st->numFrames, DEC);
+        E_Notify(PSTR(" fps: "),0x80);
+        Serial.print(fps / 100, DEC);
+        Serial.print(".");
+        Serial.print(fps % 100, DEC);
+        E_Notify(PSTR(" last JPEG: "),0x80);
+        Serial.print(st->lastSize, DEC);
+        E_Notify(PSTR(" AF area: "),0x80);
+        Serial.print(Sink.afX, DEC);
+        Serial.print(",");
+        Serial.print(Sink.afY, DEC);
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
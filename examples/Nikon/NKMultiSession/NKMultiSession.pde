@@ -0,0 +1,118 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <nikon.h>
+#include <nkeventparser.h>
+#include <ptpsession.h>
+
+#define NUM_CAMERAS     2
+
+class CamStateHandlers : public PTPStateHandlers
+{
+public:
+      // all transactions are run by the session manager
+      virtual void OnDeviceInitializedState(PTP *ptp) {};
+};
+
+// Counts the bytes of each downloaded object. Replace with an SD card writer.
+class ByteCountSink : public PTPReadParser
+{
+public:
+      uint32_t  numBytes;
+
+      ByteCountSink() : numBytes(0) {};
+
+      virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+      {
+          numBytes += (offset) ? len : len - 12;
+      };
+};
+
+class Download : public PTPChunkedDownload
+{
+public:
+      uint8_t       camIndex;
+      ByteCountSink theSink;
+
+      virtual void OnComplete(uint16_t rc)
+      {
+          E_Notify(PSTR("\r\nCamera: "),0x80);
+          Serial.print(camIndex, DEC);
+          E_Notify(PSTR(" bytes: "),0x80);
+          Serial.print(theSink.numBytes, DEC);
+
+          if (rc != PTP_RC_OK)
+              ErrorMessage<uint16_t>(" Error", rc);
+      };
+};
+
+PTPSessionManager   Manager;
+
+// Queues a download of every object the camera reports
+class CamEvents : public NKEventHandlers
+{
+public:
+      uint8_t       camIndex;
+      Download      theJob;
+
+      virtual void OnEvent(const NKEvent *evt)
+      {
+          if (evt->eventCode != PTP_EC_ObjectAdded || !theJob.IsDone())
+              return;
+
+          theJob.theSink.numBytes = 0;
+          theJob.Setup(evt->dwParam, &theJob.theSink);
+          Manager.Submit(camIndex, &theJob);
+      };
+};
+
+CamStateHandlers    CamStates;
+USB                 Usb;
+USBHub              Hub1(&Usb);
+NikonDSLR           Nikon1(&Usb, &CamStates);
+NikonDSLR           Nikon2(&Usb, &CamStates);
+CamEvents           Events[NUM_CAMERAS];
+NKEventParser       Parser1(&Events[0]);
+NKEventParser       Parser2(&Events[1]);
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    Events[0].camIndex = Events[0].theJob.camIndex = Manager.Add(&Nikon1, &Parser1);
+    Events[1].camIndex = Events[1].theJob.camIndex = Manager.Add(&Nikon2, &Parser2);
+
+    delay( 200 );
+}
+
+void loop()
+{
+    static uint32_t next_report = 0;
+
+    Usb.Task();
+    Manager.Task();
+
+    if ((int32_t)(millis() - next_report) < 0)
+        return;
+
+    next_report = millis() + 10000;
+
+    for (uint8_t i=0; i<NUM_CAMERAS; i++)
+    {
+        const PTPSessionStats *st = Manager.GetStats(i);
+
+        E_Notify(PSTR("\r\nCamera: "),0x80);
+        Serial.print(i, DEC);
+        E_Notify(PSTR(" queue: "),0x80);
+        Serial.print(st->queueDepth, DEC);
+        E_Notify(PSTR(" event latency max, ms: "),0x80);
+        Serial.print(st->evtLatMax, DEC);
+        E_Notify(PSTR(" job latency max: "),0x80);
+        Serial.print(st->jobLatMax, DEC);
+    }
+}
@@ -3,6 +3,7 @@
 #include <ptp.h>
 #include <nkeventparser.h>
 #include <nikon.h>
+#include <ptppoller.h>
 #include "qp_port.h"
 #include <valuelist.h>
 #include <nkvaluetitles.h>
@@ -40,10 +41,8 @@ class CamStateHandlers : public PTPStateHandlers
       enum CamStates { stInitial, stDisconnected, stConnected };
       CamStates stateConnected;
 
-      uint32_t nextPollTime;
-
 public:
-      CamStateHandlers() : stateConnected(stInitial), nextPollTime(0)
+      CamStateHandlers() : stateConnected(stInitial)
       {
       };
 
@@ -56,6 +55,8 @@ CamStateHandlers  CamStates;
 USB                 Usb;
 NikonDSLR           Nk(&Usb, &CamStates);
 NKEventDump         Dmp;
+NKEventParser       Prs(&Dmp);
+PTPEventPoller      Poller(&Nk, &Prs, NK_EVENT_EMPTY_SIZE);
 
 QEvent            evtTick;
 PSConsole         psConsole;
@@ -97,16 +98,9 @@ void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
         menu_sel_evt.sig         = MENU_SELECT_SIG;
         menu_sel_evt.item_index  = index;
         psConsole.dispatch(&menu_sel_evt);      // dispatch the event
+        Poller.Kick();                          // the camera is likely to report changes
     }
-    uint32_t time_now = millis();
-
-    if (time_now >= nextPollTime)
-    {
-        nextPollTime = time_now + 300;
-
-        NKEventParser  prs(&Dmp);
-        Nk.EventCheck(&prs);
-    }
+    Poller.Task();
 }
 
 void setup()
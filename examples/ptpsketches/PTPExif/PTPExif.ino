@@ -0,0 +1,121 @@
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <ptpexif.h>
+
+// Set to the handle of an existing JPEG, CR2 or NEF object
+#define OBJECT_HANDLE	0x00000001
+// Exif data of camera files rarely lies further than this
+#define HEAD_SIZE		0x10000
+
+class CamStateHandlers : public PTPStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+} CamStates;
+
+class ExifPrinter : public PTPExifHandlers
+{
+public:
+      virtual bool WantValue(uint8_t ifd, uint16_t tag)
+      {
+          return (ifd != PTP_EXIF_SUBIFD);
+      };
+
+      virtual void OnField(const PTPExifField *field)
+      {
+          E_Notify(PSTR("\r\n"), 0x80);
+          Serial.print(field->ifd, DEC);
+          Serial.print(" ");
+          PrintHex<uint16_t>(field->tag, 0x80);
+          Serial.print(" ");
+
+          if (field->str)
+              Serial.print(field->str);
+          else
+          {
+              Serial.print(field->value, DEC);
+
+              if (field->type == 5 || field->type == 10)
+              {
+                  Serial.print("/");
+                  Serial.print(field->denom, DEC);
+              }
+          }
+      };
+
+      virtual void OnPreview(uint8_t ifd, uint32_t offset, uint32_t size)
+      {
+          E_Notify(PSTR("\r\nPreview in IFD "), 0x80);
+          Serial.print(ifd, DEC);
+          E_Notify(PSTR(" offset: "), 0x80);
+          Serial.print(offset, DEC);
+          E_Notify(PSTR(" size: "), 0x80);
+          Serial.print(size, DEC);
+      };
+};
+
+USB             Usb;
+USBHub          Hub1(&Usb);
+PTP             Ptp(&Usb, &CamStates);
+ExifPrinter     Printer;
+PTPExifParser   Exif(&Printer);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp
+    __attribute__((unused)))
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("Camera disconnected\r\n"), 0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("Camera connected\r\n"), 0x80);
+
+        uint32_t  time_start = millis();
+
+        // Only the head of the file goes over the wire. With GetObject the
+        // parser would idle through the rest of the transfer once done.
+        Exif.Reset();
+        uint16_t  rc = ptp->GetPartialObject(OBJECT_HANDLE, 0, HEAD_SIZE, &Exif);
+
+        if (rc != PTP_RC_OK)
+            ErrorMessage<uint16_t>("GetPartialObject", rc);
+
+        E_Notify(PSTR("\r\nms: "), 0x80);
+        Serial.print(millis() - time_start, DEC);
+        E_Notify(PSTR(" complete: "), 0x80);
+        Serial.print(Exif.IsDone(), DEC);
+        E_Notify(PSTR(" missed: "), 0x80);
+        Serial.println(Exif.GetMissed(), DEC);
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
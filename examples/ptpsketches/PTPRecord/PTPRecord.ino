@@ -0,0 +1,95 @@
+// Records the camera session to PTPREC.BIN on the SD card.
+// Play it back without the camera with the PTPReplay sketch.
+
+// #include <usbhub.h>
+#include <SD.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <ptprecorder.h>
+
+#define SD_CS_PIN   4
+
+class SDWriter : public PTPRecordWriter
+{
+public:
+      File  theFile;
+
+      virtual void Write(const uint16_t len, const uint8_t *pbuf) { theFile.write(pbuf, len); };
+};
+
+class CamStateHandlers : public PTPStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+} CamStates;
+
+USB         Usb;
+// USBHub      Hub1(&Usb);
+PTP         ptp_instance(&Usb, &CamStates);
+SDWriter    Writer;
+PTPRecorder Recorder(&Writer);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp
+    __attribute__((unused)))
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("Camera disconnected\r\n"), 0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP* ptp
+    __attribute__((unused)))
+{
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("Camera connected\r\n"), 0x80);
+
+        HexDump dmp;
+        ptp_instance.GetDeviceInfo(&dmp);
+        ptp_instance.GetStorageIDs(&dmp);
+
+        Recorder.Stop();
+        Writer.theFile.close();
+
+        E_Notify(PSTR("\r\nRecorded transfers: "), 0x80);
+        Serial.print(Recorder.GetCount(), DEC);
+        E_Notify(PSTR(" bytes: "), 0x80);
+        Serial.println(Recorder.GetSize(), DEC);
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (!SD.begin(SD_CS_PIN))
+        Serial.println("SD card failed");
+
+    SD.remove("PTPREC.BIN");
+    Writer.theFile = SD.open("PTPREC.BIN", FILE_WRITE);
+
+    // started before the camera is connected, so OpenSession is recorded as well
+    Recorder.Start();
+    ptp_instance.SetRecorder(&Recorder);
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
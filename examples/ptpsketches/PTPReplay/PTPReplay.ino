@@ -0,0 +1,61 @@
+// Plays PTPREC.BIN made by the PTPRecord sketch back, no camera needed.
+// The output should be the same as the one of PTPRecord.
+
+#include <SD.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <ptpreplay.h>
+
+#define SD_CS_PIN   4
+
+class SDReader : public PTPRecordReader
+{
+public:
+      File  theFile;
+
+      virtual uint16_t Read(const uint16_t len, uint8_t *pbuf) { return theFile.read(pbuf, len); };
+};
+
+USB         Usb;
+PTP         ptp_instance(&Usb, NULL);
+SDReader    Reader;
+PTPReplay   Replay(&Reader);
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (!SD.begin(SD_CS_PIN))
+        Serial.println("SD card failed");
+
+    Reader.theFile = SD.open("PTPREC.BIN");
+
+    if (!Replay.Open())
+    {
+        Serial.println("Not a PTP recording");
+        return;
+    }
+    ptp_instance.SetTransport(&Replay);
+
+    // the same calls in the same order as in PTPRecord
+    ptp_instance.OpenSession();
+
+    HexDump dmp;
+    ptp_instance.GetDeviceInfo(&dmp);
+    ptp_instance.GetStorageIDs(&dmp);
+
+    E_Notify(PSTR("\r\nPlayed transfers: "), 0x80);
+    Serial.print(Replay.GetCount(), DEC);
+    E_Notify(PSTR(" mismatches: "), 0x80);
+    Serial.print(Replay.GetMismatches(), DEC);
+    E_Notify(PSTR(" recorded time, ms: "), 0x80);
+    Serial.println(Replay.GetTime() / 1000, DEC);
+
+    Reader.theFile.close();
+}
+
+void loop()
+{
+}
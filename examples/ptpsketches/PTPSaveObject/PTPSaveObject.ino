@@ -0,0 +1,119 @@
+#include <SPI.h>
+#include <SD.h>
+#include <usbhub.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <ptpblocksink.h>
+
+// Set to the handle of an existing object
+#define OBJECT_HANDLE	0x00000001
+#define OBJECT_FILE		"OBJECT.JPG"
+// Chip select of the SD card, it must differ from the one of the USB Host Shield
+#define SD_CS_PIN		4
+
+class CamStateHandlers : public PTPStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+} CamStates;
+
+// SD library writes are synchronous, Wait() has nothing to do. The SD library
+// cannot size a file without writing it, so Reserve() is left as it is.
+class SDWriter : public PTPBlockWriter
+{
+public:
+      File    theFile;
+
+      virtual bool Write(const uint8_t *pbuf, uint16_t len)
+      {
+          return (theFile.write(pbuf, len) == len);
+      };
+
+      virtual bool Close(uint32_t size __attribute__((unused)))
+      {
+          theFile.close();
+          return true;
+      };
+};
+
+USB             Usb;
+USBHub          Hub1(&Usb);
+PTP             Ptp(&Usb, &CamStates);
+SDWriter        Writer;
+PTPBlockSink    Sink(&Writer);
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp
+    __attribute__((unused)))
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("Camera disconnected\r\n"), 0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
+{
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("Camera connected\r\n"), 0x80);
+
+        SD.remove(OBJECT_FILE);
+        Writer.theFile = SD.open(OBJECT_FILE, FILE_WRITE);
+
+        if (!Writer.theFile)
+        {
+            E_Notify(PSTR("File open failed\r\n"), 0x80);
+            return;
+        }
+        Sink.Start();
+
+        uint16_t  rc = ptp->GetObject(OBJECT_HANDLE, &Sink);
+
+        if (rc != PTP_RC_OK)
+            ErrorMessage<uint16_t>("GetObject", rc);
+
+        if (!Sink.Finish())
+            E_Notify(PSTR("Write failed\r\n"), 0x80);
+
+        const PTPBlockSinkStats   *stats = Sink.GetStats();
+
+        E_Notify(PSTR("Bytes: "), 0x80);
+        Serial.print(Sink.GetSize(), DEC);
+        E_Notify(PSTR(" blocks: "), 0x80);
+        Serial.print(stats->numBlocks, DEC);
+        E_Notify(PSTR(" KB/s: "), 0x80);
+        Serial.print(Sink.GetRate(), DEC);
+        E_Notify(PSTR(" write KB/s: "), 0x80);
+        Serial.print(Sink.GetWriteRate(), DEC);
+        E_Notify(PSTR(" longest write us: "), 0x80);
+        Serial.println(stats->maxWrite, DEC);
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (!SD.begin(SD_CS_PIN))
+        Serial.println("SD card failed.");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
@@ -1,8 +1,12 @@
-// #include <usbhub.h>
+#include <usbhub.h>
 
 #include <ptp.h>
-// #include <ptpdebug.h>
-#include "ptpobject.h"
+#include <ptpdebug.h>
+#include <ptpupload.h>
+
+// 0 leaves the choice of the storage and folder to the camera
+#define STORAGE_ID		0x00000000
+#define PARENT_HANDLE	0x00000000
 
 class CamStateHandlers : public PTPStateHandlers
 {
@@ -16,9 +20,16 @@ public:
       virtual void OnDeviceInitializedState(PTP *ptp);
 } CamStates;
 
-USB      Usb;
-// USBHub   Hub1(&Usb);
-PTP      Ptp(&Usb, &CamStates);
+// Object data, replace with a supplier reading from an SD card file
+const uint8_t   objData[] PROGMEM = "Dummy string\r\n";
+
+USB             Usb;
+USBHub          Hub1(&Usb);
+PTP             Ptp(&Usb, &CamStates);
+
+// 8 full speed packets per transfer
+uint8_t         txBuffer[512];
+PTPUpload       Upload(txBuffer, sizeof(txBuffer));
 
 void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp
     __attribute__ ((unused)))
@@ -30,33 +41,29 @@ void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp
     }
 }
 
-void CamStateHandlers::OnDeviceInitializedState(PTP *ptp
-    __attribute__((unused)))
+void CamStateHandlers::OnDeviceInitializedState(PTP *ptp)
 {
     if (stateConnected == stDisconnected || stateConnected == stInitial)
     {
         stateConnected = stConnected;
         E_Notify(PSTR("Camera connected\r\n"), 0x80);
 
-        // Ptp.CaptureImage();
-        // delay(100);
-
-        PTPFileInfoSupplier fileinfo(0x00010001, 0, PSTR("TEST.JPG"), 12);
-        E_Notify(PSTR("Sending ObjectInfo...\r\n"),0x80);
-        // Serial.println(fileinfo.GetDataSize());
-        Ptp.SendObjectInfo(0, &fileinfo);
-        E_Notify(PSTR("ObjectInfo sent\r\n"),0x80);
-        
-        PTPTextFileSupplier file;
-        file.SetText(PSTR("Dummy string"));
-
-        E_Notify(PSTR("Sending Object...\r\n"),0x80);
-        // Ptp.SendObject(0, &file);
-        E_Notify(PSTR("Object sent\r\n"),0x80);
-                
-        E_Notify(PSTR("\n"),0x80);
-
-        Ptp.CloseSession();
+        PTPObjectInfoSupplier   info(PTP_OFC_Text, sizeof(objData) - 1, "TEST.TXT");
+        PTPBufferSupplier       data(objData, sizeof(objData) - 1, true);
+
+        E_Notify(PSTR("Sending object...\r\n"),0x80);
+
+        uint16_t  rc = Upload.Send(ptp, STORAGE_ID, PARENT_HANDLE, &info, &data);
+
+        if (rc != PTP_RC_OK)
+        {
+            ErrorMessage<uint16_t>("Upload", rc);
+            return;
+        }
+        E_Notify(PSTR("Object sent, handle: "),0x80);
+        PrintHex<uint32_t>(Upload.GetHandle(), 0x80);
+        E_Notify(PSTR(" KB/s: "),0x80);
+        Serial.println(Upload.GetRate(), DEC);
     }
 }
 
@@ -75,4 +82,3 @@ void loop()
 {
     Usb.Task();
 }
-
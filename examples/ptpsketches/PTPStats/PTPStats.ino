@@ -0,0 +1,126 @@
+// #include <usbhub.h>
+
+#include <ptp.h>
+#include <ptpdebug.h>
+#include <ptpstats.h>
+
+class CamStateHandlers : public PTPStateHandlers
+{
+      enum CamStates { stInitial, stDisconnected, stConnected };
+      CamStates stateConnected;
+
+public:
+      CamStateHandlers() : stateConnected(stInitial) {};
+
+      virtual void OnDeviceDisconnectedState(PTP *ptp);
+      virtual void OnDeviceInitializedState(PTP *ptp);
+} CamStates;
+
+USB      Usb;
+// USBHub   Hub1(&Usb);
+PTP      ptp_instance(&Usb, &CamStates);
+PTPStats Stats;
+
+void PrintTime(const char *msg, const PTPPhaseTime *pt, uint16_t count)
+{
+    E_Notify(msg, 0x80);
+    Serial.print(pt->min, DEC);
+    Serial.print("/");
+    Serial.print(pt->sum / count, DEC);
+    Serial.print("/");
+    Serial.print(pt->max, DEC);
+}
+
+void PrintStats()
+{
+    for (uint8_t i=0; i<Stats.GetCount(); i++)
+    {
+        const PTPOpStats  *op = Stats.GetOp(i);
+
+        E_Notify(PSTR("\r\nOp: "), 0x80);
+        PrintHex<uint16_t>(op->opCode, 0x80);
+        E_Notify(PSTR(" count: "), 0x80);
+        Serial.print(op->count, DEC);
+        E_Notify(PSTR(" failed: "), 0x80);
+        Serial.print(op->numFailed, DEC);
+
+        if (!op->count)
+            continue;
+
+        PrintTime(PSTR("\r\n  total us min/avg/max: "), &op->totalTime, op->count);
+        PrintTime(PSTR("\r\n  command: "), op->phaseTime + PTP_PHASE_COMMAND, op->count);
+        PrintTime(PSTR("\r\n  data: "), op->phaseTime + PTP_PHASE_DATA, op->count);
+        PrintTime(PSTR("\r\n  response: "), op->phaseTime + PTP_PHASE_RESPONSE, op->count);
+
+        E_Notify(PSTR("\r\n  bytes in/out: "), 0x80);
+        Serial.print(op->bytesIn, DEC);
+        Serial.print("/");
+        Serial.print(op->bytesOut, DEC);
+
+        E_Notify(PSTR("\r\n  log2 histogram of 64 us units:"), 0x80);
+
+        for (uint8_t j=0; j<PTP_STATS_BUCKETS; j++)
+        {
+            Serial.print(" ");
+            Serial.print(op->histogram[j], DEC);
+        }
+    }
+    const PTPUsbStats  *usb = Stats.GetUsbStats();
+
+    E_Notify(PSTR("\r\nTransfers: "), 0x80);
+    Serial.print(usb->numTransfers, DEC);
+    E_Notify(PSTR(" errors: "), 0x80);
+    Serial.print(usb->numErrors, DEC);
+    E_Notify(PSTR(" NAK: "), 0x80);
+    Serial.print(usb->numNAK, DEC);
+    E_Notify(PSTR(" untracked: "), 0x80);
+    Serial.println(Stats.GetDropped(), DEC);
+}
+
+void CamStateHandlers::OnDeviceDisconnectedState(PTP *ptp
+    __attribute__((unused)))
+{
+    if (stateConnected == stConnected || stateConnected == stInitial)
+    {
+        stateConnected = stDisconnected;
+        E_Notify(PSTR("Camera disconnected\r\n"), 0x80);
+    }
+}
+
+void CamStateHandlers::OnDeviceInitializedState(PTP* ptp
+    __attribute__((unused)))
+{
+    if (stateConnected == stDisconnected || stateConnected == stInitial)
+    {
+        stateConnected = stConnected;
+        E_Notify(PSTR("Camera connected\r\n"), 0x80);
+
+        Stats.Reset();
+
+        HexDump dmp;
+
+        for (uint8_t i=0; i<10; i++)
+        {
+            ptp_instance.GetDeviceInfo(&dmp);
+            ptp_instance.GetStorageIDs(&dmp);
+        }
+        PrintStats();
+    }
+}
+
+void setup()
+{
+    Serial.begin( 115200 );
+    Serial.println("Start");
+
+    if (Usb.Init() == -1)
+        Serial.println("OSC did not start.");
+
+    ptp_instance.SetStats(&Stats);
+    delay( 200 );
+}
+
+void loop()
+{
+    Usb.Task();
+}
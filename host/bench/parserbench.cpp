@@ -0,0 +1,558 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+// Throughput of the event and property descriptor parsers.
+//
+// Every parser is fed with the same packets cut into chunks of 8, 64 and 512
+// bytes and as whole packets, the way PTP::Transaction would deliver them
+// with different buffer sizes. The packets are synthesized, or taken from
+// the data stages of GetEvent (EOS) and CheckEvent (Nikon) and GetDevicePropDesc transactions
+// of recordings made with PTPRecorder.
+//
+//	parserbench [-t ms] [recording ...]
+//
+// Reports bytes and records per second and the number of heap allocations
+// made while parsing. "check" is the number of packets whose records did not
+// reach the handler as expected, i.e. a parser which lost its state between
+// two chunks.
+#include <time.h>
+#include <new>
+
+#include <Usb.h>
+#include <ptpconst.h>
+#include <ptprecorder.h>
+#include <canoneos.h>
+#include <nikon.h>
+#include <eoseventparser.h>
+#include <eoseventdump.h>
+#include <nkeventparser.h>
+#include <ptpdpparser.h>
+
+#define BENCH_MAX_PACKETS		256
+#define BENCH_POOL_SIZE			(1024 * 1024)
+#define BENCH_MAX_PACKET_SIZE	65536
+
+// Allocation counting. operator new is replaced here, malloc and friends are
+// wrapped by the linker (-Wl,--wrap=malloc,...).
+
+static uint32_t		numAllocs = 0;
+
+extern "C"
+{
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void *p, size_t size);
+
+void* __wrap_malloc(size_t size) { numAllocs ++; return __real_malloc(size); }
+void* __wrap_calloc(size_t n, size_t size) { numAllocs ++; return __real_calloc(n, size); }
+void* __wrap_realloc(void *p, size_t size) { numAllocs ++; return __real_realloc(p, size); }
+}
+
+void* operator new(size_t size)
+{
+	numAllocs ++;
+
+	void	*p = __real_malloc(size);
+
+	if (!p)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+static uint64_t NowNs()
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Packets
+
+enum { kindEOS, kindNikon, kindDevProp16, kindDevProp32, kindCount };
+
+struct BenchPacket
+{
+	uint8_t		kind;
+	uint16_t	numRecords;			// records the handler is expected to see
+	uint32_t	len;
+	uint8_t		*data;
+};
+
+static uint8_t		thePool[BENCH_POOL_SIZE];
+static uint32_t		poolUsed = 0;
+static BenchPacket	thePackets[BENCH_MAX_PACKETS];
+static uint16_t		numPackets = 0;
+
+static uint16_t Get16(const uint8_t *p) { return (uint16_t)p[0] | ((uint16_t)p[1] << 8); }
+static uint32_t Get32(const uint8_t *p) { return (uint32_t)Get16(p) | ((uint32_t)Get16(p + 2) << 16); }
+
+class PacketBuilder
+{
+	uint8_t		*pBuf;
+	uint32_t	theSize;
+	uint32_t	theLen;
+
+public:
+	PacketBuilder(uint16_t code) : pBuf(thePool + poolUsed), theSize(BENCH_POOL_SIZE - poolUsed), theLen(0)
+	{
+		Put32(0);
+		Put16(PTP_USB_CONTAINER_DATA);
+		Put16(code);
+		Put32(1);
+	};
+	void Put8(uint8_t v) { if (theLen < theSize) pBuf[theLen++] = v; };
+	void Put16(uint16_t v) { Put8((uint8_t)v); Put8((uint8_t)(v >> 8)); };
+	void Put32(uint32_t v) { Put16((uint16_t)v); Put16((uint16_t)(v >> 16)); };
+
+	void Finish(uint8_t kind)
+	{
+		pBuf[0] = (uint8_t)theLen;
+		pBuf[1] = (uint8_t)(theLen >> 8);
+		pBuf[2] = (uint8_t)(theLen >> 16);
+		pBuf[3] = (uint8_t)(theLen >> 24);
+
+		if (numPackets >= BENCH_MAX_PACKETS)
+			return;
+
+		BenchPacket	*pkt = thePackets + numPackets++;
+
+		pkt->kind		= kind;
+		pkt->numRecords	= 0;
+		pkt->len		= theLen;
+		pkt->data		= pBuf;
+		poolUsed		+= theLen;
+	};
+};
+
+// Counts the records the parser is expected to report
+static uint16_t CountRecords(const BenchPacket *pkt)
+{
+	switch (pkt->kind)
+	{
+	case kindEOS:
+		{
+			uint16_t	n = 0;
+
+			for (uint32_t off = PTP_USB_BULK_HDR_LEN; off + 8 <= pkt->len; )
+			{
+				uint32_t	size = Get32(pkt->data + off);
+				uint32_t	code = Get32(pkt->data + off + 4);
+
+				if (!code || size < 8)
+					break;
+
+				if (code == EOS_EC_DevPropChanged || code == EOS_EC_DevPropValuesAccepted || code == EOS_EC_ObjectCreated)
+					n ++;
+
+				off += size;
+			}
+			return n;
+		}
+	case kindNikon:
+		return Get16(pkt->data + PTP_USB_BULK_HDR_LEN);
+	}
+	return 1;
+}
+
+static void SynthesizeEOS()
+{
+	PacketBuilder	pb(EOS_OC_GetEvent);
+
+	// what a camera reports right after SetRemoteMode
+	for (uint16_t i=0; i<40; i++)
+	{
+		pb.Put32(16);
+		pb.Put32(EOS_EC_DevPropChanged);
+		pb.Put32(0xD101 + i);
+		pb.Put32(i * 8);
+	}
+	for (uint16_t i=0; i<6; i++)
+	{
+		pb.Put32(20 + 4 * 32);
+		pb.Put32(EOS_EC_DevPropValuesAccepted);
+		pb.Put32(EOS_DPC_Aperture + i);
+		pb.Put32(3);
+		pb.Put32(32);
+
+		for (uint16_t j=0; j<32; j++)
+			pb.Put32(0x10 + j * 3);
+	}
+	for (uint16_t i=0; i<2; i++)
+	{
+		pb.Put32(0x5C);
+		pb.Put32(EOS_EC_ObjectCreated);
+		pb.Put32(0x90000000 + i);
+		pb.Put32(0x00020001);
+		pb.Put32((i) ? EOS_OFC_CR2 : PTP_OFC_EXIF_JPEG);
+
+		for (uint16_t j=5; j<0x5C/4; j++)
+			pb.Put32((j == 7) ? 0x00600000 : (j == 8) ? 0x90000000 : 0);
+	}
+	pb.Put32(8);
+	pb.Put32(0);
+	pb.Finish(kindEOS);
+
+	// nothing happened since the last poll
+	PacketBuilder	empty(EOS_OC_GetEvent);
+
+	empty.Put32(8);
+	empty.Put32(0);
+	empty.Finish(kindEOS);
+}
+
+static void SynthesizeNikon()
+{
+	PacketBuilder	pb(NK_OC_CheckEvent);
+
+	pb.Put16(24);
+
+	for (uint16_t i=0; i<24; i++)
+	{
+		pb.Put16((i & 7) ? PTP_EC_DevicePropChanged : NK_EC_ObjectAddedInSDRAM);
+		pb.Put32((i & 7) ? 0x5000 + i : 0xFFFF0001);
+	}
+	pb.Finish(kindNikon);
+
+	PacketBuilder	empty(NK_OC_CheckEvent);
+
+	empty.Put16(0);
+	empty.Finish(kindNikon);
+}
+
+static void SynthesizeDevProp()
+{
+	PacketBuilder	pb16(PTP_OC_GetDevicePropDesc);
+
+	pb16.Put16(NK_DPC_ExposureTime);
+	pb16.Put16(PTP_DTC_UINT16);
+	pb16.Put8(1);
+	pb16.Put16(0x0010);
+	pb16.Put16(0x0020);
+	pb16.Put8(2);
+	pb16.Put16(52);
+
+	for (uint16_t i=0; i<52; i++)
+		pb16.Put16(i * 3);
+
+	pb16.Finish(kindDevProp16);
+
+	PacketBuilder	pb32(PTP_OC_GetDevicePropDesc);
+
+	pb32.Put16(PTP_DPC_ExposureIndex);
+	pb32.Put16(PTP_DTC_UINT32);
+	pb32.Put8(1);
+	pb32.Put32(100);
+	pb32.Put32(400);
+	pb32.Put8(1);
+	pb32.Put32(100);
+	pb32.Put32(25600);
+	pb32.Put32(100);
+	pb32.Finish(kindDevProp32);
+}
+
+// Collects the data stages of interest from a PTPRecorder file
+static bool LoadRecording(const char *name)
+{
+	FILE	*f = fopen(name, "rb");
+
+	if (!f)
+		return false;
+
+	uint8_t		hdr[PTP_REC_HEADER_SIZE];
+	bool		ok = (fread(hdr, 1, PTP_REC_FILE_HEADER_SIZE, f) == PTP_REC_FILE_HEADER_SIZE && !memcmp(hdr, PTP_REC_SIGNATURE, 4));
+
+	static uint8_t	payload[BENCH_MAX_PACKET_SIZE];
+	uint8_t			*pkt = NULL;
+	uint32_t		total = 0;
+	uint32_t		got = 0;
+	uint8_t			kind = 0;
+
+	while (ok && fread(hdr, 1, PTP_REC_HEADER_SIZE, f) == PTP_REC_HEADER_SIZE)
+	{
+		PTPRecordHeader	rec;
+
+		rec.Unpack(hdr);
+
+		if (fread(payload, 1, rec.len, f) != rec.len)
+			break;
+
+		if ((rec.flags & PTP_REC_EP_MASK) != 1 || !(rec.flags & PTP_REC_FLAG_IN) || rec.rcode)
+			continue;
+
+		// the first packet of a data stage
+		if (!pkt && rec.len >= PTP_USB_BULK_HDR_LEN + 4 && Get16(payload + 4) == PTP_USB_CONTAINER_DATA)
+		{
+			uint16_t	code = Get16(payload + 6);
+
+			total = Get32(payload);
+
+			if (total > BENCH_MAX_PACKET_SIZE || poolUsed + total > BENCH_POOL_SIZE || numPackets >= BENCH_MAX_PACKETS)
+				continue;
+
+			if (code == EOS_OC_GetEvent)
+				kind = kindEOS;
+			else if (code == NK_OC_CheckEvent)
+				kind = kindNikon;
+			else if (code == PTP_OC_GetDevicePropDesc && Get16(payload + 14) == PTP_DTC_UINT16)
+				kind = kindDevProp16;
+			else if (code == PTP_OC_GetDevicePropDesc && Get16(payload + 14) == PTP_DTC_UINT32)
+				kind = kindDevProp32;
+			else
+				continue;
+
+			pkt	= thePool + poolUsed;
+			got	= 0;
+		}
+		if (!pkt)
+			continue;
+
+		uint32_t	n = (rec.len < total - got) ? rec.len : total - got;
+
+		memcpy(pkt + got, payload, n);
+		got += n;
+
+		if (got < total)
+			continue;
+
+		BenchPacket	*bp = thePackets + numPackets++;
+
+		bp->kind	= kind;
+		bp->len		= total;
+		bp->data	= pkt;
+		poolUsed	+= total;
+		pkt			= NULL;
+	}
+	fclose(f);
+	return ok;
+}
+
+// Handlers
+
+class EOSCounter : public EOSEventHandlers
+{
+public:
+	uint32_t	numRecords;
+
+	EOSCounter() : numRecords(0) {};
+
+	virtual void OnPropertyChanged(const EOSEvent *evt __attribute__ ((unused))) { numRecords ++; };
+	virtual void OnAcceptedListSize(const EOSEvent *evt __attribute__ ((unused)), const uint16_t size __attribute__ ((unused))) { numRecords ++; };
+	virtual void OnPropertyValuesAccepted(const EOSEvent *evt __attribute__ ((unused)), const uint16_t index __attribute__ ((unused)), const uint32_t &val __attribute__ ((unused))) {};
+	virtual void OnObjectCreated(const EOSEvent *evt __attribute__ ((unused)), uint8_t *buf __attribute__ ((unused))) { numRecords ++; };
+};
+
+class NKCounter : public NKEventHandlers
+{
+public:
+	uint32_t	numRecords;
+
+	NKCounter() : numRecords(0) {};
+
+	virtual void OnEvent(const NKEvent *evt __attribute__ ((unused))) { numRecords ++; };
+};
+
+// Parsers under test
+
+enum { prsEOS, prsEOSDump, prsNikon, prsDevProp16, prsDevProp32, prsCount };
+
+static const char	*parserNames[prsCount] = { "EOSEventParser", "EOSEventDump", "NKEventParser", "PTPDevPropParser<uint16_t>", "PTPDevPropParser<uint32_t>" };
+static const uint8_t	parserKinds[prsCount] = { kindEOS, kindEOS, kindNikon, kindDevProp16, kindDevProp32 };
+
+static EOSCounter		eosCounter;
+static EOSEventParser	eosParser(&eosCounter);
+static EOSEventDump		eosDump;
+static NKCounter		nkCounter;
+static NKEventParser	nkParser(&nkCounter);
+
+static PTPDevicePropValue<uint16_t>	dpValue16;
+static PTPDevPropParser<uint16_t>	dpParser16(&dpValue16);
+static PTPDevicePropValue<uint32_t>	dpValue32;
+static PTPDevPropParser<uint32_t>	dpParser32(&dpValue32);
+
+static PTPReadParser* Prepare(uint8_t prs)
+{
+	switch (prs)
+	{
+	case prsEOS:
+		eosParser.Reset();
+		return &eosParser;
+	case prsEOSDump:
+		return &eosDump;
+	case prsNikon:
+		nkParser.Reset();
+		return &nkParser;
+	case prsDevProp16:
+		dpValue16.valCurrent = 0xFFFF;
+		return &dpParser16;
+	}
+	dpValue32.valCurrent = 0xFFFFFFFF;
+	return &dpParser32;
+}
+
+static uint32_t Handled(uint8_t prs)
+{
+	if (prs == prsEOS)
+		return eosCounter.numRecords;
+
+	if (prs == prsNikon)
+		return nkCounter.numRecords;
+
+	return 0;
+}
+
+// Returns false if the records of the packet did not reach the handler
+static bool Check(uint8_t prs, const BenchPacket *pkt, uint32_t handled)
+{
+	switch (prs)
+	{
+	case prsEOS:
+	case prsNikon:
+		return (Handled(prs) - handled == pkt->numRecords);
+	// current value follows the container header, property code, data type, get/set flag and default value
+	case prsDevProp16:
+		return (dpValue16.valCurrent == Get16(pkt->data + PTP_USB_BULK_HDR_LEN + 7));
+	case prsDevProp32:
+		return (dpValue32.valCurrent == Get32(pkt->data + PTP_USB_BULK_HDR_LEN + 9));
+	}
+	return true;
+}
+
+struct BenchResult
+{
+	uint64_t	numBytes;
+	uint64_t	numRecords;
+	uint64_t	timeNs;
+	uint32_t	numAllocs;
+	uint32_t	numFailed;
+};
+
+static void Feed(PTPReadParser *parser, const BenchPacket *pkt, uint16_t chunk)
+{
+	uint32_t	off = 0;
+
+	while (off < pkt->len)
+	{
+		uint32_t	left	= pkt->len - off;
+		uint16_t	n		= (uint16_t)((chunk && left > chunk) ? chunk : (left > 0xFFFF) ? 0xFFFF : left);
+
+		parser->Parse(n, pkt->data + off, off);
+		off += n;
+	}
+}
+
+static void Run(uint8_t prs, uint16_t chunk, uint32_t time_ms, BenchResult *res)
+{
+	res->numBytes = res->numRecords = res->timeNs = 0;
+	res->numAllocs = res->numFailed = 0;
+
+	uint32_t	allocs	= numAllocs;
+	uint64_t	start	= NowNs();
+
+	// passes over the whole packet set until the time is up
+	do
+	{
+		for (uint16_t i=0; i<numPackets; i++)
+		{
+			const BenchPacket	*pkt = thePackets + i;
+
+			if (pkt->kind != parserKinds[prs])
+				continue;
+
+			uint32_t	handled = Handled(prs);
+
+			Feed(Prepare(prs), pkt, chunk);
+
+			if (!Check(prs, pkt, handled))
+				res->numFailed ++;
+
+			res->numBytes	+= pkt->len;
+			res->numRecords	+= pkt->numRecords;
+		}
+		res->timeNs = NowNs() - start;
+	} while (res->numBytes && res->timeNs < (uint64_t)time_ms * 1000000);
+
+	res->numAllocs = numAllocs - allocs;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t	time_ms = 200;
+
+	for (int i=1; i<argc; i++)
+	{
+		if (!strcmp(argv[i], "-t") && i + 1 < argc)
+			time_ms = atoi(argv[++i]);
+		else if (!LoadRecording(argv[i]))
+			fprintf(stderr, "%s: not a PTP recording\n", argv[i]);
+	}
+	bool	recorded = (numPackets != 0);
+
+	if (!recorded)
+	{
+		SynthesizeEOS();
+		SynthesizeNikon();
+		SynthesizeDevProp();
+	}
+	for (uint16_t i=0; i<numPackets; i++)
+		thePackets[i].numRecords = CountRecords(thePackets + i);
+
+	// EOSEventDump prints every byte it parses
+	Serial.SetOutput(NULL);
+
+	static const uint16_t	chunks[] = { 8, 64, 512, 0 };
+
+	printf("%-28s %6s %10s %14s %14s %7s %6s\n", "parser", "chunk", "packets", "bytes/s", "records/s", "allocs", "check");
+
+	for (uint8_t prs=0; prs<prsCount; prs++)
+	{
+		uint16_t	n = 0;
+
+		for (uint16_t i=0; i<numPackets; i++)
+			if (thePackets[i].kind == parserKinds[prs])
+				n ++;
+
+		if (!n)
+			continue;
+
+		for (uint8_t c=0; c<sizeof(chunks)/sizeof(chunks[0]); c++)
+		{
+			BenchResult	res;
+			char		chunk_name[8];
+
+			Run(prs, chunks[c], time_ms, &res);
+
+			if (chunks[c])
+				snprintf(chunk_name, sizeof(chunk_name), "%u", chunks[c]);
+			else
+				strcpy(chunk_name, "whole");
+
+			double	secs = res.timeNs / 1e9;
+
+			printf("%-28s %6s %10u %14.0f %14.0f %7u %6s\n", parserNames[prs], chunk_name, n,
+				res.numBytes / secs, res.numRecords / secs, res.numAllocs, (res.numFailed) ? "FAIL" : "ok");
+		}
+	}
+	printf("%u %s packets\n", numPackets, (recorded) ? "recorded" : "synthesized");
+	return 0;
+}
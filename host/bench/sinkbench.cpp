@@ -0,0 +1,138 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+// Write throughput of PTPBlockSink on the host.
+//
+// A synthetic object is fed to the sink in the 64 byte chunks of a full
+// speed bulk pipe, and written with each HostFileWriter mode. The baseline
+// writes every chunk as it comes, the way a plain sink would.
+//
+//	sinkbench [-s MB] [file]
+//
+// The file, by default sinkbench.out in the current directory, is removed
+// afterwards. O_DIRECT is not supported by tmpfs, that line fails there.
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <Usb.h>
+#include <ptpconst.h>
+#include <ptpblocksink.h>
+#include "../tools/hostfilewriter.h"
+
+#define BENCH_CHUNK_SIZE		64
+
+// Writes every chunk through write(2)
+class ChunkWriter : public PTPReadParser
+{
+	int		theFile;
+
+public:
+	ChunkWriter(int f) : theFile(f) {};
+
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+	{
+		uint16_t	skip = (offset) ? 0 : PTP_USB_BULK_HDR_LEN;
+
+		if (write(theFile, pbuf + skip, len - skip) != len - skip)
+			perror("write");
+	};
+};
+
+// Feeds an object of the given size as one GetObject data stage
+static void Transfer(PTPReadParser *sink, uint32_t size)
+{
+	uint8_t		chunk[BENCH_CHUNK_SIZE];
+	uint32_t	total = size + PTP_USB_BULK_HDR_LEN;
+
+	for (uint16_t i=0; i<BENCH_CHUNK_SIZE; i++)
+		chunk[i] = (uint8_t)i;
+
+	for (uint32_t offset=0; offset<total; offset+=BENCH_CHUNK_SIZE)
+	{
+		uint16_t	len = (total - offset < BENCH_CHUNK_SIZE) ? (uint16_t)(total - offset) : BENCH_CHUNK_SIZE;
+
+		sink->Parse(len, chunk, offset);
+	}
+}
+
+static void Report(const char *name, uint32_t size, uint32_t ms, uint32_t write_kbs)
+{
+	printf("%-10s %10u %8u %10.2f", name, size, ms, (ms) ? (double)size / 1048.576 / ms : 0.0);
+
+	if (write_kbs)
+		printf(" %10.2f", write_kbs / 1024.0);
+
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t		size = 64;
+	const char		*name = "sinkbench.out";
+
+	for (int i=1; i<argc; i++)
+	{
+		if (!strcmp(argv[i], "-s") && i + 1 < argc)
+			size = atoi(argv[++i]);
+		else
+			name = argv[i];
+	}
+	size *= 1048576;
+
+	printf("block %u, %u byte chunks\n", PTP_BLOCK_SIZE, BENCH_CHUNK_SIZE);
+	printf("%-10s %10s %8s %10s %10s\n", "writer", "bytes", "ms", "MB/s", "write MB/s");
+
+	int				f = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if (f < 0)
+	{
+		perror(name);
+		return 1;
+	}
+	ChunkWriter		chunk_writer(f);
+	uint32_t		t = millis();
+
+	Transfer(&chunk_writer, size);
+	close(f);
+	Report("chunks", size, millis() - t, 0);
+
+	static const char	*modeNames[] = { "buffered", "direct", "mapped" };
+	int					rc = 0;
+
+	for (uint8_t m=HostFileWriter::hwBuffered; m<=HostFileWriter::hwMapped; m++)
+	{
+		HostFileWriter	writer((HostFileWriter::Mode)m);
+		PTPBlockSink	sink(&writer);
+
+		if (!writer.Open(name) || !sink.Start(size))
+		{
+			printf("%-10s failed\n", modeNames[m]);
+			rc = 1;
+			continue;
+		}
+		Transfer(&sink, size);
+
+		if (!sink.Finish() || sink.GetSize() != size)
+		{
+			printf("%-10s failed\n", modeNames[m]);
+			rc = 1;
+			continue;
+		}
+		Report(modeNames[m], size, sink.GetStats()->timeEnd - sink.GetStats()->timeStart, sink.GetWriteRate());
+	}
+	unlink(name);
+	return rc;
+}
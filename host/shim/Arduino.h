@@ -0,0 +1,104 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+// Host replacement of the Arduino core: time functions and Serial
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+
+#define DEC		10
+#define HEX		16
+#define OCT		8
+#define BIN		2
+
+typedef bool		boolean;
+typedef uint8_t		byte;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// Time source of millis(), micros() and delay(). Micros() is 64 bit, so
+// that millis() wraps around after 49 days as on the Arduino.
+class HostClock
+{
+public:
+	virtual uint64_t Micros() = 0;
+	virtual void Delay(uint32_t us) = 0;
+};
+
+// Simulated time, delays advance it without sleeping. Makes replays and
+// profiling runs independent of the delays in the library.
+class ManualClock : public HostClock
+{
+	uint64_t	timeNow;
+
+public:
+	ManualClock(uint64_t t = 0) : timeNow(t) {};
+
+	void Set(uint64_t us) { timeNow = us; };
+	void Advance(uint32_t us) { timeNow += us; };
+
+	virtual uint64_t Micros() { return timeNow; };
+	virtual void Delay(uint32_t us) { timeNow += us; };
+};
+
+// Replaces the system monotonic clock, NULL restores it
+void SetHostClock(HostClock *clock);
+
+// Serial port printing to stdout
+class HostSerial
+{
+	FILE		*pOut;
+
+	void PrintNumber(unsigned long val, uint8_t base);
+
+public:
+	HostSerial() : pOut(stdout) {};
+
+	// NULL discards the output
+	void SetOutput(FILE *out) { pOut = out; };
+
+	void begin(unsigned long baud __attribute__ ((unused))) {};
+	int available() { return 0; };
+	int read() { return -1; };
+
+	size_t write(uint8_t c);
+	size_t write(const uint8_t *buf, size_t len);
+
+	void print(const char *s);
+	void print(char c) { write((uint8_t)c); };
+	void print(unsigned char val, int base = DEC) { PrintNumber(val, base); };
+	void print(int val, int base = DEC);
+	void print(unsigned int val, int base = DEC) { PrintNumber(val, base); };
+	void print(long val, int base = DEC);
+	void print(unsigned long val, int base = DEC) { PrintNumber(val, base); };
+
+	void println() { print("\r\n"); };
+	template <class T> void println(T val) { print(val); println(); };
+	template <class T> void println(T val, int base) { print(val, base); println(); };
+};
+
+extern HostSerial	Serial;
+
+#endif // Arduino_h
@@ -0,0 +1,357 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+// Host replacement of the USB Host Shield 2.0 library header. Provides the
+// parts of its API used by the PTP library: the USB class, address pool,
+// descriptors, return codes, the byte stream parsing tools and the message
+// printing functions.
+#ifndef _usb_h_
+#define _usb_h_
+
+#include <Arduino.h>
+
+// MAX3421E host result codes
+#define hrSUCCESS		0x00
+#define hrBUSY			0x01
+#define hrBADREQ		0x02
+#define hrUNDEF			0x03
+#define hrNAK			0x04
+#define hrSTALL			0x05
+#define hrTOGERR		0x06
+#define hrWRONGPID		0x07
+#define hrBADBC			0x08
+#define hrPIDERR		0x09
+#define hrPKTERR		0x0A
+#define hrCRCERR		0x0B
+#define hrKERR			0x0C
+#define hrJERR			0x0D
+#define hrTIMEOUT		0x0E
+#define hrBABBLE		0x0F
+
+// USB core error codes
+#define USB_DEV_CONFIG_ERROR_DEVICE_NOT_SUPPORTED		0xD1
+#define USB_DEV_CONFIG_ERROR_DEVICE_INIT_INCOMPLETE		0xD2
+#define USB_ERROR_UNABLE_TO_REGISTER_DEVICE_CLASS		0xD3
+#define USB_ERROR_OUT_OF_ADDRESS_SPACE_IN_POOL			0xD4
+#define USB_ERROR_HUB_ADDRESS_OVERFLOW					0xD5
+#define USB_ERROR_ADDRESS_NOT_FOUND_IN_POOL				0xD6
+#define USB_ERROR_EPINFO_IS_NULL						0xD7
+#define USB_ERROR_INVALID_ARGUMENT						0xD8
+#define USB_ERROR_CLASS_INSTANCE_ALREADY_IN_USE			0xD9
+#define USB_ERROR_INVALID_MAX_PKT_SIZE					0xDA
+#define USB_ERROR_EP_NOT_FOUND_IN_TBL					0xDB
+#define USB_ERROR_TRANSFER_TIMEOUT						0xFF
+
+#define USB_NAK_MAX_POWER		15
+#define USB_CLASS_IMAGE			0x06
+
+#define USB_NUMDEVICES			16
+#define USB_NUMCLASSES			4
+
+// Descriptors
+struct USB_DEVICE_DESCRIPTOR
+{
+	uint8_t		bLength;
+	uint8_t		bDescriptorType;
+	uint16_t	bcdUSB;
+	uint8_t		bDeviceClass;
+	uint8_t		bDeviceSubClass;
+	uint8_t		bDeviceProtocol;
+	uint8_t		bMaxPacketSize0;
+	uint16_t	idVendor;
+	uint16_t	idProduct;
+	uint16_t	bcdDevice;
+	uint8_t		iManufacturer;
+	uint8_t		iProduct;
+	uint8_t		iSerialNumber;
+	uint8_t		bNumConfigurations;
+} __attribute__((packed));
+
+struct USB_CONFIGURATION_DESCRIPTOR
+{
+	uint8_t		bLength;
+	uint8_t		bDescriptorType;
+	uint16_t	wTotalLength;
+	uint8_t		bNumInterfaces;
+	uint8_t		bConfigurationValue;
+	uint8_t		iConfiguration;
+	uint8_t		bmAttributes;
+	uint8_t		bMaxPower;
+} __attribute__((packed));
+
+struct USB_INTERFACE_DESCRIPTOR
+{
+	uint8_t		bLength;
+	uint8_t		bDescriptorType;
+	uint8_t		bInterfaceNumber;
+	uint8_t		bAlternateSetting;
+	uint8_t		bNumEndpoints;
+	uint8_t		bInterfaceClass;
+	uint8_t		bInterfaceSubClass;
+	uint8_t		bInterfaceProtocol;
+	uint8_t		iInterface;
+} __attribute__((packed));
+
+struct USB_ENDPOINT_DESCRIPTOR
+{
+	uint8_t		bLength;
+	uint8_t		bDescriptorType;
+	uint8_t		bEndpointAddress;
+	uint8_t		bmAttributes;
+	uint16_t	wMaxPacketSize;
+	uint8_t		bInterval;
+} __attribute__((packed));
+
+// Address pool
+struct EpInfo
+{
+	uint8_t		epAddr;
+	uint8_t		maxPktSize;
+
+	union
+	{
+		uint8_t		epAttribs;
+
+		struct
+		{
+			uint8_t	bmSndToggle	:	1;
+			uint8_t	bmRcvToggle	:	1;
+			uint8_t	bmNakPower	:	6;
+		} __attribute__((packed));
+	} __attribute__((packed));
+} __attribute__((packed));
+
+struct UsbDevice
+{
+	EpInfo		*epinfo;
+	uint8_t		address;
+	uint8_t		epcount;
+	bool		lowspeed;
+};
+
+class AddressPool
+{
+public:
+	virtual UsbDevice* GetUsbDevicePtr(uint8_t addr) = 0;
+	virtual uint8_t AllocAddress(uint8_t parent, bool is_hub = false, uint8_t port = 0) = 0;
+	virtual void FreeAddress(uint8_t addr) = 0;
+};
+
+// Flat address pool, no hubs
+class HostAddressPool : public AddressPool
+{
+	EpInfo		dev0ep;
+	UsbDevice	thePool[USB_NUMDEVICES];
+
+public:
+	HostAddressPool();
+
+	virtual UsbDevice* GetUsbDevicePtr(uint8_t addr);
+	virtual uint8_t AllocAddress(uint8_t parent, bool is_hub = false, uint8_t port = 0);
+	virtual void FreeAddress(uint8_t addr);
+};
+
+class USBDeviceConfig
+{
+public:
+	virtual uint8_t Init(uint8_t parent __attribute__ ((unused)), uint8_t port __attribute__ ((unused)), bool lowspeed __attribute__ ((unused))) { return 0; };
+	virtual uint8_t Release() { return 0; };
+	virtual uint8_t Poll() { return 0; };
+	virtual uint8_t GetAddress() { return 0; };
+};
+
+// Standard requests used by the device classes
+#define bmREQ_GET_DESCR					0x80
+#define bmREQ_SET						0x00
+#define USB_REQUEST_SET_ADDRESS			5
+#define USB_REQUEST_GET_DESCRIPTOR		6
+#define USB_REQUEST_SET_CONFIGURATION	9
+#define USB_DESCRIPTOR_DEVICE			0x01
+#define USB_DESCRIPTOR_CONFIGURATION	0x02
+
+// Device side of the host USB class, i.e. a libusb device handle or a
+// simulated camera. Endpoints are given by their numbers, without the
+// direction bit.
+class HostUsbBackend
+{
+public:
+	virtual uint8_t ControlRequest(uint8_t addr, uint8_t bmReqType, uint8_t bRequest, uint16_t wValue, uint16_t wIndex, uint16_t nbytes, uint8_t *data) = 0;
+	virtual uint8_t InTransfer(uint8_t addr, uint8_t ep, uint16_t *nbytesptr, uint8_t *data) = 0;
+	virtual uint8_t OutTransfer(uint8_t addr, uint8_t ep, uint16_t nbytes, uint8_t *data) = 0;
+};
+
+// Host controller. Without a backend attached every transfer fails with
+// hrTIMEOUT, as if no device were connected. With one, Task() offers the
+// device to the registered classes until one of them accepts it, then
+// polls them, as the USB Host Shield library does.
+class USB
+{
+	HostAddressPool		addrPool;
+	USBDeviceConfig		*devConfig[USB_NUMCLASSES];
+	HostUsbBackend		*pBackend;
+	bool				bConfigured;
+
+public:
+	USB();
+
+	int8_t Init() { return 0; };
+	void Task();
+
+	// NULL detaches the device and releases the class which has been using it
+	void SetBackend(HostUsbBackend *backend);
+
+	AddressPool& GetAddressPool() { return addrPool; };
+	uint8_t RegisterDeviceClass(USBDeviceConfig *pdev);
+
+	uint8_t setEpInfoEntry(uint8_t addr, uint8_t epcount, EpInfo *eprecord_ptr);
+
+	uint8_t getDevDescr(uint8_t addr, uint8_t ep, uint16_t nbytes, uint8_t *dataptr);
+	uint8_t getConfDescr(uint8_t addr, uint8_t ep, uint16_t nbytes, uint8_t conf, uint8_t *dataptr);
+	uint8_t setAddr(uint8_t oldaddr, uint8_t ep, uint8_t newaddr);
+	uint8_t setConf(uint8_t addr, uint8_t ep, uint8_t conf_value);
+
+	uint8_t inTransfer(uint8_t addr, uint8_t ep, uint16_t *nbytesptr, uint8_t *data, uint8_t bInterval = 0);
+	uint8_t outTransfer(uint8_t addr, uint8_t ep, uint16_t nbytes, uint8_t *data);
+};
+
+// Byte stream parsing tools
+struct MultiValueBuffer
+{
+	uint8_t		valueSize;
+	void		*pValue;
+} __attribute__((packed));
+
+class MultiByteValueParser
+{
+	uint8_t		*pBuf;
+	uint8_t		countDown;
+	uint8_t		valueSize;
+
+public:
+	MultiByteValueParser() : pBuf(NULL), countDown(0), valueSize(0) {};
+
+	uint8_t* GetBuffer() { return pBuf; };
+
+	void Initialize(MultiValueBuffer * const pbuf)
+	{
+		pBuf		= (uint8_t*)pbuf->pValue;
+		countDown	= valueSize = pbuf->valueSize;
+	};
+	bool Parse(uint8_t **pp, uint16_t *pcntdn);
+};
+
+class ByteSkipper
+{
+	uint8_t		*pBuf;
+	uint8_t		nStage;
+	uint16_t	countDown;
+
+public:
+	ByteSkipper() : pBuf(NULL), nStage(0), countDown(0) {};
+
+	void Initialize(MultiValueBuffer *pbuf) { pBuf = (uint8_t*)pbuf->pValue; countDown = 0; };
+	bool Skip(uint8_t **pp, uint16_t *pcntdn, uint16_t bytes_to_skip);
+};
+
+typedef void (*PTP_ARRAY_EL_FUNC)(const MultiValueBuffer * const p, uint32_t count, const void *me);
+
+class PTPListParser
+{
+public:
+	enum ParseMode { modeArray, modeRange };
+
+private:
+	uint8_t					nStage;
+	uint8_t					enStage;
+	uint32_t				arLen;
+	uint32_t				arLenCntdn;
+	uint8_t					lenSize;
+	uint8_t					valSize;
+	MultiValueBuffer		*pBuf;
+	MultiByteValueParser	theParser;
+	uint8_t					prsMode;
+
+public:
+	PTPListParser() : nStage(0), enStage(0), arLen(0), arLenCntdn(0), lenSize(0), valSize(0), pBuf(NULL), prsMode(modeArray) {};
+
+	void Initialize(const uint8_t len_size, const uint8_t val_size, MultiValueBuffer * const p, const uint8_t mode = modeArray);
+	bool Parse(uint8_t **pp, uint16_t *pcntdn, PTP_ARRAY_EL_FUNC pf, const void *me = NULL);
+};
+
+// Messages
+void E_Notify(char const *msg, int lvl);
+void E_Notify(uint8_t b, int lvl);
+void E_NotifyStr(char const *msg, int lvl);
+void E_Notifyc(char c, int lvl);
+
+template <class T>
+void PrintHex(T val, int lvl __attribute__ ((unused)))
+{
+	for (int8_t i = sizeof(T) * 2 - 1; i >= 0; i--)
+		Serial.print("0123456789ABCDEF"[(val >> (i * 4)) & 0x0F]);
+}
+
+template <class T>
+void PrintBin(T val, int lvl __attribute__ ((unused)))
+{
+	for (int8_t i = sizeof(T) * 8 - 1; i >= 0; i--)
+		Serial.print((char)(((val >> i) & 1) ? '1' : '0'));
+}
+
+template <class ERROR_TYPE>
+void ErrorMessage(char const *msg, ERROR_TYPE rcode = 0)
+{
+	E_Notify(msg, 0x80);
+	E_Notify(PSTR(": "), 0x80);
+	PrintHex<ERROR_TYPE>(rcode, 0x80);
+	E_Notify(PSTR("\r\n"), 0x80);
+}
+
+template <class BASE_CLASS, class LEN_TYPE, class OFFSET_TYPE>
+class HexDumper : public BASE_CLASS
+{
+	uint8_t		byteCount;
+	OFFSET_TYPE	byteTotal;
+
+public:
+	HexDumper() : byteCount(0), byteTotal(0) {};
+
+	void Initialize() { byteCount = 0; byteTotal = 0; };
+	void Parse(const LEN_TYPE len, const uint8_t *pbuf, const OFFSET_TYPE &offset);
+};
+
+template <class BASE_CLASS, class LEN_TYPE, class OFFSET_TYPE>
+void HexDumper<BASE_CLASS, LEN_TYPE, OFFSET_TYPE>::Parse(const LEN_TYPE len, const uint8_t *pbuf, const OFFSET_TYPE &offset __attribute__ ((unused)))
+{
+	for (LEN_TYPE j=0; j<len; j++, byteCount++, byteTotal++)
+	{
+		if (!byteCount)
+		{
+			PrintHex<OFFSET_TYPE>(byteTotal, 0x80);
+			E_Notify(PSTR(": "), 0x80);
+		}
+		PrintHex<uint8_t>(pbuf[j], 0x80);
+		E_Notify(PSTR(" "), 0x80);
+
+		if (byteCount == 15)
+		{
+			E_Notify(PSTR("\r\n"), 0x80);
+			byteCount = 0xFF;
+		}
+	}
+}
+
+#endif // _usb_h_
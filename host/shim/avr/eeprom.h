@@ -0,0 +1,30 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+// Host replacement of avr/eeprom.h backed by a RAM array
+#ifndef _AVR_EEPROM_H_
+#define _AVR_EEPROM_H_
+
+#include <stdint.h>
+
+#define E2END		0x0FFF
+
+extern uint8_t		hostEEPROM[E2END + 1];
+
+inline uint8_t eeprom_read_byte(const uint8_t *addr) { return hostEEPROM[(uintptr_t)addr & E2END]; }
+inline void eeprom_write_byte(uint8_t *addr, uint8_t val) { hostEEPROM[(uintptr_t)addr & E2END] = val; }
+
+#endif // _AVR_EEPROM_H_
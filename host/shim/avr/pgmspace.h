@@ -0,0 +1,42 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+// Host replacement of avr/pgmspace.h. There is only one address space, so
+// program memory access is plain memory access.
+#ifndef __PGMSPACE_H_
+#define __PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)					(s)
+#define PGM_P					const char*
+
+typedef char					prog_char;
+
+#define pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)	(*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr)		(*(void* const*)(addr))
+
+#define strcpy_P				strcpy
+#define strncpy_P				strncpy
+#define strlen_P				strlen
+#define strcmp_P				strcmp
+#define memcpy_P				memcpy
+
+#endif // __PGMSPACE_H_
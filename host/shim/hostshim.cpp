@@ -0,0 +1,414 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include <time.h>
+#include <Usb.h>
+#include <avr/eeprom.h>
+
+HostSerial	Serial;
+uint8_t		hostEEPROM[E2END + 1];
+
+// Time
+
+static uint64_t MonotonicMicros()
+{
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint64_t	timeBase = MonotonicMicros();
+
+class SystemClock : public HostClock
+{
+public:
+	virtual uint64_t Micros() { return MonotonicMicros() - timeBase; };
+
+	virtual void Delay(uint32_t us)
+	{
+		struct timespec	ts = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000 };
+
+		nanosleep(&ts, NULL);
+	};
+};
+
+static SystemClock	systemClock;
+static HostClock	*pClock = &systemClock;
+
+void SetHostClock(HostClock *clock)
+{
+	pClock = (clock) ? clock : &systemClock;
+}
+
+uint32_t micros()
+{
+	return (uint32_t)pClock->Micros();
+}
+
+uint32_t millis()
+{
+	return (uint32_t)(pClock->Micros() / 1000);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+	pClock->Delay(us);
+}
+
+void delay(uint32_t ms)
+{
+	pClock->Delay(ms * 1000);
+}
+
+// Serial
+
+size_t HostSerial::write(uint8_t c)
+{
+	if (pOut)
+		fputc(c, pOut);
+
+	return 1;
+}
+
+size_t HostSerial::write(const uint8_t *buf, size_t len)
+{
+	if (pOut)
+		fwrite(buf, 1, len, pOut);
+
+	return len;
+}
+
+void HostSerial::print(const char *s)
+{
+	if (pOut)
+		fputs(s, pOut);
+}
+
+void HostSerial::PrintNumber(unsigned long val, uint8_t base)
+{
+	char	buf[8 * sizeof(long) + 1];
+	char	*p = buf + sizeof(buf) - 1;
+
+	if (base < 2)
+		base = 10;
+
+	*p = 0;
+
+	do
+	{
+		uint8_t	digit = val % base;
+
+		*--p = (digit < 10) ? '0' + digit : 'A' + digit - 10;
+		val /= base;
+	} while (val);
+
+	print(p);
+}
+
+void HostSerial::print(int val, int base)
+{
+	print((long)val, base);
+}
+
+void HostSerial::print(long val, int base)
+{
+	if (base == DEC && val < 0)
+	{
+		write('-');
+		PrintNumber(-(unsigned long)val, DEC);
+	}
+	else
+		PrintNumber((unsigned long)val, base);
+}
+
+// Messages
+
+void E_Notify(char const *msg, int lvl __attribute__ ((unused)))
+{
+	Serial.print(msg);
+}
+
+void E_Notify(uint8_t b, int lvl __attribute__ ((unused)))
+{
+	Serial.print(b, DEC);
+}
+
+void E_NotifyStr(char const *msg, int lvl __attribute__ ((unused)))
+{
+	Serial.print(msg);
+}
+
+void E_Notifyc(char c, int lvl __attribute__ ((unused)))
+{
+	Serial.print(c);
+}
+
+// Parsing tools
+
+bool MultiByteValueParser::Parse(uint8_t **pp, uint16_t *pcntdn)
+{
+	if (!pBuf)
+		return false;
+
+	for (; countDown && (*pcntdn); countDown--, (*pcntdn)--, (*pp)++)
+		pBuf[valueSize - countDown] = (**pp);
+
+	if (countDown)
+		return false;
+
+	countDown = valueSize;
+	return true;
+}
+
+bool ByteSkipper::Skip(uint8_t **pp, uint16_t *pcntdn, uint16_t bytes_to_skip)
+{
+	switch (nStage)
+	{
+	case 0:
+		countDown = bytes_to_skip;
+		nStage ++;
+	case 1:
+		for (; countDown && (*pcntdn); countDown--, (*pp)++, (*pcntdn)--);
+
+		if (!countDown)
+			nStage = 0;
+	}
+	return (!countDown);
+}
+
+void PTPListParser::Initialize(const uint8_t len_size, const uint8_t val_size, MultiValueBuffer * const p, const uint8_t mode)
+{
+	pBuf	= p;
+	lenSize	= len_size;
+	valSize	= val_size;
+	prsMode	= mode;
+
+	if (prsMode == modeRange)
+	{
+		arLenCntdn = arLen = 3;
+		nStage = 2;
+	}
+	else
+	{
+		arLenCntdn = arLen = 0;
+		nStage = 0;
+	}
+	enStage = 0;
+	theParser.Initialize(p);
+}
+
+bool PTPListParser::Parse(uint8_t **pp, uint16_t *pcntdn, PTP_ARRAY_EL_FUNC pf, const void *me)
+{
+	switch (nStage)
+	{
+	case 0:
+		pBuf->valueSize = lenSize;
+		theParser.Initialize(pBuf);
+		nStage = 1;
+	case 1:
+		if (!theParser.Parse(pp, pcntdn))
+			return false;
+
+		arLen = (pBuf->valueSize >= 4) ? *((uint32_t*)pBuf->pValue) : (uint32_t)(*((uint16_t*)pBuf->pValue));
+		arLenCntdn = arLen;
+		nStage = 2;
+	case 2:
+		pBuf->valueSize = valSize;
+		theParser.Initialize(pBuf);
+		nStage = 3;
+	case 3:
+		for (; arLenCntdn; arLenCntdn--)
+		{
+			if (!theParser.Parse(pp, pcntdn))
+				return false;
+
+			if (pf)
+				pf(pBuf, (arLen - arLenCntdn), me);
+		}
+		nStage = 0;
+	}
+	return true;
+}
+
+// Address pool
+
+HostAddressPool::HostAddressPool()
+{
+	dev0ep.epAddr		= 0;
+	dev0ep.maxPktSize	= 8;
+	dev0ep.epAttribs	= 0;
+	dev0ep.bmNakPower	= USB_NAK_MAX_POWER;
+
+	for (uint8_t i=0; i<USB_NUMDEVICES; i++)
+	{
+		thePool[i].epinfo	= NULL;
+		thePool[i].address	= 0;
+		thePool[i].epcount	= 0;
+		thePool[i].lowspeed	= false;
+	}
+	thePool[0].epinfo = &dev0ep;
+}
+
+UsbDevice* HostAddressPool::GetUsbDevicePtr(uint8_t addr)
+{
+	if (!addr)
+		return thePool;
+
+	for (uint8_t i=1; i<USB_NUMDEVICES; i++)
+		if (thePool[i].address == addr)
+			return thePool + i;
+
+	return NULL;
+}
+
+uint8_t HostAddressPool::AllocAddress(uint8_t parent __attribute__ ((unused)), bool is_hub __attribute__ ((unused)), uint8_t port __attribute__ ((unused)))
+{
+	for (uint8_t i=1; i<USB_NUMDEVICES; i++)
+		if (!thePool[i].address)
+		{
+			thePool[i].address	= i;
+			thePool[i].epinfo	= &dev0ep;
+			thePool[i].epcount	= 1;
+			return i;
+		}
+
+	return 0;
+}
+
+void HostAddressPool::FreeAddress(uint8_t addr)
+{
+	UsbDevice	*p = (addr) ? GetUsbDevicePtr(addr) : NULL;
+
+	if (!p)
+		return;
+
+	p->address	= 0;
+	p->epinfo	= NULL;
+	p->epcount	= 0;
+}
+
+// USB
+
+USB::USB() : pBackend(NULL), bConfigured(false)
+{
+	for (uint8_t i=0; i<USB_NUMCLASSES; i++)
+		devConfig[i] = NULL;
+}
+
+uint8_t USB::RegisterDeviceClass(USBDeviceConfig *pdev)
+{
+	for (uint8_t i=0; i<USB_NUMCLASSES; i++)
+		if (!devConfig[i])
+		{
+			devConfig[i] = pdev;
+			return 0;
+		}
+
+	return USB_ERROR_UNABLE_TO_REGISTER_DEVICE_CLASS;
+}
+
+void USB::SetBackend(HostUsbBackend *backend)
+{
+	if (bConfigured)
+		for (uint8_t i=0; i<USB_NUMCLASSES; i++)
+			if (devConfig[i] && devConfig[i]->GetAddress())
+				devConfig[i]->Release();
+
+	pBackend	= backend;
+	bConfigured	= false;
+}
+
+void USB::Task()
+{
+	if (pBackend && !bConfigured)
+	{
+		for (uint8_t i=0; !bConfigured && i<USB_NUMCLASSES; i++)
+			if (devConfig[i])
+				bConfigured = (devConfig[i]->Init(0, 1, false) == 0);
+
+		if (!bConfigured)
+			return;
+	}
+	for (uint8_t i=0; i<USB_NUMCLASSES; i++)
+		if (devConfig[i])
+			devConfig[i]->Poll();
+}
+
+uint8_t USB::setEpInfoEntry(uint8_t addr, uint8_t epcount, EpInfo *eprecord_ptr)
+{
+	UsbDevice	*p = addrPool.GetUsbDevicePtr(addr);
+
+	if (!p)
+		return USB_ERROR_ADDRESS_NOT_FOUND_IN_POOL;
+
+	if (!eprecord_ptr)
+		return USB_ERROR_INVALID_ARGUMENT;
+
+	p->epinfo	= eprecord_ptr;
+	p->epcount	= epcount;
+	return 0;
+}
+
+uint8_t USB::getDevDescr(uint8_t addr, uint8_t ep __attribute__ ((unused)), uint16_t nbytes, uint8_t *dataptr)
+{
+	if (!pBackend)
+		return hrTIMEOUT;
+
+	return pBackend->ControlRequest(addr, bmREQ_GET_DESCR, USB_REQUEST_GET_DESCRIPTOR, USB_DESCRIPTOR_DEVICE << 8, 0, nbytes, dataptr);
+}
+
+uint8_t USB::getConfDescr(uint8_t addr, uint8_t ep __attribute__ ((unused)), uint16_t nbytes, uint8_t conf, uint8_t *dataptr)
+{
+	if (!pBackend)
+		return hrTIMEOUT;
+
+	return pBackend->ControlRequest(addr, bmREQ_GET_DESCR, USB_REQUEST_GET_DESCRIPTOR, (USB_DESCRIPTOR_CONFIGURATION << 8) | conf, 0, nbytes, dataptr);
+}
+
+uint8_t USB::setAddr(uint8_t oldaddr, uint8_t ep __attribute__ ((unused)), uint8_t newaddr)
+{
+	if (!pBackend)
+		return hrTIMEOUT;
+
+	return pBackend->ControlRequest(oldaddr, bmREQ_SET, USB_REQUEST_SET_ADDRESS, newaddr, 0, 0, NULL);
+}
+
+uint8_t USB::setConf(uint8_t addr, uint8_t ep __attribute__ ((unused)), uint8_t conf_value)
+{
+	if (!pBackend)
+		return hrTIMEOUT;
+
+	return pBackend->ControlRequest(addr, bmREQ_SET, USB_REQUEST_SET_CONFIGURATION, conf_value, 0, 0, NULL);
+}
+
+uint8_t USB::inTransfer(uint8_t addr, uint8_t ep, uint16_t *nbytesptr, uint8_t *data, uint8_t bInterval __attribute__ ((unused)))
+{
+	if (!pBackend)
+	{
+		*nbytesptr = 0;
+		return hrTIMEOUT;
+	}
+	return pBackend->InTransfer(addr, ep, nbytesptr, data);
+}
+
+uint8_t USB::outTransfer(uint8_t addr, uint8_t ep, uint16_t nbytes, uint8_t *data)
+{
+	if (!pBackend)
+		return hrTIMEOUT;
+
+	return pBackend->OutTransfer(addr, ep, nbytes, data);
+}
@@ -0,0 +1,115 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE					// O_DIRECT
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "hostfilewriter.h"
+
+bool HostFileWriter::Open(const char *name)
+{
+	int		flags = O_RDWR | O_CREAT | O_TRUNC;
+
+	if (theMode == hwDirect)
+		flags |= O_DIRECT;
+
+	theFile	= open(name, flags, 0644);
+	filePos	= 0;
+
+	if (theFile < 0)
+		perror(name);
+
+	return (theFile >= 0);
+}
+
+bool HostFileWriter::Reserve(uint32_t size)
+{
+	if (theFile < 0)
+		return false;
+
+	// whole blocks, O_DIRECT writes the last one in full
+	uint32_t	alloc = (size + PTP_BLOCK_SIZE - 1) / PTP_BLOCK_SIZE * PTP_BLOCK_SIZE;
+
+	if (theMode == hwMapped)
+	{
+		if (ftruncate(theFile, size))
+			return false;
+
+		void	*p = mmap(NULL, size, PROT_WRITE, MAP_SHARED, theFile, 0);
+
+		if (p == MAP_FAILED)
+			return false;
+
+		pMap	= (uint8_t*)p;
+		mapSize	= size;
+		return true;
+	}
+	// file systems without fallocate support report an error, the writing works regardless
+	posix_fallocate(theFile, 0, alloc);
+	return true;
+}
+
+bool HostFileWriter::Write(const uint8_t *pbuf, uint16_t len)
+{
+	if (theFile < 0)
+		return false;
+
+	if (pMap)
+	{
+		if (filePos + len > mapSize)
+			return false;
+
+		memcpy(pMap + filePos, pbuf, len);
+		filePos += len;
+		return true;
+	}
+	// the buffer always holds a whole block, the bytes past len are cut off by Close()
+	uint16_t	n = (theMode == hwDirect) ? PTP_BLOCK_SIZE : len;
+
+	if (pwrite(theFile, pbuf, n, filePos) != n)
+		return false;
+
+	filePos += len;
+	return true;
+}
+
+bool HostFileWriter::Close(uint32_t size)
+{
+	bool	ok = true;
+
+	if (theFile < 0)
+		return false;
+
+	if (pMap)
+	{
+		ok = (munmap(pMap, mapSize) == 0);
+		pMap = NULL;
+	}
+	// preallocated or padded space
+	if (ftruncate(theFile, size))
+		ok = false;
+
+	if (close(theFile))
+		ok = false;
+
+	theFile = -1;
+	return ok;
+}
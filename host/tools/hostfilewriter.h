@@ -0,0 +1,54 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+// File writer for PTPBlockSink on the host.
+//
+//	hwBuffered	write(2) through the page cache
+//	hwDirect	O_DIRECT, bypasses the page cache. Needs PTP_BLOCK_SIZE and
+//				PTP_BLOCK_ALIGN to be multiples of the device block size,
+//				the last block is written whole and the file cut afterwards.
+//	hwMapped	the file is sized on Reserve() and mapped, blocks are copied
+//				into the mapping. Falls back to write(2) if the size is unknown.
+#ifndef __HOSTFILEWRITER_H__
+#define __HOSTFILEWRITER_H__
+
+#include <ptpblocksink.h>
+
+class HostFileWriter : public PTPBlockWriter
+{
+public:
+	enum Mode { hwBuffered, hwDirect, hwMapped };
+
+private:
+	Mode		theMode;
+	int			theFile;
+	uint8_t		*pMap;
+	uint32_t	mapSize;
+	uint32_t	filePos;
+
+public:
+	HostFileWriter(Mode mode = hwBuffered) : theMode(mode), theFile(-1), pMap(NULL), mapSize(0), filePos(0) {};
+	~HostFileWriter() { Close(filePos); };
+
+	bool Open(const char *name);
+
+	// PTPBlockWriter implementation
+	virtual bool Reserve(uint32_t size);
+	virtual bool Write(const uint8_t *pbuf, uint16_t len);
+	virtual bool Close(uint32_t size);
+};
+
+#endif // __HOSTFILEWRITER_H__
@@ -0,0 +1,78 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+// Plays a recording made by the PTPRecord sketch back on the host, the same
+// way the PTPReplay sketch does on the Arduino.
+//
+//	ptpreplay <recording>
+#include <Usb.h>
+#include <ptp.h>
+#include <ptpreplay.h>
+
+class FileReader : public PTPRecordReader
+{
+	FILE	*pFile;
+
+public:
+	FileReader(FILE *f) : pFile(f) {};
+
+	virtual uint16_t Read(const uint16_t len, uint8_t *pbuf) { return (uint16_t)fread(pbuf, 1, len, pFile); };
+};
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <recording>\n", argv[0]);
+		return 2;
+	}
+	FILE	*f = fopen(argv[1], "rb");
+
+	if (!f)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+	// no real waiting, the delays of the library only advance the clock
+	ManualClock		clock;
+	USB				usb;
+	PTP				ptp(&usb, NULL);
+	FileReader		reader(f);
+	PTPReplay		replay(&reader);
+
+	SetHostClock(&clock);
+
+	if (!replay.Open())
+	{
+		fprintf(stderr, "%s: not a PTP recording\n", argv[1]);
+		return 1;
+	}
+	ptp.SetTransport(&replay);
+
+	HexDump		dmp;
+	uint16_t	rc = ptp.OpenSession();
+
+	if (rc == PTP_RC_OK)
+		rc = ptp.GetDeviceInfo(&dmp);
+	if (rc == PTP_RC_OK)
+		rc = ptp.GetStorageIDs(&dmp);
+
+	printf("\r\nresult: %04X played: %u mismatches: %u recorded time, ms: %u\r\n",
+		rc, (unsigned)replay.GetCount(), replay.GetMismatches(), (unsigned)(replay.GetTime() / 1000));
+
+	fclose(f);
+	return (rc == PTP_RC_OK && !replay.GetMismatches()) ? 0 : 1;
+}
@@ -86,6 +86,11 @@ uint16_t NikonDSLR::CaptureInSDRAM()
 	return Operation(NK_OC_CaptureInSDRAM, 0, NULL);
 }
 
+uint16_t NikonDSLR::DeviceReady()
+{
+	return Operation(NK_OC_DeviceReady, 0, NULL);
+}
+
 uint16_t NikonDSLR::EventCheck(PTPReadParser *parser)
 {
 	uint16_t	ptp_error	= PTP_RC_GeneralError;
@@ -97,6 +102,16 @@ uint16_t NikonDSLR::EventCheck(PTPReadParser *parser)
 	return ptp_error;
 }
 
+uint16_t NikonDSLR::StartLiveView()
+{
+	return Operation(PTP_OC_NIKON_StartLiveView, 0, NULL);
+}
+
+uint16_t NikonDSLR::EndLiveView()
+{
+	return Operation(PTP_OC_NIKON_EndLiveView, 0, NULL);
+}
+
 uint16_t NikonDSLR::GetLiveViewImage(PTPReadParser *parser)
 {
 	OperFlags	flags		= { 0, 0, 0, 1, 1, 0 };
@@ -104,6 +119,17 @@ uint16_t NikonDSLR::GetLiveViewImage(PTPReadParser *parser)
 	return Transaction(PTP_OC_NIKON_GetLiveViewImg, &flags, NULL, parser);
 }
 
+uint16_t NikonDSLR::ChangeAfArea(uint16_t x, uint16_t y)
+{
+	OperFlags	flags		= { 2, 0, 0, 0, 0, 0 };
+
+	uint32_t	params[2];
+	params[0]	= (uint32_t)x;
+	params[1]	= (uint32_t)y;
+
+	return Transaction(PTP_OC_NIKON_ChangeAfArea, &flags, params, NULL);
+}
+
 uint16_t NikonDSLR::MoveFocus(uint8_t direction, uint16_t step)
 {
 	OperFlags	flags		= { 2, 0, 0, 0, 0, 0 };
@@ -113,4 +139,15 @@ uint16_t NikonDSLR::MoveFocus(uint8_t direction, uint16_t step)
 	params[1]	= (uint32_t)step;
 
 	return Transaction(PTP_OC_NIKON_MfDrive, &flags, params, NULL);
-}
\ No newline at end of file
+}
+
+uint16_t NikonDSLR::GetFileInfoInBlock(uint32_t handle, uint16_t count, PTPReadParser *parser)
+{
+	OperFlags	flags		= { 2, 0, 0, 1, 1, 0 };
+
+	uint32_t	params[2];
+	params[0]	= handle;
+	params[1]	= (uint32_t)count;
+
+	return Transaction(NK_OC_GetFileInfoInBlock, &flags, params, parser);
+}
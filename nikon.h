@@ -44,6 +44,13 @@ e-mail   :  support@circuitsathome.com
 #define PTP_OC_NIKON_AfDriveCancel					0x9206
 
 
+// MoveFocus directions
+#define NK_MF_DRIVE_NEAR							1
+#define NK_MF_DRIVE_INFINITY						2
+
+// Object handle of the image captured with NK_OC_CaptureInSDRAM
+#define NK_OBJECT_IN_SDRAM							0xFFFF0001
+
 // Nikon extention response codes
 #define NK_RC_HardwareError							0xA001
 #define NK_RC_OutOfFocus							0xA002
@@ -193,10 +200,18 @@ public:
 
 	uint16_t Capture();
 	uint16_t CaptureInSDRAM();
+	uint16_t DeviceReady();
 
 	uint16_t EventCheck(PTPReadParser *parser);
+	uint16_t StartLiveView();
+	uint16_t EndLiveView();
 	uint16_t GetLiveViewImage(PTPReadParser *parser);
+	// AF area center in whole image coordinates
+	uint16_t ChangeAfArea(uint16_t x, uint16_t y);
 	uint16_t MoveFocus(uint8_t direction, uint16_t step);
+
+	// ObjectInfo datasets of count objects starting from handle in one transaction, see NKFileInfoParser
+	uint16_t GetFileInfoInBlock(uint32_t handle, uint16_t count, PTPReadParser *parser);
 };
 
 
@@ -0,0 +1,224 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "nkburst.h"
+
+NKBurst::NKBurst(NikonDSLR *nikon, NKBurstSink *sink) :
+	pNikon(nikon),
+	pSink(sink),
+	evtParser(this),
+	theState(stIdle),
+	bPipeline(true),
+	bFrameBegun(false),
+	numFrames(0),
+	numFired(0),
+	numDone(0),
+	objHandle(0),
+	theBackOff(NK_BURST_BACKOFF_MAX),
+	timeFired(0)
+{
+}
+
+uint16_t NKBurst::Start(uint16_t frames, bool pipeline)
+{
+	if (!frames)
+		return PTP_RC_InvalidParameter;
+
+	numFrames	= frames;
+	numFired	= 0;
+	numDone		= 0;
+	objHandle	= 0;
+	bPipeline	= pipeline;
+	bFrameBegun	= false;
+	theHandles.Empty();
+	theBackOff.Reset();
+
+	theStats.numFrames		= 0;
+	theStats.numErrors		= 0;
+	theStats.numBusy		= 0;
+	theStats.timeStart		= millis();
+	theStats.timeEnd		= theStats.timeStart;
+	memset(&theStats.stCapture, 0, sizeof(NKStageTime));
+	memset(&theStats.stReady, 0, sizeof(NKStageTime));
+	memset(&theStats.stDownload, 0, sizeof(NKStageTime));
+
+	theState = stCapture;
+	return PTP_RC_OK;
+}
+
+void NKBurst::Finish()
+{
+	theState		= stIdle;
+	theStats.timeEnd= millis();
+}
+
+void NKBurst::AddStageTime(NKStageTime *st, uint32_t t)
+{
+	uint32_t	us = st->sumUs + t % 1000;
+
+	st->sum		+= t / 1000 + us / 1000;
+	st->sumUs	= us % 1000;
+
+	if (t > st->max)
+		st->max = t;
+}
+
+// Returns true if the operation has to be repeated later
+bool NKBurst::BusyWait(uint16_t rc)
+{
+	if (rc != PTP_RC_DeviceBusy)
+	{
+		theBackOff.Succeeded();
+		return false;
+	}
+	theStats.numBusy ++;
+	theBackOff.Failed();
+	return true;
+}
+
+uint16_t NKBurst::GetFrameRate()
+{
+	uint32_t	elapsed = theStats.timeEnd - theStats.timeStart;
+
+	if (IsRunning())
+		elapsed = millis() - theStats.timeStart;
+
+	return PTPFrameRate(theStats.numFrames, elapsed);
+}
+
+uint16_t NKBurst::OnCapture()
+{
+	uint32_t	t = micros();
+	uint16_t	ptp_error = pNikon->CaptureInSDRAM();
+
+	AddStageTime(&theStats.stCapture, micros() - t);
+
+	if (BusyWait(ptp_error))
+		return PTP_RC_OK;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("CaptureInSDRAM error:", ptp_error);
+		theStats.numErrors ++;
+		Finish();
+		return ptp_error;
+	}
+	numFired ++;
+	timeFired = micros();
+
+	// the previous frame is downloaded while the camera is busy with this one
+	if (objHandle)
+		theState = stDownload;
+	else
+	{
+		theBackOff.Wait(PTP_BACKOFF_MIN);
+		theState = stWaitReady;
+	}
+	return ptp_error;
+}
+
+uint16_t NKBurst::OnWaitReady()
+{
+	uint16_t	ptp_error = pNikon->DeviceReady();
+
+	if (BusyWait(ptp_error))
+		return PTP_RC_OK;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("DeviceReady error:", ptp_error);
+		theStats.numErrors ++;
+		Finish();
+		return ptp_error;
+	}
+	AddStageTime(&theStats.stReady, micros() - timeFired);
+
+	// picks up NK_EC_ObjectAddedInSDRAM with the handle of the new object
+	evtParser.Reset();
+	pNikon->EventCheck(&evtParser);
+
+	if ((objHandle = theHandles.Pop()) == 0)
+		objHandle = NK_OBJECT_IN_SDRAM;
+
+	bFrameBegun	= false;
+	theState	= (bPipeline && numFired < numFrames) ? stCapture : stDownload;
+	return ptp_error;
+}
+
+uint16_t NKBurst::OnDownload()
+{
+	if (pSink && !bFrameBegun)
+		pSink->OnFrameBegin(numDone, objHandle);
+
+	bFrameBegun = true;
+
+	uint32_t	t = micros();
+	uint16_t	ptp_error = pNikon->GetObject(objHandle, pSink);
+
+	if (BusyWait(ptp_error))
+		return PTP_RC_OK;
+
+	AddStageTime(&theStats.stDownload, micros() - t);
+
+	if (ptp_error == PTP_RC_OK)
+		theStats.numFrames ++;
+	else
+	{
+		PTPTRACE2("SDRAM GetObject error:", ptp_error);
+		theStats.numErrors ++;
+	}
+	if (pSink)
+		pSink->OnFrameEnd(numDone, ptp_error);
+
+	numDone ++;
+	objHandle		= 0;
+	theStats.timeEnd= millis();
+
+	if (numDone < numFired)
+		theState = stWaitReady;
+	else if (numFired < numFrames)
+		theState = stCapture;
+	else
+		Finish();
+
+	return ptp_error;
+}
+
+uint16_t NKBurst::Task()
+{
+	if (theState == stIdle)
+		return PTP_RC_OK;
+
+	if (!theBackOff.IsDue())
+		return PTP_RC_OK;
+
+	switch (theState)
+	{
+	case stCapture:
+		return OnCapture();
+	case stWaitReady:
+		return OnWaitReady();
+	case stDownload:
+		return OnDownload();
+	}
+	return PTP_RC_OK;
+}
+
+void NKBurst::OnEvent(const NKEvent *evt)
+{
+	if (evt->eventCode == NK_EC_ObjectAddedInSDRAM)
+		theHandles.Push(evt->dwParam);
+}
@@ -0,0 +1,112 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __NKBURST_H__
+#define __NKBURST_H__
+
+#include <nikon.h>
+#include <nkeventparser.h>
+#include <simplefifo.h>
+#include <ptppacing.h>
+
+#define NK_BURST_BACKOFF_MAX		32		// DeviceReady polls are kept tight, the frame is usually ready soon, ms
+
+// Stage timing. The sum is kept in milliseconds plus the microseconds below
+// one, a microsecond sum would wrap after 71 minutes of downloads.
+struct NKStageTime
+{
+	uint32_t	sum;				// ms
+	uint16_t	sumUs;				// us carried over, below 1000
+	uint32_t	max;				// us
+
+	// average over num stages, us
+	uint32_t Average(uint16_t num) const
+	{
+		return (num) ? (sum / num) * 1000 + ((sum % num) * 1000 + sumUs) / num : 0;
+	};
+};
+
+struct NKBurstStats
+{
+	uint16_t	numFrames;			// frames downloaded
+	uint16_t	numErrors;
+	uint16_t	numBusy;			// DeviceBusy responses received
+	uint32_t	timeStart;			// millis() of the first capture command
+	uint32_t	timeEnd;			// millis() of the last download completion
+	NKStageTime	stCapture;			// CaptureInSDRAM transaction
+	NKStageTime	stReady;			// capture command to the first successful DeviceReady
+	NKStageTime	stDownload;			// GetObject transaction
+};
+
+// Destination of the downloaded frames. Parse() receives the GetObject data
+// stage including the 12 byte PTP container header.
+class NKBurstSink : public PTPReadParser
+{
+public:
+	virtual void OnFrameBegin(uint16_t frame __attribute__ ((unused)), uint32_t handle __attribute__ ((unused))) {};
+	virtual void OnFrameEnd(uint16_t frame __attribute__ ((unused)), uint16_t rc __attribute__ ((unused))) {};
+};
+
+class NKBurst : public NKEventHandlers
+{
+	enum { stIdle, stCapture, stWaitReady, stDownload };
+
+	NikonDSLR				*pNikon;
+	NKBurstSink				*pSink;
+	NKEventParser			evtParser;
+	SimpleFIFO<uint32_t, 4>	theHandles;			// handles from NK_EC_ObjectAddedInSDRAM
+
+	uint8_t					theState;
+	bool					bPipeline;			// fire the next frame before downloading the current one
+	bool					bFrameBegun;
+	uint16_t				numFrames;			// frames requested
+	uint16_t				numFired;			// capture commands accepted
+	uint16_t				numDone;			// downloads finished
+	uint32_t				objHandle;			// object waiting for download
+
+	PTPBackOff				theBackOff;
+	uint32_t				timeFired;			// micros() of the last capture command
+
+	NKBurstStats			theStats;
+
+	void AddStageTime(NKStageTime *st, uint32_t t);
+	bool BusyWait(uint16_t rc);
+	void Finish();
+
+	uint16_t OnCapture();
+	uint16_t OnWaitReady();
+	uint16_t OnDownload();
+
+public:
+	NKBurst(NikonDSLR *nikon, NKBurstSink *sink);
+
+	uint16_t Start(uint16_t frames, bool pipeline = true);
+	void Stop() { Finish(); };
+	bool IsRunning() { return (theState != stIdle); };
+
+	// Should be called from OnDeviceInitializedState. Runs one step of the burst
+	// and never blocks longer than one PTP transaction.
+	uint16_t Task();
+
+	const NKBurstStats* GetStats() { return &theStats; };
+	// frames per second multiplied by 100
+	uint16_t GetFrameRate();
+
+	// NKEventHandlers implementation
+	virtual void OnEvent(const NKEvent *evt);
+};
+
+#endif // __NKBURST_H__
@@ -0,0 +1,30 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "nkcontrastaf.h"
+
+uint16_t NKContrastAF::DriveFocus(int16_t steps, int16_t *taken)
+{
+	uint16_t	ptp_error;
+
+	if (steps < 0)
+		ptp_error = pNikon->MoveFocus(NK_MF_DRIVE_NEAR, (uint16_t)(-steps));
+	else
+		ptp_error = pNikon->MoveFocus(NK_MF_DRIVE_INFINITY, (uint16_t)steps);
+
+	*taken = (ptp_error == PTP_RC_OK) ? steps : 0;
+	return ptp_error;
+}
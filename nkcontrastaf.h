@@ -0,0 +1,39 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __NKCONTRASTAF_H__
+#define __NKCONTRASTAF_H__
+
+#include <nikon.h>
+#include <ptpcontrastaf.h>
+
+// PTPContrastAF for Nikon. Live view has to be on, MfDrive steps are the drive
+// units. The lens is settled when DeviceReady stops returning DeviceBusy.
+class NKContrastAF : public PTPContrastAF
+{
+	NikonDSLR	*pNikon;
+
+protected:
+	virtual uint16_t DriveFocus(int16_t steps, int16_t *taken);
+	virtual uint16_t FocusReady() { return pNikon->DeviceReady(); };
+	virtual uint16_t GetFrame(PTPReadParser *parser) { return pNikon->GetLiveViewImage(parser); };
+	virtual bool IsDriveEnd(uint16_t rc) { return (rc == NK_RC_MfDriveStepEnd || rc == NK_RC_MfDriveStepInsufficiency); };
+
+public:
+	NKContrastAF(NikonDSLR *nikon) : pNikon(nikon) {};
+};
+
+#endif // __NKCONTRASTAF_H__
@@ -24,8 +24,9 @@ void NKEventParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_
 	switch (nStage)
 	{
 	case 0:
-		p		+= 12;
-		cntdn	-= 12;
+		// PTP container header, may arrive split into several chunks
+		if (!byteSkipper.Skip(&p, &cntdn, 12))
+			return;
 		nStage	= 1;
 	case 1:
 		theBuffer.valueSize = 2;
@@ -35,7 +36,7 @@ void NKEventParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_
 		if (!valueParser.Parse(&p, &cntdn))
 			return;
 
-		numEvents = (uint16_t)varBuffer;
+		numEvents = varBuffer[0];
 		eventCountdown = numEvents;
 
 		nStage = 3;
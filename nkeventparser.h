@@ -33,7 +33,7 @@ struct NKEvent
 		};
 		uint32_t		dwParam;
 	};
-};
+} __attribute__((packed));			// 6 byte event record as sent by the camera
 struct NKPropertyChangedEvent
 {
 	uint16_t	eventCode;
@@ -58,7 +58,7 @@ public:
 	//void OnCaptureComplete() = 0;
 };
 
-class NKEventParser : public PTPReadParser
+class NKEventParser : public PTPResettableParser
 {
 
     NKEventHandlers			*pHandler;
@@ -80,7 +80,7 @@ class NKEventParser : public PTPReadParser
 	//NKEvent					nkEvent;
 
 	MultiByteValueParser	valueParser;
-	//ByteSkipper				byteSkipper;
+	ByteSkipper				byteSkipper;
 
 public:
 	NKEventParser(NKEventHandlers *p) :
@@ -95,12 +95,16 @@ public:
 			theBuffer.pValue = &varBuffer;
 		};
 
-	void Reset()
+	virtual void Reset()
 	{
 		nStage			= 0;
+		numEvents		= 0;
 
 		for (uint8_t i=0; i<3; i++)
 			varBuffer[i] = 0;
+
+		// a skip cut short would otherwise resume with its old count
+		byteSkipper		= ByteSkipper();
 	};
 
 	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
@@ -0,0 +1,348 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "nkfileindex.h"
+
+// sizes of the ObjectInfo fields which precede the strings
+static const uint8_t objInfoFieldSizes[] = { 4, 2, 2, 4, 2, 4, 4, 4, 4, 4, 4, 4, 2, 4, 4 };
+
+#define NK_OBJINFO_NUM_FIELDS		sizeof(objInfoFieldSizes)
+#define NK_OBJINFO_FORMAT			1
+#define NK_OBJINFO_SIZE				3
+#define NK_OBJINFO_PARENT			11
+
+void NKFileInfoParser::Reset(NKFileInfo *records, uint16_t max_records, bool block)
+{
+	pRecords	= records;
+	maxRecords	= max_records;
+	numParsed	= 0;
+	numLeft		= 0;
+	bBlock		= block;
+	bMismatch	= false;
+	nStage		= psHeader;
+	fieldIdx	= 0;
+	byteIdx		= 0;
+	curValue	= 0;
+	strIdx		= 0;
+	byteSkipper	= ByteSkipper();
+
+	if (pRecords && maxRecords && !bBlock)
+		Clear(pRecords);
+}
+
+void NKFileInfoParser::Clear(NKFileInfo *rec)
+{
+	rec->size			= 0;
+	rec->parent			= 0;
+	rec->format			= 0;
+	rec->fileName[0]	= 0;
+}
+
+void NKFileInfoParser::OnField(NKFileInfo *rec)
+{
+	if (!rec)
+		return;
+
+	switch (fieldIdx)
+	{
+	case NK_OBJINFO_FORMAT:
+		rec->format = (uint16_t)curValue;
+		break;
+	case NK_OBJINFO_SIZE:
+		rec->size = curValue;
+		break;
+	case NK_OBJINFO_PARENT:
+		rec->parent = curValue;
+		break;
+	}
+}
+
+void NKFileInfoParser::OnRecordEnd()
+{
+	if (Current())
+		numParsed ++;
+
+	if (bBlock && --numLeft)
+		nStage = psHandle;
+	else
+		nStage = psDone;
+}
+
+void NKFileInfoParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset __attribute__ ((unused)))
+{
+	uint8_t		*p	= (uint8_t*) pbuf;
+	uint16_t	cntdn	= len;
+
+	if (nStage == psHeader)
+	{
+		// PTP container header, may arrive split into several chunks
+		if (!byteSkipper.Skip(&p, &cntdn, PTP_USB_BULK_HDR_LEN))
+			return;
+
+		nStage = (bBlock) ? psCount : psFields;
+	}
+	for (; cntdn; cntdn--, p++)
+	{
+		NKFileInfo	*rec = Current();
+
+		switch (nStage)
+		{
+		case psCount:
+		case psHandle:
+		case psFields:
+			{
+				uint8_t	size = (nStage == psFields) ? objInfoFieldSizes[fieldIdx] : 4;
+
+				curValue |= (uint32_t)*p << (byteIdx << 3);
+
+				if (++byteIdx < size)
+					break;
+			}
+			if (nStage == psCount)
+			{
+				numLeft	= curValue;
+				nStage	= (numLeft) ? psHandle : psDone;
+
+				if (numLeft > maxRecords)
+				{
+					bMismatch	= true;
+					nStage		= psDone;
+				}
+			}
+			else if (nStage == psHandle)
+			{
+				// the handles are known already, a different one means the layout is not the one assumed
+				if (!rec || rec->handle != curValue)
+				{
+					bMismatch	= true;
+					nStage		= psDone;
+					return;
+				}
+				Clear(rec);
+				nStage = psFields;
+			}
+			else
+			{
+				OnField(rec);
+
+				if (++fieldIdx == NK_OBJINFO_NUM_FIELDS)
+				{
+					fieldIdx	= 0;
+					strIdx		= 0;
+					nStage		= psStrLen;
+				}
+			}
+			byteIdx		= 0;
+			curValue	= 0;
+			break;
+		case psStrLen:
+			// number of UTF-16 characters, the terminating zero included
+			strLeft	= (uint16_t)*p << 1;
+			strPos	= 0;
+
+			if (strLeft)
+				nStage = psStrChars;
+			else if (++strIdx == 4)
+				OnRecordEnd();
+			break;
+		case psStrChars:
+			// the low byte of each character of Filename
+			if (!strIdx && rec && !(strLeft & 1) && strPos < NK_FILEINFO_NAME_LEN - 1)
+			{
+				rec->fileName[strPos++]	= (char)*p;
+				rec->fileName[strPos]	= 0;
+			}
+			if (--strLeft)
+				break;
+
+			if (++strIdx == 4)
+				OnRecordEnd();
+			else
+				nStage = psStrLen;
+			break;
+		default:
+			return;
+		}
+	}
+}
+
+void NKFileIndex::HandleParser::OnHandle(const MultiValueBuffer * const p, uint32_t count __attribute__ ((unused)), const void *me)
+{
+	NKFileIndex		*index = ((HandleParser*)me)->pIndex;
+
+	index->theStats.numObjects ++;
+
+	if (index->numRecords < index->maxRecords)
+		index->pRecords[index->numRecords++].handle = *((uint32_t*)p->pValue);
+}
+
+void NKFileIndex::HandleParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset __attribute__ ((unused)))
+{
+	uint8_t		*p	= (uint8_t*) pbuf;
+	uint16_t	cntdn	= len;
+
+	switch (nStage)
+	{
+	case 0:
+		if (!byteSkipper.Skip(&p, &cntdn, PTP_USB_BULK_HDR_LEN))
+			return;
+
+		listParser.Initialize(4, 4, &theBuffer);
+		nStage = 1;
+	case 1:
+		if (!listParser.Parse(&p, &cntdn, &OnHandle, this))
+			return;
+
+		nStage = 2;
+	}
+}
+
+NKFileIndex::NKFileIndex(NikonDSLR *nikon, NKFileInfo *records, uint16_t max_records) :
+	pNikon(nikon),
+	pRecords(records),
+	maxRecords(max_records),
+	numRecords(0),
+	numDone(0),
+	storageID(0xFFFFFFFF),
+	theState(stIdle),
+	bBlock(false),
+	hndParser(this)
+{
+	memset(&theStats, 0, sizeof(theStats));
+}
+
+uint16_t NKFileIndex::Start(uint32_t storage_id, bool block)
+{
+	if (!pRecords || !maxRecords)
+		return PTP_RC_InvalidParameter;
+
+	storageID	= storage_id;
+	numRecords	= 0;
+	numDone		= 0;
+	bBlock		= block;
+
+	memset(&theStats, 0, sizeof(theStats));
+	theStats.timeStart	= millis();
+	theStats.timeEnd	= theStats.timeStart;
+
+	theState = stHandles;
+	return PTP_RC_OK;
+}
+
+void NKFileIndex::Finish()
+{
+	theState		= stIdle;
+	theStats.timeEnd= millis();
+}
+
+uint16_t NKFileIndex::OnHandles()
+{
+	hndParser.Reset();
+
+	uint16_t	ptp_error = pNikon->GetObjectHandles(storageID, 0, 0, &hndParser);
+
+	theStats.numTransactions ++;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("GetObjectHandles error:", ptp_error);
+		theStats.numErrors ++;
+		Finish();
+		return ptp_error;
+	}
+	if (numRecords)
+		theState = (bBlock) ? stBlock : stSingle;
+	else
+		Finish();
+
+	return ptp_error;
+}
+
+uint16_t NKFileIndex::OnBlock()
+{
+	uint16_t	count = numRecords - numDone;
+
+	if (count > NK_FILEINFO_BLOCK_SIZE)
+		count = NK_FILEINFO_BLOCK_SIZE;
+
+	infoParser.Reset(pRecords + numDone, count, true);
+
+	uint16_t	ptp_error = pNikon->GetFileInfoInBlock(pRecords[numDone].handle, count, &infoParser);
+
+	theStats.numTransactions ++;
+
+	// An empty or mismatched block is taken for no support as well. Nothing of the
+	// block is kept, it is fetched again object by object along with the rest.
+	if (ptp_error == PTP_RC_OperationNotSupported || (ptp_error == PTP_RC_OK && (!infoParser.GetCount() || !infoParser.IsValid())))
+	{
+		bBlock		= false;
+		theState	= stSingle;
+		return PTP_RC_OK;
+	}
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("GetFileInfoInBlock error:", ptp_error);
+		theStats.numErrors ++;
+		Finish();
+		return ptp_error;
+	}
+	numDone			+= infoParser.GetCount();
+	theStats.timeEnd = millis();
+
+	if (numDone >= numRecords)
+		Finish();
+
+	return ptp_error;
+}
+
+uint16_t NKFileIndex::OnSingle()
+{
+	NKFileInfo	*rec = pRecords + numDone;
+
+	infoParser.Reset(rec, 1, false);
+
+	uint16_t	ptp_error = pNikon->GetObjectInfo(rec->handle, &infoParser);
+
+	theStats.numTransactions ++;
+
+	// the record is kept with what has been parsed, the index goes on
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("GetObjectInfo error:", ptp_error);
+		theStats.numErrors ++;
+	}
+	numDone			++;
+	theStats.timeEnd = millis();
+
+	if (numDone >= numRecords)
+		Finish();
+
+	return ptp_error;
+}
+
+uint16_t NKFileIndex::Task()
+{
+	switch (theState)
+	{
+	case stHandles:
+		return OnHandles();
+	case stBlock:
+		return OnBlock();
+	case stSingle:
+		return OnSingle();
+	}
+	return PTP_RC_OK;
+}
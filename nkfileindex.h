@@ -0,0 +1,161 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __NKFILEINDEX_H__
+#define __NKFILEINDEX_H__
+
+#include <nikon.h>
+
+#define NK_FILEINFO_BLOCK_SIZE		64		// objects per NK_OC_GetFileInfoInBlock transaction
+#define NK_FILEINFO_NAME_LEN		13		// 8.3 file name and the terminating zero
+
+// Compact object record, what is needed to browse and download a card
+struct NKFileInfo
+{
+	uint32_t	handle;
+	uint32_t	size;					// ObjectCompressedSize
+	uint32_t	parent;
+	uint16_t	format;
+	char		fileName[NK_FILEINFO_NAME_LEN];
+};
+
+// Streams PTP ObjectInfo datasets into NKFileInfo records. In block mode the
+// data stage is a uint32_t count followed by that many handle and ObjectInfo
+// pairs (NK_OC_GetFileInfoInBlock), otherwise it is a single ObjectInfo
+// (GetObjectInfo) for the record given to Reset(). The block layout is not
+// documented, a count above the one requested or a handle other than the
+// one of the record stops the parsing and marks the block as mismatched.
+class NKFileInfoParser : public PTPReadParser
+{
+	enum { psHeader, psCount, psHandle, psFields, psStrLen, psStrChars, psDone };
+
+	NKFileInfo			*pRecords;
+	uint16_t			maxRecords;
+	uint16_t			numParsed;			// records filled
+	uint32_t			numLeft;			// block entries left
+
+	bool				bBlock;
+	bool				bMismatch;			// block data does not match the records
+	uint8_t				nStage;
+	uint8_t				fieldIdx;
+	uint8_t				byteIdx;
+	uint32_t			curValue;
+	uint8_t				strIdx;				// 0 - Filename, 1 - CaptureDate, 2 - ModificationDate, 3 - Keywords
+	uint16_t			strLeft;			// bytes of the current string left
+	uint8_t				strPos;
+
+	ByteSkipper			byteSkipper;
+
+	void Clear(NKFileInfo *rec);
+	void OnField(NKFileInfo *rec);
+	void OnRecordEnd();
+	NKFileInfo* Current() { return (numParsed < maxRecords) ? pRecords + numParsed : NULL; };
+
+public:
+	NKFileInfoParser() : pRecords(NULL), maxRecords(0), numParsed(0), numLeft(0), bBlock(false), bMismatch(false), nStage(psDone) {};
+
+	// records - where the parsed records go, with the handles already set; in block mode max_records is the count requested
+	void Reset(NKFileInfo *records, uint16_t max_records, bool block);
+	uint16_t GetCount() { return numParsed; };
+	// block mode: the handles and the count agree with the records and every record announced has been parsed
+	bool IsValid() { return (!bMismatch && nStage == psDone); };
+
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+struct NKFileIndexStats
+{
+	uint16_t	numObjects;				// handles reported by the camera
+	uint16_t	numTransactions;
+	uint16_t	numErrors;
+	uint32_t	timeStart;				// millis() of Start()
+	uint32_t	timeEnd;				// millis() of the last record
+};
+
+// Builds the list of objects on a storage with their metadata. The handles
+// come with one GetObjectHandles, the metadata with one GetObjectInfo per
+// object. With block mode enabled NK_OC_GetFileInfoInBlock is tried first for
+// NK_FILEINFO_BLOCK_SIZE objects at a time; its data layout is assumed, so it
+// is off by default. A camera without the operation or a block which does
+// not match the handles switches the index to GetObjectInfo, starting over
+// with that block.
+class NKFileIndex
+{
+	enum { stIdle, stHandles, stBlock, stSingle };
+
+	// GetObjectHandles data stage, uint32_t array of handles
+	class HandleParser : public PTPReadParser
+	{
+		NKFileIndex			*pIndex;
+		uint8_t				nStage;
+		MultiValueBuffer	theBuffer;
+		uint32_t			varBuffer;
+		PTPListParser		listParser;
+		ByteSkipper			byteSkipper;
+
+		static void OnHandle(const MultiValueBuffer * const p, uint32_t count, const void *me);
+
+	public:
+		HandleParser(NKFileIndex *index) : pIndex(index), nStage(0), varBuffer(0) { theBuffer.pValue = &varBuffer; };
+
+		void Reset()
+		{
+			nStage		= 0;
+			varBuffer	= 0;
+			byteSkipper	= ByteSkipper();
+			listParser.Initialize(4, 4, &theBuffer);
+		};
+		virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+	};
+
+	NikonDSLR			*pNikon;
+	NKFileInfo			*pRecords;
+	uint16_t			maxRecords;
+	uint16_t			numRecords;			// handles stored
+	uint16_t			numDone;			// records with metadata
+	uint32_t			storageID;
+	uint8_t				theState;
+	bool				bBlock;				// cleared if the camera has no NK_OC_GetFileInfoInBlock or its data do not match
+
+	HandleParser		hndParser;
+	NKFileInfoParser	infoParser;
+	NKFileIndexStats	theStats;
+
+	void Finish();
+	uint16_t OnHandles();
+	uint16_t OnBlock();
+	uint16_t OnSingle();
+
+public:
+	NKFileIndex(NikonDSLR *nikon, NKFileInfo *records, uint16_t max_records);
+
+	// block - try NK_OC_GetFileInfoInBlock first
+	uint16_t Start(uint32_t storage_id = 0xFFFFFFFF, bool block = false);
+	void Stop() { Finish(); };
+	bool IsRunning() { return (theState != stIdle); };
+
+	// Runs one transaction per call
+	uint16_t Task();
+
+	// records complete so far; when the storage holds more objects than
+	// max_records, only the first max_records are indexed
+	uint16_t GetCount() { return numDone; };
+	const NKFileInfo* GetRecords() { return pRecords; };
+	const NKFileIndexStats* GetStats() { return &theStats; };
+	bool IsBlockSupported() { return bBlock; };
+};
+
+#endif // __NKFILEINDEX_H__
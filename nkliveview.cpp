@@ -0,0 +1,228 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "nkliveview.h"
+
+NKLiveView::NKLiveView(NikonDSLR *nikon, NKLiveViewSink *sink) :
+	pNikon(nikon),
+	pSink(sink),
+	theState(stIdle),
+	nStage(psHeader),
+	hdrSize(NK_LV_HEADER_SIZE),
+	hdrPos(0),
+	bMarker(false),
+	jpegSize(0)
+{
+	memset(&theHeader, 0, sizeof(theHeader));
+	memset(&theStats, 0, sizeof(theStats));
+}
+
+uint16_t NKLiveView::Start()
+{
+	uint16_t	ptp_error = pNikon->StartLiveView();
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("StartLiveView error:", ptp_error);
+		return ptp_error;
+	}
+	memset(&theStats, 0, sizeof(theStats));
+	theStats.timeStart = millis();
+
+	// the first frames are available only after the mirror has gone up
+	theState = stRunning;
+	theBackOff.Reset();
+	return ptp_error;
+}
+
+uint16_t NKLiveView::Stop()
+{
+	theState = stIdle;
+	return pNikon->EndLiveView();
+}
+
+uint16_t NKLiveView::GetFrameRate()
+{
+	uint32_t	elapsed = millis() - theStats.timeStart;
+
+	return PTPFrameRate(theStats.numFrames, elapsed);
+}
+
+static uint16_t BigEndian16(const uint8_t *p)
+{
+	return ((uint16_t)p[0] << 8) | p[1];
+}
+
+void NKLiveView::DecodeHeader()
+{
+	const uint8_t	*p = theHeader.raw;
+
+	theHeader.jpegWidth		= BigEndian16(p + NK_LV_OFF_JPEG_WIDTH);
+	theHeader.jpegHeight	= BigEndian16(p + NK_LV_OFF_JPEG_HEIGHT);
+	theHeader.wholeWidth	= BigEndian16(p + NK_LV_OFF_WHOLE_WIDTH);
+	theHeader.wholeHeight	= BigEndian16(p + NK_LV_OFF_WHOLE_HEIGHT);
+	theHeader.dispWidth		= BigEndian16(p + NK_LV_OFF_DISP_WIDTH);
+	theHeader.dispHeight	= BigEndian16(p + NK_LV_OFF_DISP_HEIGHT);
+	theHeader.dispCenterX	= BigEndian16(p + NK_LV_OFF_DISP_CENTER_X);
+	theHeader.dispCenterY	= BigEndian16(p + NK_LV_OFF_DISP_CENTER_Y);
+	theHeader.afWidth		= BigEndian16(p + NK_LV_OFF_AF_WIDTH);
+	theHeader.afHeight		= BigEndian16(p + NK_LV_OFF_AF_HEIGHT);
+	theHeader.afCenterX		= BigEndian16(p + NK_LV_OFF_AF_CENTER_X);
+	theHeader.afCenterY		= BigEndian16(p + NK_LV_OFF_AF_CENTER_Y);
+}
+
+void NKLiveView::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+{
+	const uint8_t	*p		= pbuf;
+	uint16_t		cntdn	= len;
+
+	if (!offset)
+	{
+		nStage		= psHeader;
+		hdrPos		= 0;
+		bMarker		= false;
+		jpegSize	= 0;
+	}
+	// PTP container header
+	if (offset < PTP_USB_BULK_HDR_LEN)
+	{
+		uint16_t	skip = PTP_USB_BULK_HDR_LEN - offset;
+
+		if (skip >= cntdn)
+			return;
+
+		p		+= skip;
+		cntdn	-= skip;
+	}
+	if (nStage == psHeader)
+	{
+		uint16_t	n = hdrSize - hdrPos;
+
+		if (n > cntdn)
+			n = cntdn;
+
+		for (uint16_t i=0; i<n; i++, hdrPos++)
+			if (hdrPos < NK_LV_HEADER_KEEP)
+				theHeader.raw[hdrPos] = p[i];
+
+		p		+= n;
+		cntdn	-= n;
+
+		if (hdrPos < hdrSize)
+			return;
+
+		DecodeHeader();
+
+		if (pSink)
+			pSink->OnHeader(&theHeader);
+
+		nStage = psMarker;
+	}
+	// some models pad the header, the JPEG starts with the SOI marker FF D8
+	if (nStage == psMarker)
+	{
+		const uint8_t	*scan = p;
+
+		for (; cntdn; p++, cntdn--)
+		{
+			if (bMarker && *p == 0xD8)
+				break;
+
+			bMarker = (*p == 0xFF);
+		}
+		if (!cntdn)
+			return;
+
+		nStage = psJpeg;
+
+		if (p == scan)
+		{
+			// 0xFF came with the previous chunk
+			static const uint8_t	soi = 0xFF;
+
+			if (pSink)
+				pSink->Parse(1, &soi, jpegSize);
+
+			jpegSize ++;
+		}
+		else
+		{
+			p		--;
+			cntdn	++;
+		}
+	}
+	if (pSink)
+		pSink->Parse(cntdn, p, jpegSize);
+
+	jpegSize += cntdn;
+}
+
+uint16_t NKLiveView::MoveAfArea(uint16_t x, uint16_t y)
+{
+	if (!theHeader.jpegWidth || !theHeader.jpegHeight)
+		return PTP_RC_InvalidParameter;
+
+	// the JPEG shows the display area, scaled
+	uint32_t	wx = (uint32_t)theHeader.dispCenterX - (theHeader.dispWidth >> 1) + (uint32_t)x * theHeader.dispWidth / theHeader.jpegWidth;
+	uint32_t	wy = (uint32_t)theHeader.dispCenterY - (theHeader.dispHeight >> 1) + (uint32_t)y * theHeader.dispHeight / theHeader.jpegHeight;
+
+	uint16_t	ptp_error = pNikon->ChangeAfArea((uint16_t)wx, (uint16_t)wy);
+
+	if (ptp_error != PTP_RC_OK)
+		PTPTRACE2("ChangeAfArea error:", ptp_error);
+
+	return ptp_error;
+}
+
+uint16_t NKLiveView::Task()
+{
+	if (theState == stIdle)
+		return PTP_RC_OK;
+
+	if (!theBackOff.IsDue())
+		return PTP_RC_OK;
+
+	nStage		= psHeader;
+	hdrPos		= 0;
+	jpegSize	= 0;
+
+	uint16_t	ptp_error = pNikon->GetLiveViewImage(this);
+
+	if (ptp_error == PTP_RC_DeviceBusy || ptp_error == NK_RC_NotLiveView)
+	{
+		theStats.numBusy ++;
+		theBackOff.Failed();
+		return PTP_RC_OK;
+	}
+	theBackOff.Succeeded();
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("GetLiveViewImage error:", ptp_error);
+		theStats.numErrors ++;
+	}
+	else if (nStage != psJpeg)
+		theStats.numNoJpeg ++;
+	else
+	{
+		theStats.numFrames ++;
+		theStats.lastSize = jpegSize;
+	}
+	if (pSink)
+		pSink->OnFrameEnd(jpegSize, ptp_error);
+
+	return ptp_error;
+}
@@ -0,0 +1,133 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __NKLIVEVIEW_H__
+#define __NKLIVEVIEW_H__
+
+#include <nikon.h>
+#include <ptppacing.h>
+
+#define NK_LV_HEADER_SIZE			128		// D90/D300/D3 family, later models use 384
+#define NK_LV_HEADER_KEEP			32		// header bytes kept in NKLiveViewHeader::raw
+
+// Live view header fields, all of them big endian 16 bit values
+#define NK_LV_OFF_JPEG_WIDTH		0
+#define NK_LV_OFF_JPEG_HEIGHT		2
+#define NK_LV_OFF_WHOLE_WIDTH		4
+#define NK_LV_OFF_WHOLE_HEIGHT		6
+#define NK_LV_OFF_DISP_WIDTH		8
+#define NK_LV_OFF_DISP_HEIGHT		10
+#define NK_LV_OFF_DISP_CENTER_X		12
+#define NK_LV_OFF_DISP_CENTER_Y		14
+#define NK_LV_OFF_AF_WIDTH			16
+#define NK_LV_OFF_AF_HEIGHT			18
+#define NK_LV_OFF_AF_CENTER_X		20
+#define NK_LV_OFF_AF_CENTER_Y		22
+
+// Geometry of a live view frame. Display and AF area coordinates are in the
+// whole image space, the JPEG shows the display area.
+struct NKLiveViewHeader
+{
+	uint16_t	jpegWidth;
+	uint16_t	jpegHeight;
+	uint16_t	wholeWidth;
+	uint16_t	wholeHeight;
+	uint16_t	dispWidth;
+	uint16_t	dispHeight;
+	uint16_t	dispCenterX;
+	uint16_t	dispCenterY;
+	uint16_t	afWidth;
+	uint16_t	afHeight;
+	uint16_t	afCenterX;
+	uint16_t	afCenterY;
+
+	// the beginning of the header as received, for model specific fields
+	// such as rotation or focus state
+	uint8_t		raw[NK_LV_HEADER_KEEP];
+};
+
+// Receives live view frames. OnHeader() is called as soon as the header has
+// arrived, before the JPEG data. Parse() gets the JPEG data straight from the
+// USB buffer, offset counts from the JPEG start.
+class NKLiveViewSink : public PTPReadParser
+{
+public:
+	virtual void OnHeader(const NKLiveViewHeader *hdr __attribute__ ((unused))) {};
+	virtual void OnFrameEnd(uint32_t jpeg_size __attribute__ ((unused)), uint16_t rc __attribute__ ((unused))) {};
+};
+
+struct NKLiveViewStats
+{
+	uint32_t	numFrames;
+	uint32_t	numNoJpeg;			// frames with no JPEG start found
+	uint32_t	numBusy;			// DeviceBusy or NotLiveView responses
+	uint32_t	numErrors;
+	uint32_t	timeStart;			// millis() of Start()
+	uint32_t	lastSize;			// JPEG size of the last frame
+};
+
+// Splits NK GetLiveViewImage data into the header and the JPEG as the bytes
+// stream past. The header is decoded on the fly, the JPEG goes to the sink
+// with no intermediate copy.
+class NKLiveView : public PTPReadParser
+{
+	enum { stIdle, stRunning };
+	enum { psHeader, psMarker, psJpeg };
+
+	NikonDSLR			*pNikon;
+	NKLiveViewSink		*pSink;
+
+	uint8_t				theState;
+	uint8_t				nStage;
+	uint16_t			hdrSize;
+	uint16_t			hdrPos;
+	bool				bMarker;			// the last byte seen was 0xFF
+	uint32_t			jpegSize;
+
+	PTPBackOff			theBackOff;
+
+	NKLiveViewHeader	theHeader;
+	NKLiveViewStats		theStats;
+
+	void DecodeHeader();
+
+public:
+	NKLiveView(NikonDSLR *nikon, NKLiveViewSink *sink);
+
+	// header size of the camera model, NK_LV_HEADER_SIZE by default
+	void SetHeaderSize(uint16_t size) { hdrSize = size; };
+
+	uint16_t Start();
+	uint16_t Stop();
+	bool IsRunning() { return (theState != stIdle); };
+
+	// Should be called from OnDeviceInitializedState. Receives one frame per
+	// call and never blocks longer than one PTP transaction.
+	uint16_t Task();
+
+	const NKLiveViewHeader* GetHeader() { return &theHeader; };
+	const NKLiveViewStats* GetStats() { return &theStats; };
+	// frames per second multiplied by 100
+	uint16_t GetFrameRate();
+
+	// Moves the AF area to a point of the last frame, JPEG pixel coordinates
+	uint16_t MoveAfArea(uint16_t x, uint16_t y);
+
+	// PTPReadParser implementation
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+#endif // __NKLIVEVIEW_H__
@@ -0,0 +1,44 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __NKTRIGGER_H__
+#define __NKTRIGGER_H__
+
+#include <nikon.h>
+#include <nkeventparser.h>
+#include <ptptrigger.h>
+
+// Nikon member of PTPTriggerGroup. The capture is reported by ObjectAdded or CaptureComplete.
+class NKTriggerCamera : public PTPTriggerCamera, public NKEventHandlers
+{
+	NikonDSLR			*pNikon;
+	NKEventHandlers		*pNext;
+	NKEventParser		evtParser;
+
+public:
+	NKTriggerCamera(NikonDSLR *nikon, NKEventHandlers *next = NULL) : pNikon(nikon), pNext(next), evtParser(this) {};
+
+	// PTPTriggerCamera implementation
+	virtual uint16_t Arm();
+	virtual uint16_t BeginFire() { return pNikon->BeginOperation(NK_OC_Capture); };
+	virtual uint16_t EndFire() { return pNikon->EndOperation(); };
+	virtual uint16_t Poll();
+
+	// NKEventHandlers implementation
+	virtual void OnEvent(const NKEvent *evt);
+};
+
+#endif // __NKTRIGGER_H__
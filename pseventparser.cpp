@@ -0,0 +1,176 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "pseventparser.h"
+
+void PSEventParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset __attribute__ ((unused)))
+{
+	uint8_t		*p	= (uint8_t*) pbuf;
+	uint16_t	cntdn	= len;
+
+	switch (nStage)
+	{
+	case 0:
+		// PTP container header, may arrive split into several chunks
+		if (!byteSkipper.Skip(&p, &cntdn, PTP_USB_BULK_HDR_LEN))
+			return;
+
+		theBuffer.pValue	= &theEvent;
+		theBuffer.valueSize	= 12;
+		valueParser.Initialize(&theBuffer);
+		nStage = 1;
+	case 1:
+		// no data past the header if there is no event
+		if (!valueParser.Parse(&p, &cntdn))
+			return;
+
+		if (theEvent.length < 12)
+		{
+			nStage = 4;
+			return;
+		}
+		theEvent.params[0] = theEvent.params[1] = theEvent.params[2] = 0;
+		nStage = 2;
+	case 2:
+		{
+			uint8_t		n = theEvent.NumParams();
+
+			theBuffer.pValue	= theEvent.params;
+			theBuffer.valueSize	= ((n < 3) ? n : 3) << 2;
+		}
+		valueParser.Initialize(&theBuffer);
+		nStage = 3;
+	case 3:
+		if (theBuffer.valueSize && !valueParser.Parse(&p, &cntdn))
+			return;
+
+		bEvent = true;
+		nStage = 4;
+	}
+}
+
+void PSEventDrain::ChangesParser::OnProperty(const MultiValueBuffer * const p, uint32_t count __attribute__ ((unused)), const void *me)
+{
+	PSEventDrain	*drain = ((ChangesParser*)me)->pDrain;
+
+	drain->theStats.numChanges ++;
+
+	if (drain->pHandler)
+		drain->pHandler->OnPropertyChanged(*((uint16_t*)p->pValue));
+}
+
+void PSEventDrain::ChangesParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset __attribute__ ((unused)))
+{
+	uint8_t		*p	= (uint8_t*) pbuf;
+	uint16_t	cntdn	= len;
+
+	switch (nStage)
+	{
+	case 0:
+		if (!byteSkipper.Skip(&p, &cntdn, PTP_USB_BULK_HDR_LEN))
+			return;
+
+		listParser.Initialize(4, 2, &theBuffer);
+		nStage = 1;
+	case 1:
+		if (!listParser.Parse(&p, &cntdn, &OnProperty, this))
+			return;
+
+		nStage = 2;
+	}
+}
+
+PSEventDrain::PSEventDrain(CanonPS *ps, PSEventHandlers *handler) :
+	pPS(ps),
+	pHandler(handler),
+	chgParser(this)
+{
+	ResetStats();
+}
+
+void PSEventDrain::ResetStats()
+{
+	theStats.numDrains		= 0;
+	theStats.numChecks		= 0;
+	theStats.numEvents		= 0;
+	theStats.numChanges		= 0;
+	theStats.numErrors		= 0;
+	theStats.maxBatch		= 0;
+	theStats.numCutShort	= 0;
+}
+
+uint16_t PSEventDrain::Drain(uint16_t time_slot)
+{
+	uint32_t	time_start	= millis();
+	uint8_t		num			= 0;
+	bool		changed		= false;
+	bool		empty		= false;
+	uint16_t	ptp_error	= PTP_RC_OK;
+
+	theStats.numDrains ++;
+
+	while (num < PS_EVENT_BATCH_SIZE)
+	{
+		evtParser.Reset();
+
+		ptp_error = pPS->EventCheck(&evtParser);
+		theStats.numChecks ++;
+
+		if (ptp_error != PTP_RC_OK)
+		{
+			theStats.numErrors ++;
+			break;
+		}
+		if (!evtParser.IsEvent())
+		{
+			empty = true;
+			break;
+		}
+		theEvents[num] = *evtParser.GetEvent();
+
+		if (theEvents[num].eventCode == PS_EC_PropertyChanged)
+			changed = true;
+
+		num ++;
+
+		if (millis() - time_start >= time_slot)
+			break;
+	}
+	if (!empty && ptp_error == PTP_RC_OK)
+		theStats.numCutShort ++;
+
+	theStats.numEvents += num;
+
+	if (num > theStats.maxBatch)
+		theStats.maxBatch = num;
+
+	if (num && pHandler)
+		pHandler->OnEvents(theEvents, num);
+
+	if (changed)
+	{
+		chgParser.Reset();
+
+		uint16_t	rc = pPS->GetChanges(&chgParser);
+
+		if (rc != PTP_RC_OK)
+		{
+			theStats.numErrors ++;
+			ptp_error = rc;
+		}
+	}
+	return ptp_error;
+}
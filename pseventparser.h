@@ -0,0 +1,137 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PSEVENTPARSER_H__
+#define __PSEVENTPARSER_H__
+
+#include <Usb.h>
+#include <canonps.h>
+
+#define PS_EVENT_BATCH_SIZE			8		// events delivered to the handler at once
+#define PS_EVENT_DRAIN_TIME			20		// default drain time slot, ms
+
+// Event container as returned in the PS_OC_CheckEvent data stage
+struct PSEvent
+{
+	uint32_t	length;					// 12 + 4 * number of parameters
+	uint16_t	containerType;
+	uint16_t	eventCode;
+	uint32_t	transactionID;
+	uint32_t	params[3];
+
+	uint8_t NumParams() const { return (length > 12) ? (uint8_t)((length - 12) >> 2) : 0; };
+} __attribute__((packed));
+
+class PSEventHandlers
+{
+public:
+	// called once per drain with all the events received
+	virtual void OnEvents(const PSEvent *events, uint8_t num) = 0;
+	// called for every property reported by PS_OC_GetChanges
+	virtual void OnPropertyChanged(uint16_t prop __attribute__ ((unused))) {};
+};
+
+// Parses the response of one PS_OC_CheckEvent transaction, which carries
+// either one event or nothing.
+class PSEventParser : public PTPResettableParser
+{
+	uint8_t					nStage;
+	bool					bEvent;
+
+	MultiValueBuffer		theBuffer;
+	PSEvent					theEvent;
+
+	MultiByteValueParser	valueParser;
+	ByteSkipper				byteSkipper;
+
+public:
+	PSEventParser() : nStage(0), bEvent(false)
+	{
+		theBuffer.pValue = &theEvent;
+	};
+
+	virtual void Reset() { nStage = 0; bEvent = false; byteSkipper = ByteSkipper(); };
+
+	bool IsEvent() { return bEvent; };
+	const PSEvent* GetEvent() { return &theEvent; };
+	// handle of the object added, 0 if the event is not PTP_EC_ObjectAdded
+	uint32_t GetObjHandle() { return (bEvent && theEvent.eventCode == PTP_EC_ObjectAdded) ? theEvent.params[0] : 0; };
+
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+struct PSEventStats
+{
+	uint16_t	numDrains;
+	uint16_t	numChecks;				// PS_OC_CheckEvent transactions
+	uint16_t	numEvents;
+	uint16_t	numChanges;				// properties reported by PS_OC_GetChanges
+	uint16_t	numErrors;
+	uint8_t		maxBatch;				// most events in one drain
+	uint8_t		numCutShort;			// drains ended by the time slot or a full batch
+};
+
+// PS_OC_CheckEvent returns a single event, so a burst of events takes one
+// transaction each. Drain() keeps checking until the camera reports no event,
+// the batch is full or the time slot is over, and then hands the events to
+// the handler at once. On PS_EC_PropertyChanged only the changed properties
+// are fetched with PS_OC_GetChanges, instead of reading them all again.
+class PSEventDrain
+{
+	// PS_OC_GetChanges data stage, array of uint16_t property codes
+	class ChangesParser : public PTPReadParser
+	{
+		PSEventDrain			*pDrain;
+		uint8_t					nStage;
+		MultiValueBuffer		theBuffer;
+		uint32_t				varBuffer;
+		PTPListParser			listParser;
+		ByteSkipper				byteSkipper;
+
+		static void OnProperty(const MultiValueBuffer * const p, uint32_t count, const void *me);
+
+	public:
+		ChangesParser(PSEventDrain *drain) : pDrain(drain), nStage(0), varBuffer(0) { theBuffer.pValue = &varBuffer; };
+
+		void Reset()
+		{
+			nStage		= 0;
+			varBuffer	= 0;
+			byteSkipper	= ByteSkipper();
+			listParser.Initialize(4, 2, &theBuffer);
+		};
+		virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+	};
+
+	CanonPS				*pPS;
+	PSEventHandlers		*pHandler;
+	PSEventParser		evtParser;
+	ChangesParser		chgParser;
+
+	PSEvent				theEvents[PS_EVENT_BATCH_SIZE];
+	PSEventStats		theStats;
+
+public:
+	PSEventDrain(CanonPS *ps, PSEventHandlers *handler);
+
+	// Should be called once per poll slot from OnDeviceInitializedState
+	uint16_t Drain(uint16_t time_slot = PS_EVENT_DRAIN_TIME);
+
+	const PSEventStats* GetStats() { return &theStats; };
+	void ResetStats();
+};
+
+#endif // __PSEVENTPARSER_H__
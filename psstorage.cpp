@@ -0,0 +1,126 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "psstorage.h"
+
+void PSFolderEntryParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset __attribute__ ((unused)))
+{
+	uint8_t		*p	= (uint8_t*) pbuf;
+	uint16_t	cntdn	= len;
+
+	switch (nStage)
+	{
+	case 0:
+		// container length, the rest of the header is skipped
+		theBuffer.valueSize = 4;
+		valueParser.Initialize(&theBuffer);
+		nStage = 1;
+	case 1:
+		if (!valueParser.Parse(&p, &cntdn))
+			return;
+
+		{
+			uint32_t	total = *((uint32_t*)varBuffer);
+
+			numEntries		= (total > PTP_USB_BULK_HDR_LEN) ? (total - PTP_USB_BULK_HDR_LEN) / sizeof(PSFolderEntry) : 0;
+			entryCountdown	= numEntries;
+		}
+		nStage = 2;
+	case 2:
+		if (!byteSkipper.Skip(&p, &cntdn, PTP_USB_BULK_HDR_LEN - 4))
+			return;
+
+		theBuffer.valueSize = sizeof(PSFolderEntry);
+		valueParser.Initialize(&theBuffer);
+		nStage = 3;
+	case 3:
+		for (; entryCountdown; entryCountdown--)
+		{
+			if (!valueParser.Parse(&p, &cntdn))
+				return;
+
+			PSFolderEntry	*entry = (PSFolderEntry*)varBuffer;
+
+			entry->fileName[sizeof(entry->fileName) - 1] = 0;
+
+			if (pHandler)
+				pHandler->OnFolderEntry(entry);
+		}
+		nStage = 4;
+	}
+}
+
+void PSChunkedDownload::Setup(uint32_t handle, PTPReadParser *sink, uint32_t size, uint32_t offset, uint32_t chunk_size)
+{
+	pSink		= sink;
+	objHandle	= handle;
+	objSize		= size;
+	chunkSize	= chunk_size;
+	bytesDone	= offset;
+	chunkBytes	= 0;
+	numRetries	= 0;
+	bDone		= false;
+	lastError	= PTP_RC_OK;
+}
+
+uint16_t PSChunkedDownload::Failed(uint16_t rc)
+{
+	lastError = rc;
+
+	if (++numRetries >= PS_STORAGE_MAX_RETRIES)
+		bDone = true;
+
+	return rc;
+}
+
+uint16_t PSChunkedDownload::Step(PTP *ptp)
+{
+	CanonPS		*ps = (CanonPS*)ptp;
+	uint16_t	ptp_error;
+
+	if (!objSize)
+	{
+		if ((ptp_error = ps->GetObjectSize(objHandle, objSize)) != PTP_RC_OK)
+			return Failed(ptp_error);
+
+		numRetries = 0;
+
+		if (!objSize || bytesDone >= objSize)
+			bDone = true;
+
+		return ptp_error;
+	}
+	uint32_t	left	= objSize - bytesDone;
+	uint32_t	size	= (left < chunkSize) ? left : chunkSize;
+	uint32_t	pos		= (size == left) ? PS_PARTIAL_LAST : ((bytesDone) ? PS_PARTIAL_MIDDLE : PS_PARTIAL_FIRST);
+
+	chunkBytes = 0;
+
+	// the offset only moves on success, a failed chunk is fetched again on the next step
+	if ((ptp_error = ps->GetPartialObject(objHandle, bytesDone, size, pos, this)) != PTP_RC_OK)
+	{
+		PTPTRACE2("PS GetPartialObject error:", ptp_error);
+		return Failed(ptp_error);
+	}
+	numRetries	= 0;
+	lastError	= PTP_RC_OK;
+	bytesDone	+= chunkBytes;
+
+	if (!chunkBytes || bytesDone >= objSize)
+		bDone = true;
+
+	return ptp_error;
+}
@@ -0,0 +1,108 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PSSTORAGE_H__
+#define __PSSTORAGE_H__
+
+#include <canonps.h>
+#include <ptpsession.h>
+
+#define PS_STORAGE_CHUNK_SIZE		16384	// PS_OC_GetPartialObject chunk, bytes
+#define PS_STORAGE_MAX_RETRIES		3		// failed steps in a row before the download is given up
+
+// 28 byte PS_OC_GetFolderEntries record as sent by the camera
+struct PSFolderEntry
+{
+	uint32_t	objectHandle;
+	uint16_t	objectFormat;
+	uint8_t		flags;
+	uint32_t	objectSize;
+	uint32_t	timeStamp;				// Unix time
+	char		fileName[13];			// 8.3, zero terminated
+
+	bool IsFolder() const { return (objectFormat == PTP_OFC_Association); };
+} __attribute__((packed));
+
+class PSFolderEntryHandlers
+{
+public:
+	virtual void OnFolderEntry(const PSFolderEntry *entry) = 0;
+};
+
+// Streams PS_OC_GetFolderEntries data to the handler one entry at a time.
+// The number of entries comes from the container length.
+class PSFolderEntryParser : public PTPReadParser
+{
+	PSFolderEntryHandlers	*pHandler;
+
+	uint8_t					nStage;
+	uint16_t				numEntries;
+	uint16_t				entryCountdown;
+
+	MultiValueBuffer		theBuffer;
+	uint8_t					varBuffer[sizeof(PSFolderEntry)];
+
+	MultiByteValueParser	valueParser;
+	ByteSkipper				byteSkipper;
+
+public:
+	PSFolderEntryParser(PSFolderEntryHandlers *p) :
+		pHandler(p),
+		nStage(0),
+		numEntries(0),
+		entryCountdown(0)
+		{
+			theBuffer.pValue = varBuffer;
+		};
+
+	void Reset() { nStage = 0; numEntries = 0; };
+	uint16_t GetNumEntries() { return numEntries; };
+
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+// Object download in PS_OC_GetPartialObject chunks, PowerShot counterpart of
+// PTPChunkedDownload. The sink sees the same data stream as with a single
+// GetObject, the 12 byte container header included once at offset 0.
+//
+// A failed chunk is fetched again on the next step, the download is given up
+// after PS_STORAGE_MAX_RETRIES failures in a row. PTPSessionManager completes
+// a job on the first error, such a job can be submitted again and continues
+// where it stopped. Setup() with a non-zero offset continues an interrupted download,
+// the sink then gets data from that object offset on.
+class PSChunkedDownload : public PTPChunkedDownload
+{
+	uint8_t			numRetries;
+	uint16_t		lastError;
+
+	uint16_t Failed(uint16_t rc);
+
+public:
+	PSChunkedDownload() : numRetries(0), lastError(PTP_RC_OK) { chunkSize = PS_STORAGE_CHUNK_SIZE; };
+
+	// size 0 - unknown, taken from PS_OC_GetObjectSize on the first step
+	void Setup(uint32_t handle, PTPReadParser *sink, uint32_t size = 0, uint32_t offset = 0, uint32_t chunk_size = PS_STORAGE_CHUNK_SIZE);
+	void Abort() { bDone = true; };
+
+	uint32_t GetSize() { return objSize; };
+	// PTP_RC_OK if the whole object has been received
+	uint16_t GetResult() { return lastError; };
+
+	// PTPJob implementation, ptp has to be CanonPS
+	virtual uint16_t Step(PTP *ptp);
+};
+
+#endif // __PSSTORAGE_H__
@@ -0,0 +1,229 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "psviewfinder.h"
+
+void PSViewfinder::FrameParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+{
+	if (pSink)
+		pSink->Parse(len, pbuf, offset);
+
+	if (!pFrame)
+		return;
+
+	uint16_t	i = 0;
+
+	// container length comes first, little endian
+	for (; i < len && offset + i < 4; i++)
+		pFrame->imageSize |= (uint32_t)pbuf[i] << ((offset + i) << 3);
+
+	if (offset + len <= PTP_USB_BULK_HDR_LEN)
+		return;
+
+	if (offset < PTP_USB_BULK_HDR_LEN)
+		i = PTP_USB_BULK_HDR_LEN - offset;
+	else
+		i = 0;
+
+	uint32_t	pos = offset + i - PTP_USB_BULK_HDR_LEN;
+	uint16_t	n	= len - i;
+
+	if (pos >= pFrame->bufSize)
+		return;
+
+	if (pos + n > pFrame->bufSize)
+		n = pFrame->bufSize - pos;
+
+	memcpy(pFrame->pBuf + pos, pbuf + i, n);
+	pFrame->len = pos + n;
+}
+
+PSViewfinder::PSViewfinder(CanonPS *ps, PTPReadParser *sink) :
+	pPS(ps),
+	numBuffers(0),
+	theState(stIdle),
+	numErrorsInRow(0),
+	seqNum(0)
+{
+	frameParser.SetSink(sink);
+	memset(&theStats, 0, sizeof(theStats));
+}
+
+bool PSViewfinder::AddBuffer(uint8_t *buf, uint32_t size)
+{
+	if (numBuffers >= PS_VF_MAX_FRAMES || !buf || !size)
+		return false;
+
+	PSFrame		*frm = theFrames + numBuffers++;
+
+	frm->pBuf		= buf;
+	frm->bufSize	= size;
+	frm->len		= 0;
+	frm->imageSize	= 0;
+	frm->timeStamp	= 0;
+	frm->seqNum		= 0;
+	frm->state		= frFree;
+	return true;
+}
+
+uint16_t PSViewfinder::Start()
+{
+	uint16_t	ptp_error = pPS->ViewfinderOn();
+
+	if (ptp_error != PTP_RC_OK)
+		return ptp_error;
+
+	for (uint8_t i=0; i<numBuffers; i++)
+		theFrames[i].state = frFree;
+
+	readyFrames.Empty();
+
+	memset(&theStats, 0, sizeof(theStats));
+	theStats.latMin		= 0xFFFFFFFF;
+	theStats.timeStart	= millis();
+
+	seqNum			= 0;
+	numErrorsInRow	= 0;
+	theState		= stStreaming;
+
+	theBackOff.Reset();
+	return ptp_error;
+}
+
+void PSViewfinder::Finish()
+{
+	theState = stIdle;
+}
+
+uint16_t PSViewfinder::Stop()
+{
+	Finish();
+	return pPS->ViewfinderOff();
+}
+
+uint16_t PSViewfinder::GetFrameRate()
+{
+	uint32_t	elapsed = millis() - theStats.timeStart;
+
+	return PTPFrameRate(theStats.numFrames, elapsed);
+}
+
+// Returns a free buffer, the oldest ready frame if there is none
+PSFrame* PSViewfinder::FreeFrame()
+{
+	for (uint8_t i=0; i<numBuffers; i++)
+		if (theFrames[i].state == frFree)
+			return theFrames + i;
+
+	if (!readyFrames.Size())
+		return NULL;
+
+	theStats.numDropped ++;
+	return theFrames + readyFrames.Pop();
+}
+
+uint16_t PSViewfinder::Task()
+{
+	if (theState == stIdle)
+		return PTP_RC_OK;
+
+	if (!theBackOff.IsDue())
+		return PTP_RC_OK;
+
+	PSFrame		*frm = NULL;
+
+	// with no buffers the frames only go to the sink
+	if (numBuffers && !(frm = FreeFrame()))
+	{
+		theStats.numStalls ++;
+		return PTP_RC_OK;
+	}
+	if (frm)
+	{
+		frm->state		= frFilling;
+		frm->len		= 0;
+		frm->imageSize	= 0;
+	}
+	frameParser.SetFrame(frm);
+
+	uint32_t	t = micros();
+	uint16_t	ptp_error = pPS->GetViewfinderImage(&frameParser);
+
+	t = micros() - t;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("GetViewfinderImage error:", ptp_error);
+		theStats.numErrors ++;
+
+		if (frm)
+			frm->state = frFree;
+
+		if (++numErrorsInRow >= PS_VF_MAX_ERRORS)
+			Finish();
+
+		theBackOff.Failed();
+		return ptp_error;
+	}
+	numErrorsInRow	= 0;
+	theBackOff.Succeeded();
+
+	if (!theStats.numFrames)
+		theStats.latAvg = t;
+	else
+		theStats.latAvg += ((int32_t)t - (int32_t)theStats.latAvg) / PS_VF_LAT_DIVIDER;
+
+	theStats.numFrames ++;
+
+	if (t < theStats.latMin)
+		theStats.latMin = t;
+	if (t > theStats.latMax)
+		theStats.latMax = t;
+
+	seqNum ++;
+
+	if (frm)
+	{
+		// the container length includes the header
+		frm->imageSize	= (frm->imageSize > PTP_USB_BULK_HDR_LEN) ? frm->imageSize - PTP_USB_BULK_HDR_LEN : 0;
+		frm->timeStamp	= millis();
+		frm->seqNum		= seqNum;
+		frm->state		= frReady;
+
+		if (frm->IsTruncated())
+			theStats.numTruncated ++;
+
+		readyFrames.Push((uint8_t)(frm - theFrames));
+	}
+	return ptp_error;
+}
+
+const PSFrame* PSViewfinder::GetFrame()
+{
+	if (!readyFrames.Size())
+		return NULL;
+
+	PSFrame		*frm = theFrames + readyFrames.Pop();
+
+	frm->state = frTaken;
+	return frm;
+}
+
+void PSViewfinder::ReleaseFrame(const PSFrame *frame)
+{
+	if (frame >= theFrames && frame < theFrames + numBuffers)
+		((PSFrame*)frame)->state = frFree;
+}
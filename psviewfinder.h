@@ -0,0 +1,122 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PSVIEWFINDER_H__
+#define __PSVIEWFINDER_H__
+
+#include <canonps.h>
+#include <simplefifo.h>
+#include <ptppacing.h>
+
+#define PS_VF_MAX_FRAMES		4		// frame buffers in the pool
+#define PS_VF_MAX_ERRORS		8		// streaming stops after this many errors in a row
+#define PS_VF_LAT_DIVIDER		8		// latency average moves by 1/8 of the difference per frame
+
+// One viewfinder frame. The buffer is supplied by the application, JPEG data
+// exceeding it is dropped and the frame is marked as truncated.
+struct PSFrame
+{
+	uint8_t		*pBuf;
+	uint32_t	bufSize;
+	uint32_t	len;				// bytes of image data in the buffer
+	uint32_t	imageSize;			// image size reported by the camera
+	uint32_t	timeStamp;			// millis() when the frame was received
+	uint16_t	seqNum;				// frame number since Start()
+	uint8_t		state;
+
+	bool IsTruncated() const { return (len < imageSize); };
+};
+
+struct PSViewfinderStats
+{
+	uint32_t	numFrames;			// frames received
+	uint32_t	numDropped;			// frames overwritten before the application took them
+	uint32_t	numTruncated;		// frames larger than the buffer
+	uint32_t	numErrors;
+	uint32_t	numStalls;			// Task() calls with no buffer to fill
+	uint32_t	timeStart;			// millis() of Start()
+	uint32_t	latMin;				// GetViewfinderImage transaction time, us
+	uint32_t	latMax;
+	uint32_t	latAvg;				// running average, a sum would overflow within hours
+};
+
+// Streams PowerShot viewfinder frames back-to-back into a fixed pool of
+// frame buffers. A new frame is requested as soon as the previous one has
+// been received. When the application does not keep up, the oldest frame
+// which has not been taken yet is reused for the next one.
+class PSViewfinder
+{
+	enum { stIdle, stStreaming };
+	enum { frFree, frFilling, frReady, frTaken };
+
+	// Copies the data stage into a frame buffer, container header excluded
+	class FrameParser : public PTPReadParser
+	{
+		PSFrame			*pFrame;
+		PTPReadParser	*pSink;
+
+	public:
+		FrameParser() : pFrame(NULL), pSink(NULL) {};
+
+		void SetFrame(PSFrame *frame) { pFrame = frame; };
+		void SetSink(PTPReadParser *sink) { pSink = sink; };
+
+		virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+	};
+
+	CanonPS							*pPS;
+	FrameParser						frameParser;
+	PSFrame							theFrames[PS_VF_MAX_FRAMES];
+	SimpleFIFO<uint8_t, PS_VF_MAX_FRAMES + 1>	readyFrames;		// indices, oldest first
+
+	uint8_t							numBuffers;
+	uint8_t							theState;
+	uint8_t							numErrorsInRow;
+	PTPBackOff						theBackOff;
+	uint16_t						seqNum;
+
+	PSViewfinderStats				theStats;
+
+	PSFrame* FreeFrame();
+	void Finish();
+
+public:
+	PSViewfinder(CanonPS *ps, PTPReadParser *sink = NULL);
+
+	// Adds a frame buffer to the pool, returns false if the pool is full
+	bool AddBuffer(uint8_t *buf, uint32_t size);
+
+	uint16_t Start();
+	uint16_t Stop();
+	bool IsRunning() { return (theState != stIdle); };
+
+	// Should be called from OnDeviceInitializedState. Receives one frame per
+	// call and never blocks longer than one PTP transaction.
+	uint16_t Task();
+
+	// Oldest frame received, NULL if none. The frame stays with the
+	// application until ReleaseFrame() is called.
+	const PSFrame* GetFrame();
+	void ReleaseFrame(const PSFrame *frame);
+
+	const PSViewfinderStats* GetStats() { return &theStats; };
+	// frames per second multiplied by 100
+	uint16_t GetFrameRate();
+	// average transaction time in microseconds
+	uint32_t GetLatency() { return theStats.latAvg; };
+};
+
+#endif // __PSVIEWFINDER_H__
@@ -17,11 +17,13 @@ e-mail   :  support@circuitsathome.com
 #include "ptpconst.h"
 #include "ptp.h"
 #include "ptpdebug.h"
+#include "ptprecorder.h"
 
 void PTP::SetInitialState()
 {
 	idSession = 0;
 	idTransaction = ~((transaction_id_t)0);
+	opPending = 0;
 	SetState(PTP_STATE_SESSION_NOT_OPENED);
 }
 
@@ -80,7 +82,13 @@ PTP::PTP(USB *pusb, PTPStateHandlers *s) :
     stateMachine(s),
     devAddress(0),
     numConf(0),
-    pUsb(pusb)
+    pUsb(pusb),
+    pStats(NULL),
+    pTransport(NULL),
+    pRecorder(NULL),
+    pTxBuffer(NULL),
+    txBufferSize(0),
+    opPending(0)
 {
     // Control EP
     epInfo[0].epAddr = 0;
@@ -316,6 +324,7 @@ uint8_t PTP::Release()
 	devAddress = 0;
 	idSession = 0;
 	idTransaction = ~((transaction_id_t)0);
+	opPending = 0;
 
 	return 0;
 }
@@ -364,180 +373,252 @@ void PTP::Task()
 	}
 }
 
+uint8_t PTP::OutTransfer(uint8_t ep_index, uint16_t len, uint8_t *buf)
+{
+	uint8_t		rcode = (pTransport) ? pTransport->OutTransfer(ep_index, len, buf)
+									 : pUsb->outTransfer(devAddress, epInfo[ep_index].epAddr, len, buf);
+
+	if (pRecorder)
+		pRecorder->OnTransfer(ep_index, false, rcode, len, buf);
+
+	if (pStats && ep_index != epInterruptIndex)
+		pStats->OnTransfer(false, rcode, len);
+
+	return rcode;
+}
+
+uint8_t PTP::InTransfer(uint8_t ep_index, uint16_t *len, uint8_t *buf)
+{
+	uint8_t		rcode = (pTransport) ? pTransport->InTransfer(ep_index, len, buf)
+									 : pUsb->inTransfer(devAddress, epInfo[ep_index].epAddr, len, buf);
+
+	if (pRecorder)
+		pRecorder->OnTransfer(ep_index, true, rcode, *len, buf);
+
+	if (pStats && ep_index != epInterruptIndex)
+		pStats->OnTransfer(true, rcode, *len);
+
+	return rcode;
+}
+
 uint16_t PTP::Transaction(uint16_t opcode, OperFlags *flags, uint32_t *params = NULL, void *pVoid = NULL)
 {
-	uint8_t		rcode;
-	{   // send command block
-            // PTPTRACE("Transaction: Send Command\r\n");
-		uint8_t	cmd[PTP_USB_BULK_HDR_LEN + 12];		// header + 3 uint32_t parameters
+	if (!pStats)
+		return DoTransaction(opcode, flags, params, pVoid);
 
-		ZerroMemory(PTP_USB_BULK_HDR_LEN + 12, cmd);
+	pStats->Begin();
 
-		// Make command PTP container header
-		uint16_to_char(PTP_USB_CONTAINER_COMMAND, (unsigned char*)(cmd + PTP_CONTAINER_CONTYPE_OFF));	// type
-		uint16_to_char(opcode, (unsigned char*)(cmd + PTP_CONTAINER_OPCODE_OFF));			// code
-		uint32_to_char(++idTransaction,	(unsigned char*)(cmd + PTP_CONTAINER_TRANSID_OFF));		// transaction id
-		
-		uint8_t	n = flags->opParams;    // number of parameters
-                uint8_t len;
+	uint16_t	rc = DoTransaction(opcode, flags, params, pVoid);
 
-		if (params && *params ) {
-			*((uint8_t*)cmd) = PTP_USB_BULK_HDR_LEN + (n << 2);
-                        len = PTP_USB_BULK_HDR_LEN + (n << 2);
+	pStats->End(opcode, rc);
+	return rc;
+}
 
-			for (uint32_t *p1 = (uint32_t*)(cmd + PTP_CONTAINER_PAYLOAD_OFF), *p2 = (uint32_t*)params; n--; p1++, p2++) {
-				uint32_to_char(*p2, (unsigned char*)p1);
-                        }
-		}
-		else {
-			*((uint8_t*)cmd) = PTP_USB_BULK_HDR_LEN;
-                        len = PTP_USB_BULK_HDR_LEN;
-                }
-                
-		rcode = pUsb->outTransfer(devAddress, epInfo[epDataOutIndex].epAddr, len, cmd);
+uint16_t PTP::SendCommand(uint16_t opcode, OperFlags *flags, uint32_t *params)
+{
+	uint8_t	cmd[PTP_USB_BULK_HDR_LEN + 20];		// header + 5 uint32_t parameters
 
-		if (rcode) {
-			PTPTRACE2("Transaction: Command block send error", rcode);
-			return PTP_RC_GeneralError;
-		}
+	ZerroMemory(PTP_USB_BULK_HDR_LEN + 20, cmd);
+
+	// Make command PTP container header
+	uint16_to_char(PTP_USB_CONTAINER_COMMAND, (unsigned char*)(cmd + PTP_CONTAINER_CONTYPE_OFF));	// type
+	uint16_to_char(opcode, (unsigned char*)(cmd + PTP_CONTAINER_OPCODE_OFF));			// code
+	uint32_to_char(++idTransaction,	(unsigned char*)(cmd + PTP_CONTAINER_TRANSID_OFF));		// transaction id
+
+	PTPTRACEOP(opcode, idTransaction);
+
+	uint8_t	n = flags->opParams;    // number of parameters
+
+	if (n > 5)
+		n = 5;
+
+	uint8_t	len;
+
+	if (params && *params ) {
+		*((uint8_t*)cmd) = PTP_USB_BULK_HDR_LEN + (n << 2);
+		len = PTP_USB_BULK_HDR_LEN + (n << 2);
+
+		for (uint32_t *p1 = (uint32_t*)(cmd + PTP_CONTAINER_PAYLOAD_OFF), *p2 = (uint32_t*)params; n--; p1++, p2++)
+			uint32_to_char(*p2, (unsigned char*)p1);
 	}
-        
-        // return 0;
-        
-	{   // send data block
+	else {
+		*((uint8_t*)cmd) = PTP_USB_BULK_HDR_LEN;
+		len = PTP_USB_BULK_HDR_LEN;
+	}
+
+	uint8_t	rcode = OutTransfer(epDataOutIndex, len, cmd);
+
+	if (rcode) {
+		PTPTRACE2("Transaction: Command block send error", rcode);
+		return PTP_RC_GeneralError;
+	}
+	if (pStats)
+		pStats->CommandSent();
+
+	return PTP_RC_OK;
+}
+
+uint16_t PTP::DoTransaction(uint16_t opcode, OperFlags *flags, uint32_t *params, void *pVoid)
+{
+	uint16_t	ptp_error = SendCommand(opcode, flags, params);
+
+	if (ptp_error != PTP_RC_OK)
+		return ptp_error;
+
+	if (flags->txOperation) {   // send data block
 		uint8_t		data[PTP_MAX_RX_BUFFER_LEN];
-                uint32_t* pd32  = reinterpret_cast<uint32_t*>(data);
+		uint8_t		rcode;
 
-		if (flags->txOperation) {
-			if (flags->typeOfVoid && !pVoid)
-			{
-				PTPTRACE("Transaction: pVoid is NULL\n");
-				return PTP_RC_GeneralError;
-			}
-			ZerroMemory(PTP_MAX_RX_BUFFER_LEN, data);
+		if (flags->typeOfVoid && !pVoid)
+		{
+			PTPTRACE("Transaction: pVoid is NULL\n");
+			return PTP_RC_GeneralError;
+		}
+		ZerroMemory(PTP_MAX_RX_BUFFER_LEN, data);
 
-			uint32_t bytes_left = (flags->typeOfVoid == 3) ? PTP_USB_BULK_HDR_LEN + flags->dataSize :
-					      ((flags->typeOfVoid == 1) ? PTP_USB_BULK_HDR_LEN + ((PTPDataSupplier*)pVoid)->GetDataSize() : 12);
+		// suppliers fill the large buffer if there is one, several packets per transfer
+		bool		tx_large	= (flags->typeOfVoid == 1 && pTxBuffer && txBufferSize > PTP_USB_BULK_HDR_LEN);
+		uint8_t		*tx_buf		= (tx_large) ? pTxBuffer : data;
+		uint16_t	tx_size		= (tx_large) ? txBufferSize : PTP_MAX_RX_BUFFER_LEN;
+
+		uint32_t bytes_left = (flags->typeOfVoid == 3) ? PTP_USB_BULK_HDR_LEN + flags->dataSize :
+				      ((flags->typeOfVoid == 1) ? PTP_USB_BULK_HDR_LEN + ((PTPDataSupplier*)pVoid)->GetDataSize() : 12);
                         
                         PTPTRACE2("Data block: Bytes Left ", bytes_left);
 
-			// Make data PTP container header
-			*pd32 = bytes_left;
-			uint16_to_char(PTP_USB_CONTAINER_DATA,	(unsigned char*)(data + PTP_CONTAINER_CONTYPE_OFF));	// type
-			uint16_to_char(opcode, (unsigned char*)(data + PTP_CONTAINER_OPCODE_OFF));			// code
-			uint32_to_char(idTransaction, (unsigned char*)(data + PTP_CONTAINER_TRANSID_OFF));		// transaction id
+		// Make data PTP container header
+		uint32_to_char(bytes_left, (unsigned char*)tx_buf);							// length
+		uint16_to_char(PTP_USB_CONTAINER_DATA,	(unsigned char*)(tx_buf + PTP_CONTAINER_CONTYPE_OFF));	// type
+		uint16_to_char(opcode, (unsigned char*)(tx_buf + PTP_CONTAINER_OPCODE_OFF));			// code
+		uint32_to_char(idTransaction, (unsigned char*)(tx_buf + PTP_CONTAINER_TRANSID_OFF));		// transaction id
 
-			uint16_t len = 0;
+		uint16_t len = 0;
 
-			if (flags->typeOfVoid == 1) {
-				len = (bytes_left < PTP_MAX_RX_BUFFER_LEN) ? bytes_left : PTP_MAX_RX_BUFFER_LEN;
+		if (flags->typeOfVoid == 1) {
+			len = (bytes_left < tx_size) ? bytes_left : tx_size;
                         }
-			
-			if (flags->typeOfVoid == 3) {
-				uint8_t		*p1 = (data + PTP_USB_BULK_HDR_LEN);
-				uint8_t		*p2 = (uint8_t*)pVoid;
+		
+		if (flags->typeOfVoid == 3) {
+			uint8_t		*p1 = (data + PTP_USB_BULK_HDR_LEN);
+			uint8_t		*p2 = (uint8_t*)pVoid;
 
-				for (uint8_t i=flags->dataSize; i; i--, p1++, p2++)
-					*p1 = *p2;
+			for (uint8_t i=flags->dataSize; i; i--, p1++, p2++)
+				*p1 = *p2;
 
-				len = PTP_USB_BULK_HDR_LEN + flags->dataSize;
-			} // if (flags->typeOfVoid == 3...
+			len = PTP_USB_BULK_HDR_LEN + flags->dataSize;
+		} // if (flags->typeOfVoid == 3...
                         
-			bool first_time = true;
+		bool first_time = true;
 
-			while (bytes_left) {
-				if (flags->typeOfVoid == 1)
-					((PTPDataSupplier*)pVoid)->GetData(	(first_time) ? len - PTP_USB_BULK_HDR_LEN : len, 
-														(first_time) ? (data + PTP_USB_BULK_HDR_LEN) : data);
-				
-				rcode = pUsb->outTransfer(devAddress, epInfo[epDataOutIndex].epAddr, len, data);
+		while (bytes_left) {
+			if (flags->typeOfVoid == 1)
+				((PTPDataSupplier*)pVoid)->GetData(	(first_time) ? len - PTP_USB_BULK_HDR_LEN : len, 
+													(first_time) ? (tx_buf + PTP_USB_BULK_HDR_LEN) : tx_buf);
+			
+			rcode = OutTransfer(epDataOutIndex, len, tx_buf);
 
-				if (rcode) {
-					PTPTRACE2("Transaction: Data block send error.", rcode);
-					return PTP_RC_GeneralError;
-				}
+			if (rcode) {
+				PTPTRACE2("Transaction: Data block send error.", rcode);
+				return PTP_RC_GeneralError;
+			}
 
-				bytes_left -= len;
+			bytes_left -= len;
 
-				len = (bytes_left < PTP_MAX_RX_BUFFER_LEN) ? bytes_left : PTP_MAX_RX_BUFFER_LEN;
+			len = (bytes_left < tx_size) ? bytes_left : tx_size;
 
-				first_time = false;
-			} // while(bytes_left...
-		} // if (flags->txOperation...
+			first_time = false;
+		} // while(bytes_left...
 
-		// Because inTransfer does not return the actual number of bytes received, it should be 
-		// calculated here.
-		uint32_t	total = 0, data_off = 0; 	// Total PTP data packet size, Data offset
-		uint8_t		inbuffer = 0;			// Number of bytes read into buffer
-		uint16_t	loops = 0;			// Number of loops necessary to get all the data from device
-		// uint8_t		timeoutcnt = 0;
+		if (pStats)
+			pStats->DataTransferred();
+	} // if (flags->txOperation...
 
-		while (1)
-		{
-			ZerroMemory(PTP_MAX_RX_BUFFER_LEN, data);
+	return ReceiveResponse(flags, params, pVoid);
+}
 
-			uint16_t	read = PTP_MAX_RX_BUFFER_LEN;
+uint16_t PTP::ReceiveResponse(OperFlags *flags, uint32_t *params, void *pVoid)
+{
+	uint8_t		data[PTP_MAX_RX_BUFFER_LEN];
+	uint32_t	*pd32 = reinterpret_cast<uint32_t*>(data);
+	uint8_t		rcode;
+
+	// Because inTransfer does not return the actual number of bytes received, it should be 
+	// calculated here.
+	uint32_t	total = 0, data_off = 0; 	// Total PTP data packet size, Data offset
+	uint8_t		inbuffer = 0;			// Number of bytes read into buffer
+	uint16_t	loops = 0;			// Number of loops necessary to get all the data from device
+	// uint8_t		timeoutcnt = 0;
+
+	while (1)
+	{
+		ZerroMemory(PTP_MAX_RX_BUFFER_LEN, data);
+
+		uint16_t	read = PTP_MAX_RX_BUFFER_LEN;
                         
-			rcode = pUsb->inTransfer(devAddress, epInfo[epDataInIndex].epAddr, &read, data);
+		rcode = InTransfer(epDataInIndex, &read, data);
 
-			if (rcode)
-			{
-				PTPTRACE("Fatal USB Error\r\n");
+		if (rcode)
+		{
+			PTPTRACE("Fatal USB Error\r\n");
 
-				// in some cases NAK handling might be necessary
-				PTPTRACE2("Transaction: Response receive error 1", rcode);
-				return PTP_RC_GeneralError;
-			}
+			// in some cases NAK handling might be necessary
+			PTPTRACE2("Transaction: Response receive error 1", rcode);
+			return PTP_RC_GeneralError;
+		}
+
+		// This can occur in case of unsupported operation or successive response after data reception stage
+		if ((!loops || total == data_off) && *((uint16_t*)(data + PTP_CONTAINER_CONTYPE_OFF)) == PTP_USB_CONTAINER_RESPONSE)
+		{
+			uint16_t	response = *((uint16_t*)(data + PTP_CONTAINER_OPCODE_OFF));
 
-			// This can occur in case of unsupported operation or successive response after data reception stage
-			if ((!loops || total == data_off) && *((uint16_t*)(data + PTP_CONTAINER_CONTYPE_OFF)) == PTP_USB_CONTAINER_RESPONSE)
+			if (response == PTP_RC_OK && *pd32 > PTP_USB_BULK_HDR_LEN)
 			{
-				uint16_t	response = *((uint16_t*)(data + PTP_CONTAINER_OPCODE_OFF));
-
-				if (response == PTP_RC_OK && *pd32 > PTP_USB_BULK_HDR_LEN)
-				{
-					// number of params = (container length - 12) / 4
-					uint8_t	n = (*pd32 - PTP_USB_BULK_HDR_LEN) >> 2;
-
-					// BUG: n should be checked!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-					flags->rsParams = n;
-					
-					for (uint32_t *p1 = (uint32_t*)(data + PTP_USB_BULK_HDR_LEN), *p2 = (uint32_t*)params; n; n--, p1++, p2++)
-						p2 = p1;
-				}
-				if (response != PTP_RC_OK)
-				{
-					PTPTRACE2("Transaction: Response receive error 2", response);
-					data_off = 0;
-				}
-				return response;
-			}
+				// number of params = (container length - 12) / 4
+				uint8_t	n = (*pd32 - PTP_USB_BULK_HDR_LEN) >> 2;
+
+				// no more than the caller expects, params has room for that many
+				uint8_t	ncopy = (n < flags->rsParams) ? n : flags->rsParams;
 
-			if (loops == 0)
+				flags->rsParams = n;
+
+				if (params)
+					for (uint32_t *p1 = (uint32_t*)(data + PTP_USB_BULK_HDR_LEN), *p2 = (uint32_t*)params; ncopy; ncopy--, p1++, p2++)
+						*p2 = *p1;
+			}
+			if (response != PTP_RC_OK)
 			{
-				total		=	*pd32;
-				inbuffer	=	(total < PTP_MAX_RX_BUFFER_LEN) ? (uint8_t)total : PTP_MAX_RX_BUFFER_LEN;
+				PTPTRACE2("Transaction: Response receive error 2", response);
+				data_off = 0;
 			}
-			else
-				inbuffer = ((total - data_off) > PTP_MAX_RX_BUFFER_LEN) ? PTP_MAX_RX_BUFFER_LEN : (uint8_t)(total - data_off);
+			return response;
+		}
 
-			if (pVoid)
-			{
-				if (flags->typeOfVoid == 0x01)
-					((PTPReadParser*)pVoid)->Parse(inbuffer, data, (const uint32_t&)data_off);
+		if (loops == 0)
+		{
+			total		=	*pd32;
+			inbuffer	=	(total < PTP_MAX_RX_BUFFER_LEN) ? (uint8_t)total : PTP_MAX_RX_BUFFER_LEN;
+		}
+		else
+			inbuffer = ((total - data_off) > PTP_MAX_RX_BUFFER_LEN) ? PTP_MAX_RX_BUFFER_LEN : (uint8_t)(total - data_off);
 
-				if (flags->typeOfVoid == 0x03)
-					for (uint32_t i=0, j=data_off; i<inbuffer && j<flags->dataSize; i++, j++)
-						((uint8_t*)pVoid)[j] = data[i];
-			}
-			data_off += inbuffer;
+		if (pVoid)
+		{
+			if (flags->typeOfVoid == 0x01)
+				((PTPReadParser*)pVoid)->Parse(inbuffer, data, (const uint32_t&)data_off);
 
-			loops ++;
-			//delay(10);
-		} // while(1)
-	} // end of scope
-}
+			if (flags->typeOfVoid == 0x03)
+				for (uint32_t i=0, j=data_off; i<inbuffer && j<flags->dataSize; i++, j++)
+					((uint8_t*)pVoid)[j] = data[i];
+		}
+		data_off += inbuffer;
+
+		if (pStats)
+			pStats->DataTransferred();
 
+		loops ++;
+		//delay(10);
+	} // while(1)
+}
 
 uint16_t PTP::EventCheck(PTPReadParser *pParser)
 {
@@ -558,7 +639,7 @@ uint16_t PTP::EventCheck(PTPReadParser *pParser)
 
 		uint16_t read = sizeof(PTPUSBEventContainer);
                 
-		rcode = pUsb->inTransfer(devAddress, epInfo[epInterruptIndex].epAddr, &read, data);
+		rcode = InTransfer(epInterruptIndex, &read, data);
 
 		switch (rcode) {
 		
@@ -624,7 +705,7 @@ bool PTP::CheckEvent(uint8_t size, uint8_t *buf)
 
 	uint16_t	read = size;
         
-	uint8_t rcode = pUsb->inTransfer(devAddress, epInfo[epInterruptIndex].epAddr, &read, buf);
+	uint8_t rcode = InTransfer(epInterruptIndex, &read, buf);
 
 	// if no interrupts pending - return false
 
@@ -675,15 +756,16 @@ uint16_t PTP::ResetDevice()
 	return Transaction(PTP_OC_ResetDevice, &flags);
 }
 
-uint16_t PTP::GetNumObjects(uint32_t &retval,
-        uint32_t storage_id __attribute__ ((unused)),
-        uint16_t format __attribute__ ((unused)),
-        uint32_t assoc __attribute__ ((unused)))
+uint16_t PTP::GetNumObjects(uint32_t &retval, uint32_t storage_id, uint16_t format, uint32_t assoc)
 {
 	uint16_t	ptp_error = PTP_RC_GeneralError;
 	OperFlags	flags = { 3, 1, 0, 0, 0, 0 };
 	uint32_t	params[3];
 
+	params[0] = storage_id;
+	params[1] = (uint32_t)format;
+	params[2] = assoc;
+
 	if ( (ptp_error = Transaction(PTP_OC_GetNumObjects, &flags, params)) == PTP_RC_OK)
 		retval = params[0];
 
@@ -700,6 +782,18 @@ uint16_t PTP::GetObject(uint32_t handle, PTPReadParser *parser)
 	return Transaction(PTP_OC_GetObject, &flags, params, parser);
 }
 
+uint16_t PTP::GetPartialObject(uint32_t handle, uint32_t offset, uint32_t size, PTPReadParser *parser)
+{
+	OperFlags	flags = { 3, 0, 0, 1, 1, 0 };
+	uint32_t	params[3];
+
+	params[0] = handle;
+	params[1] = offset;
+	params[2] = size;
+
+	return Transaction(PTP_OC_GetPartialObject, &flags, params, parser);
+}
+
 uint16_t PTP::GetThumb(uint32_t handle, PTPReadParser *parser)
 {
 	OperFlags	flags = { 1, 0, 0, 1, 1, 0 };
@@ -735,7 +829,7 @@ uint16_t PTP::SetObjectProtection(uint32_t handle, uint16_t attrib)
 uint16_t PTP::MoveObject(uint32_t handle, uint32_t storage_id, uint32_t parent)
 {
 	OperFlags	flags = { 3, 0, 0, 0, 0, 0 };
-	uint32_t	params[2];
+	uint32_t	params[3];
 
 	params[0] = handle;
 	params[1] = storage_id;
@@ -1055,6 +1149,47 @@ uint16_t PTP::Operation(uint16_t opcode, uint8_t nparams, uint32_t *params)
 	return Transaction(opcode, &flags, params);
 }
 
+uint16_t PTP::BeginOperation(uint16_t opcode, uint8_t nparams, uint32_t *params)
+{
+	OperFlags	flags		= { 0, 0, 0, 0, 0, 0 };
+
+	if (opPending)
+		return PTP_RC_DeviceBusy;
+
+	flags.opParams = nparams;
+
+	if (pStats)
+		pStats->Begin();
+
+	uint16_t	ptp_error = SendCommand(opcode, &flags, params);
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		if (pStats)
+			pStats->End(opcode, ptp_error);
+
+		return ptp_error;
+	}
+	opPending = opcode;
+	return PTP_RC_OK;
+}
+
+uint16_t PTP::EndOperation()
+{
+	OperFlags	flags		= { 0, 0, 0, 0, 0, 0 };
+
+	if (!opPending)
+		return PTP_RC_GeneralError;
+
+	uint16_t	ptp_error = ReceiveResponse(&flags, NULL, NULL);
+
+	if (pStats)
+		pStats->End(opPending, ptp_error);
+
+	opPending = 0;
+	return ptp_error;
+}
+
 uint16_t PTP::GetStorageInfo(uint32_t storage_id, PTPReadParser *parser)
 {
 	OperFlags	flags		= { 1, 0, 0, 1, 1, 0 };
@@ -1151,39 +1286,30 @@ uint16_t PTP::GetObjectHandles(uint32_t storage_id, uint16_t format, uint16_t as
 	return Transaction(PTP_OC_GetObjectHandles, &flags, params, parser);
 }
 
-uint16_t PTP::SendObjectInfo(uint32_t handle, PTPDataSupplier *sup)
+uint16_t PTP::SendObjectInfo(uint32_t storage_id, uint32_t parent, PTPDataSupplier *sup, uint32_t &handle)
 {
-	(void)handle;
-        // (void)sup;
-        
-        uint16_t ptp_error = PTP_RC_GeneralError;
-   
-        OperFlags flags = { 0, 3, 1, 1, 1, 0/* sup->GetDataSize() */};
-	uint32_t params[3];
-	
-	uint32_t store;
-        uint32_t parenthandle;
-        
-        (void)store;
-        (void)parenthandle;
-              
+	uint16_t	ptp_error	= PTP_RC_GeneralError;
+	OperFlags	flags		= { 2, 3, 1, 1, 1, 0 };
 
-	params[0] = 0x00001001; // destination StorageID
-	params[1] = 0; // Parent ObjectHandle
+	uint32_t	params[3];
+	params[0]	= storage_id;
+	params[1]	= parent;
+	params[2]	= 0;
 
-	if ((ptp_error = Transaction(PTP_OC_SendObjectInfo, &flags, params, sup)) == PTP_RC_OK) {
-            store = params[0];              // Responder StorageID in which object will be stored
-            parenthandle = params[1];       // Responder Parent ObjectHandle in which the object will be stored
-            handle = params[2];             // Responder's reserved ObjectHandle for the incoming object
-	}
+	// the response holds the storage, the parent and the handle reserved for the object
+	if ((ptp_error = Transaction(PTP_OC_SendObjectInfo, &flags, params, sup)) == PTP_RC_OK)
+	{
+		if (flags.rsParams < 3)
+			return PTP_RC_GeneralError;
 
+		handle = params[2];
+	}
 	return ptp_error;
 }
 
-uint16_t PTP::SendObject(uint32_t handle, PTPDataSupplier *sup) {
-        (void)handle;
-        
-	OperFlags flags = { 0, 0, 1, 1, 3, 0 /* sup->GetDataSize() */ };
+uint16_t PTP::SendObject(PTPDataSupplier *sup)
+{
+	OperFlags	flags		= { 0, 0, 1, 1, 1, 0 };
 
 	return Transaction(PTP_OC_SendObject, &flags, NULL, sup);
 }
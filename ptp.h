@@ -22,6 +22,8 @@ e-mail   :  support@circuitsathome.com
 #include "ptpmsgstr.h"
 #include "ptpdebug.h"
 #include "ptpcallback.h"
+#include "ptpstats.h"
+#include "ptptransport.h"
 
 // Buffer size should NEVER be less than USB packet size!!!!!!!!!!!!!!!!!!!!!
 #define PTP_MAX_RX_BUFFER_LEN	64
@@ -40,6 +42,7 @@ e-mail   :  support@circuitsathome.com
 class PTP;
 class PTPReadParser;
 class PTPDataSupplier;
+class PTPRecorder;
 
 class PTPStateHandlers
 {
@@ -81,6 +84,15 @@ protected:
 
 	EpInfo epInfo[4];
 
+	PTPStats			*pStats;				// transaction statistics, may be NULL
+	PTPTransport		*pTransport;			// replaces the USB host for pipe transfers if not NULL
+	PTPRecorder			*pRecorder;				// gets a copy of every pipe transfer, may be NULL
+
+	uint8_t				*pTxBuffer;				// data-out stages of PTPDataSupplier go through it if not NULL
+	uint16_t			txBufferSize;
+
+	uint16_t			opPending;				// opcode sent by BeginOperation(), 0 if none
+
 	struct OperFlags
 	{
 		uint16_t	opParams	:	3;			// 7 - maximum number of operation parameters
@@ -106,6 +118,15 @@ protected:
 	// the actual data is stored in a buffer pointed by buf
 	bool CheckEvent(uint8_t size, uint8_t *buf);
 
+	// All bulk and interrupt pipe traffic goes through these two
+	uint8_t OutTransfer(uint8_t ep_index, uint16_t len, uint8_t *buf);
+	uint8_t InTransfer(uint8_t ep_index, uint16_t *len, uint8_t *buf);
+
+	// The command stage and the data-in and response stages of a transaction
+	uint16_t SendCommand(uint16_t opcode, OperFlags *flags, uint32_t *params);
+	uint16_t ReceiveResponse(OperFlags *flags, uint32_t *params, void *pVoid);
+
+	uint16_t DoTransaction(uint16_t opcode, OperFlags *flags, uint32_t *params, void *pVoid);
 	uint16_t Transaction(uint16_t opcode, OperFlags *flags, uint32_t *params, void *pVoid);
 
 public:
@@ -118,6 +139,14 @@ public:
 	virtual uint8_t GetAddress() { return devAddress; };
 
 	void SetState(uint8_t state) { theState = state; };
+
+	void SetStats(PTPStats *stats) { pStats = stats; };
+	PTPStats* GetStats() { return pStats; };
+	void SetTransport(PTPTransport *transport) { pTransport = transport; };
+	void SetRecorder(PTPRecorder *recorder) { pRecorder = recorder; };
+	// Data-out stages are sent in chunks of the buffer size instead of 64 bytes, each
+	// filled by one GetData() call. Use a multiple of the packet size, NULL restores the default.
+	void SetTxBuffer(uint8_t *buf, uint16_t size) { pTxBuffer = buf; txBufferSize = size; };
 	uint8_t GetState() { return theState; };
 
 	virtual uint16_t EventCheck(PTPReadParser *parser);
@@ -125,6 +154,12 @@ public:
 	// Simple PTP operation which has no data stage. Any number of uint32_t params can be supplied.
 	uint16_t Operation(uint16_t opcode, uint8_t nparams = 0, uint32_t *params = NULL);
 
+	// The same operation split in two. BeginOperation() sends the command and returns,
+	// EndOperation() waits for the response. No other transaction may go to the camera
+	// in between. Lets one host send commands to several cameras before any of them answers.
+	uint16_t BeginOperation(uint16_t opcode, uint8_t nparams = 0, uint32_t *params = NULL);
+	uint16_t EndOperation();
+
 	uint16_t CaptureImage();
 
 	uint16_t OpenSession();
@@ -156,6 +191,7 @@ public:
         uint16_t GetObjectPropValue(uint32_t handle, uint32_t prop, PTPReadParser* parser);
 	uint16_t FormatStore(uint32_t storage_id, uint32_t fsformat);
 	uint16_t GetObject(uint32_t handle, PTPReadParser *parser);
+	uint16_t GetPartialObject(uint32_t handle, uint32_t offset, uint32_t size, PTPReadParser *parser);
 	uint16_t GetThumb(uint32_t handle, PTPReadParser *parser);
 
 	uint16_t GetNumObjects(uint32_t &retval, uint32_t storage_id = 0xffffffff, uint16_t format = 0, uint32_t assoc = 0);
@@ -167,12 +203,10 @@ public:
 	uint16_t TerminateOpenCapture(uint32_t trans_id);
 	uint16_t InitiateCapture(uint32_t storage_id = 0, uint16_t format = 0);
 
-        
-        uint16_t SendObjectInfo(uint32_t handle, PTPDataSupplier *sup);
-	uint16_t SendObject(uint32_t handle, PTPDataSupplier *sup);
-        
-	// To be implemented in future releases
-	//uint16_t GetPartialObject(uint32_t handle, PTPReadParser *parser);
+	// storage_id and parent 0 leave the choice to the camera, parent is sent only along
+	// with storage_id. handle receives the one reserved for the object, SendObject has to follow.
+	uint16_t SendObjectInfo(uint32_t storage_id, uint32_t parent, PTPDataSupplier *sup, uint32_t &handle);
+	uint16_t SendObject(PTPDataSupplier *sup);
 };
 
 #endif // __PTP_H__
\ No newline at end of file
@@ -0,0 +1,157 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpblocksink.h"
+#include "ptpconst.h"
+
+bool PTPBlockSink::Start(uint32_t size)
+{
+	curBuffer	= 0;
+	fillPos		= 0;
+	bPending	= false;
+	bError		= false;
+	objSize		= size;
+	numBytes	= 0;
+
+	theStats.numBlocks		= 0;
+	theStats.numDropped		= 0;
+	theStats.timeWrite		= 0;
+	theStats.timeWriteUs	= 0;
+	theStats.maxWrite		= 0;
+	theStats.timeStart		= millis();
+	theStats.timeEnd		= theStats.timeStart;
+
+	if (size && !pWriter->Reserve(size))
+		bError = true;
+
+	return !bError;
+}
+
+// Microsecond sums would wrap after 71 minutes, the sum is kept in
+// milliseconds and the rest carried over
+void PTPBlockSink::AddWriteTime(uint32_t t)
+{
+	uint32_t	us = theStats.timeWriteUs + t % 1000;
+
+	theStats.timeWrite		+= t / 1000 + us / 1000;
+	theStats.timeWriteUs	= us % 1000;
+}
+
+// Waits for the write of the other buffer, then hands over the current one
+bool PTPBlockSink::Flush()
+{
+	uint32_t	t = micros();
+
+	if (bPending && !pWriter->Wait())
+		bError = true;
+
+	if (!bError && !pWriter->Write(theBuffers[curBuffer], fillPos))
+		bError = true;
+
+	t = micros() - t;
+
+	AddWriteTime(t);
+
+	if (t > theStats.maxWrite)
+		theStats.maxWrite = t;
+
+	theStats.numBlocks ++;
+
+	bPending	= true;
+	curBuffer	^= 1;
+	fillPos		= 0;
+
+	return !bError;
+}
+
+bool PTPBlockSink::Finish()
+{
+	if (!bError && fillPos)
+		Flush();
+
+	uint32_t	t = micros();
+
+	if (bPending && !pWriter->Wait())
+		bError = true;
+
+	bPending = false;
+
+	if (!pWriter->Close(numBytes))
+		bError = true;
+
+	AddWriteTime(micros() - t);
+	theStats.timeEnd = millis();
+
+	return !bError;
+}
+
+uint32_t PTPBlockSink::GetRate()
+{
+	uint32_t	elapsed = theStats.timeEnd - theStats.timeStart;
+
+	return (elapsed) ? (uint32_t)((uint64_t)numBytes * 1000 / 1024 / elapsed) : 0;
+}
+
+uint32_t PTPBlockSink::GetWriteRate()
+{
+	uint64_t	us = (uint64_t)theStats.timeWrite * 1000 + theStats.timeWriteUs;
+
+	return (us) ? (uint32_t)((uint64_t)numBytes * 1000000 / 1024 / us) : 0;
+}
+
+void PTPBlockSink::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+{
+	// object offset of the first byte, the first chunk starts with the container header
+	uint32_t		pos		= (offset) ? offset - PTP_USB_BULK_HDR_LEN : 0;
+	uint16_t		skip	= (offset) ? 0 : PTP_USB_BULK_HDR_LEN;
+
+	if (bError || len <= skip)
+		return;
+
+	// data missing in between, the file would be corrupt
+	if (pos > numBytes)
+	{
+		bError = true;
+		return;
+	}
+	// a chunk fetched again after an error, the bytes before numBytes are stored already
+	if (pos + (len - skip) <= numBytes)
+	{
+		theStats.numDropped ++;
+		return;
+	}
+	const uint8_t	*p		= pbuf + skip + (numBytes - pos);
+	uint16_t		left	= (uint16_t)(len - skip - (numBytes - pos));
+
+	numBytes += left;
+
+	while (left)
+	{
+		uint16_t	n = PTP_BLOCK_SIZE - fillPos;
+
+		if (n > left)
+			n = left;
+
+		memcpy(theBuffers[curBuffer] + fillPos, p, n);
+
+		fillPos	+= n;
+		p		+= n;
+		left	-= n;
+
+		if (fillPos == PTP_BLOCK_SIZE && !Flush())
+			return;
+	}
+}
@@ -0,0 +1,110 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPBLOCKSINK_H__
+#define __PTPBLOCKSINK_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include "ptpcallback.h"
+
+// Both buffers are kept in RAM, 1 KB with the default SD card sector size
+#ifndef PTP_BLOCK_SIZE
+#define PTP_BLOCK_SIZE			512
+#endif
+
+// Buffer alignment, O_DIRECT writers need it equal to the block size
+#ifndef PTP_BLOCK_ALIGN
+#define PTP_BLOCK_ALIGN			4
+#endif
+
+// Storage behind PTPBlockSink. Write() gets whole blocks, only the last one
+// of a file may be shorter. A writer able to work in the background (DMA,
+// a write queue) may return before the block is stored, the sink calls
+// Wait() before it touches the buffer again and keeps filling the other
+// one meanwhile. Returning false stops the writing.
+class PTPBlockWriter
+{
+public:
+	// called with the object size before the first block if the size is known
+	virtual bool Reserve(uint32_t size __attribute__ ((unused))) { return true; };
+	virtual bool Write(const uint8_t *pbuf, uint16_t len) = 0;
+	virtual bool Wait() { return true; };
+	// size is the number of bytes written
+	virtual bool Close(uint32_t size __attribute__ ((unused))) { return true; };
+};
+
+struct PTPBlockSinkStats
+{
+	uint32_t	numBlocks;			// blocks handed to the writer
+	uint16_t	numDropped;			// chunks behind the written data, sent again after an error
+	uint32_t	timeStart;			// millis() of Start()
+	uint32_t	timeEnd;			// millis() of Finish()
+	uint32_t	timeWrite;			// milliseconds spent in the writer
+	uint16_t	timeWriteUs;		// and the microseconds below one millisecond
+	uint32_t	maxWrite;			// longest single Write() and Wait(), microseconds
+};
+
+// Download sink which collects the data stage chunks of GetObject,
+// GetPartialObject or a chunked download into blocks of PTP_BLOCK_SIZE
+// bytes, so the storage sees aligned writes of its native size instead of
+// a stream of 64 byte pieces. Start() before the transfer, Finish() after
+// it to write the rest and close the file.
+class PTPBlockSink : public PTPReadParser
+{
+	PTPBlockWriter		*pWriter;
+
+	uint8_t				theBuffers[2][PTP_BLOCK_SIZE] __attribute__ ((aligned (PTP_BLOCK_ALIGN)));
+	uint8_t				curBuffer;
+	uint16_t			fillPos;
+	bool				bPending;			// a write of the other buffer may still be in progress
+	bool				bError;
+
+	uint32_t			objSize;
+	uint32_t			numBytes;			// object bytes received
+
+	PTPBlockSinkStats	theStats;
+
+	bool Flush();
+	void AddWriteTime(uint32_t t);
+
+public:
+	PTPBlockSink(PTPBlockWriter *writer) : pWriter(writer), curBuffer(0), fillPos(0), bPending(false), bError(false), objSize(0), numBytes(0) {};
+
+	// size 0 - unknown, no space reserved
+	bool Start(uint32_t size = 0);
+	bool Finish();
+
+	// false once the writer has failed, the rest of the transfer is ignored
+	bool IsOK() { return !bError; };
+	uint32_t GetSize() { return numBytes; };
+
+	const PTPBlockSinkStats* GetStats() { return &theStats; };
+	// kilobytes per second from Start() to Finish(), transfer and storage
+	uint32_t GetRate();
+	// kilobytes per second of the writer alone
+	uint32_t GetWriteRate();
+
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+#endif // __PTPBLOCKSINK_H__
@@ -26,6 +26,14 @@ public:
 	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset) = 0;
 };
 
+// Parser kept across transactions, which has to be brought back to its initial
+// state before the next one starts
+class PTPResettableParser : public PTPReadParser
+{
+public:
+	virtual void Reset() = 0;
+};
+
 // Base class for outgoing data supplier
 class PTPDataSupplier
 {
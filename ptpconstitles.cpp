@@ -17,6 +17,11 @@ e-mail   :  support@circuitsathome.com
 
 #include "ptpconstitles.h"
 
+// older avr-libc has no pgm_read_ptr, pointers are 16 bit there anyway
+#ifndef pgm_read_ptr
+#define pgm_read_ptr(addr)	((void*)pgm_read_word(addr))
+#endif
+
 const char* const ptpopNames[] PROGMEM = 
 {
 	msgUndefined,				
@@ -184,7 +189,7 @@ bool PrintPTPOperation(uint16_t op)
 {
 	if ((op & 0xFF) <= (PTP_OC_InitiateOpenCapture & 0xFF))
 	{
-		E_Notify((char*)pgm_read_word(&ptpopNames[(op & 0xFF)]), 0x80);
+		E_Notify((char*)pgm_read_ptr(&ptpopNames[(op & 0xFF)]), 0x80);
 		return true;
 	}
 	return false;
@@ -193,7 +198,7 @@ bool PrintPTPOperation(uint16_t op)
 bool PrintMTPOperation(uint16_t op)
 {
 	if ((op & 0xFF) <= (MTP_OC_SendObjectPropList & 0xFF))
-		E_Notify((char*)pgm_read_word(&mtpopNames[(op & 0xFF)]), 0x80);
+		E_Notify((char*)pgm_read_ptr(&mtpopNames[(op & 0xFF)]), 0x80);
 	else
 	{
 		switch (op)
@@ -217,10 +222,10 @@ bool PrintMTPOperation(uint16_t op)
 void PrintEvent(uint16_t op)
 {
 	if ((((op >> 8) & 0xFF) == 0x40) && ((op & 0xFF) <= (PTP_EC_UnreportedStatus & 0xFF)))
-		E_Notify((char*)pgm_read_word(&ptpevNames[(op & 0xFF)]), 0x80);
+		E_Notify((char*)pgm_read_ptr(&ptpevNames[(op & 0xFF)]), 0x80);
 	else
 		if ((((op >> 8) & 0xFF) == 0xC8) && ((op & 0xFF) <= (MTP_EC_ObjectReferencesChanged & 0xFF)))
-			E_Notify((char*)pgm_read_word(&mtpevNames[(op & 0xFF)]), 0x80);
+			E_Notify((char*)pgm_read_ptr(&mtpevNames[(op & 0xFF)]), 0x80);
 		else
 			E_Notify(msgVendorDefined, 0x80);
 }
@@ -228,12 +233,12 @@ void PrintEvent(uint16_t op)
 void PrintDevProp(uint16_t op)
 {
 	if ((((op >> 8) & 0xFF) == 0x50) && ((op & 0xFF) <= (PTP_DPC_CopyrightInfo & 0xFF)))
-		E_Notify((char*)pgm_read_word(&ptpprNames[(op & 0xFF)]), 0x80);
+		E_Notify((char*)pgm_read_ptr(&ptpprNames[(op & 0xFF)]), 0x80);
 	else
 		if (((op >> 8) & 0xFF) == 0xD4) 
 		{
 			if ( (op & 0xFF) <= (MTP_DPC_Perceived_Device_Type & 0xFF) )
-				E_Notify((char*)pgm_read_word(&mtpprNames[(op & 0xFF)]), 0x80);
+				E_Notify((char*)pgm_read_ptr(&mtpprNames[(op & 0xFF)]), 0x80);
 			else
 			{
 				switch (op)
@@ -259,10 +264,10 @@ void PrintDevProp(uint16_t op)
 void PrintFormat(uint16_t op)
 {
 	if ((((op >> 8) & 0xFF) == 0x30) && ((op & 0xFF) <= (PTP_OFC_QT & 0xFF)))
-		E_Notify((char*)pgm_read_word(&acNames[(op & 0xFF)]), 0x80);
+		E_Notify((char*)pgm_read_ptr(&acNames[(op & 0xFF)]), 0x80);
 	else
 		if ((((op >> 8) & 0xFF) == 0x38) && ((op & 0xFF) <= (PTP_OFC_JPX & 0xFF)))
-			E_Notify((char*)pgm_read_word(&imNames[(op & 0xFF)]), 0x80);
+			E_Notify((char*)pgm_read_ptr(&imNames[(op & 0xFF)]), 0x80);
 		else
 		{
 			switch (op)
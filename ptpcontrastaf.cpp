@@ -0,0 +1,290 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpcontrastaf.h"
+#include "ptpdebug.h"
+
+void PTPJpegMetric::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset __attribute__ ((unused)))
+{
+	for (uint16_t i=0; i<len && nStage != msDone; i++)
+	{
+		uint8_t		b = pbuf[i];
+
+		switch (nStage)
+		{
+		case msSOI:
+			if (bMarker && b == 0xD8)
+				nStage = msSOS;
+			break;
+		case msSOS:
+			if (bMarker && b == 0xDA)
+				nStage = msScan;
+			break;
+		case msScan:
+			// stuffed 0xFF00 and restart markers are scan data, EOI ends it
+			if (bMarker && b == 0xD9)
+			{
+				scanSize --;
+				nStage = msDone;
+				break;
+			}
+			scanSize ++;
+			break;
+		}
+		bMarker = (b == 0xFF);
+	}
+}
+
+PTPContrastAF::PTPContrastAF() :
+	theState(stIdle),
+	stepSize(0),
+	fineStep(1),
+	shrink(2),
+	direction(1),
+	bPassedPeak(false),
+	bConverged(false),
+	skipFrames(1),
+	framesLeft(0),
+	badFrames(0),
+	curPos(0),
+	lastValue(0)
+{
+	memset(&theStats, 0, sizeof(theStats));
+}
+
+uint16_t PTPContrastAF::Start(int16_t coarse_step, int16_t fine_step, uint8_t shrink_by, uint8_t skip_frames)
+{
+	if (coarse_step <= 0 || fine_step <= 0)
+		return PTP_RC_InvalidParameter;
+
+	memset(&theStats, 0, sizeof(theStats));
+	theStats.timeStart	= millis();
+	theStats.timeEnd	= theStats.timeStart;
+
+	stepSize	= coarse_step;
+	fineStep	= fine_step;
+	shrink		= (shrink_by < 2) ? 2 : shrink_by;
+	direction	= 1;
+	bPassedPeak	= false;
+	bConverged	= false;
+	skipFrames	= skip_frames;
+	badFrames	= 0;
+	curPos		= 0;
+	lastValue	= 0;
+
+	theBackOff.Reset();
+
+	// the score of the start position comes first
+	framesLeft	= 1;
+	theState	= stMeasure;
+
+	return PTP_RC_OK;
+}
+
+void PTPContrastAF::Finish()
+{
+	theState		= stIdle;
+	theStats.timeEnd= millis();
+}
+
+// Returns true if the operation has to be repeated later
+bool PTPContrastAF::BusyWait(uint16_t rc)
+{
+	if (rc != PTP_RC_DeviceBusy)
+	{
+		theBackOff.Succeeded();
+		return false;
+	}
+	theStats.numBusy ++;
+	theBackOff.Failed();
+	return true;
+}
+
+void PTPContrastAF::Reverse(bool shrink_step)
+{
+	direction = -direction;
+	theStats.numReversals ++;
+
+	if (shrink_step)
+		stepSize /= shrink;
+}
+
+uint16_t PTPContrastAF::OnDrive()
+{
+	int16_t		taken = 0;
+	uint16_t	ptp_error = DriveFocus(direction * stepSize, &taken);
+
+	if (BusyWait(ptp_error))
+		return PTP_RC_OK;
+
+	theStats.numMoves ++;
+	curPos += taken;
+
+	if (IsDriveEnd(ptp_error))
+	{
+		// already at the end of the range, the other way is the only one left
+		if (!taken)
+		{
+			Reverse(bPassedPeak);
+			return PTP_RC_OK;
+		}
+		ptp_error = PTP_RC_OK;
+	}
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("AF drive error:", ptp_error);
+		theStats.numErrors ++;
+		Finish();
+		return ptp_error;
+	}
+	theState = stSettle;
+	return OnSettle();
+}
+
+uint16_t PTPContrastAF::OnSettle()
+{
+	uint16_t	ptp_error = FocusReady();
+
+	if (BusyWait(ptp_error))
+		return PTP_RC_OK;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		theStats.numErrors ++;
+		Finish();
+		return ptp_error;
+	}
+	framesLeft	= skipFrames + 1;
+	theState	= stMeasure;
+	return ptp_error;
+}
+
+uint16_t PTPContrastAF::OnMeasure()
+{
+	theMetric.Reset();
+
+	uint16_t	ptp_error = GetFrame(&theMetric);
+
+	if (BusyWait(ptp_error))
+		return PTP_RC_OK;
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("AF frame error:", ptp_error);
+		theStats.numErrors ++;
+		Finish();
+		return ptp_error;
+	}
+	theStats.numFrames ++;
+
+	if (--framesLeft)
+		return ptp_error;
+
+	if (!theMetric.IsValid())
+	{
+		if (++badFrames >= PTP_CAF_MAX_BAD_FRAMES)
+		{
+			theStats.numErrors ++;
+			Finish();
+			return PTP_RC_GeneralError;
+		}
+		framesLeft = 1;
+		return ptp_error;
+	}
+	badFrames = 0;
+
+	uint32_t	value = theMetric.GetValue();
+
+	if (!theStats.numMoves)
+	{
+		theStats.bestValue	= value;
+		theStats.bestPos	= curPos;
+		lastValue			= value;
+		theState			= stDrive;
+		return OnDrive();
+	}
+	if (value > theStats.bestValue)
+	{
+		theStats.bestValue	= value;
+		theStats.bestPos	= curPos;
+	}
+	// once the score has risen a fall means the peak has been passed,
+	// a fall on the first move only means the search started the wrong way
+	if (value > lastValue)
+		bPassedPeak = true;
+	else if (value < lastValue)
+		Reverse(bPassedPeak);
+
+	lastValue = value;
+
+	if (stepSize < fineStep || theStats.numMoves >= PTP_CAF_MAX_MOVES)
+	{
+		bConverged	= (stepSize < fineStep);
+		theState	= stReturn;
+		return OnReturn();
+	}
+	theState = stDrive;
+	return OnDrive();
+}
+
+uint16_t PTPContrastAF::OnReturn()
+{
+	if (curPos != theStats.bestPos)
+	{
+		int16_t		taken = 0;
+		uint16_t	ptp_error = DriveFocus(theStats.bestPos - curPos, &taken);
+
+		if (BusyWait(ptp_error))
+			return PTP_RC_OK;
+
+		if (ptp_error != PTP_RC_OK && !IsDriveEnd(ptp_error))
+		{
+			theStats.numErrors ++;
+			Finish();
+			return ptp_error;
+		}
+		theStats.numMoves ++;
+		curPos += taken;
+
+		// the rest of the drive goes out on the next call
+		if (curPos != theStats.bestPos && taken)
+			return ptp_error;
+	}
+	Finish();
+	return PTP_RC_OK;
+}
+
+uint16_t PTPContrastAF::Task()
+{
+	if (theState == stIdle)
+		return PTP_RC_OK;
+
+	if (!theBackOff.IsDue())
+		return PTP_RC_OK;
+
+	switch (theState)
+	{
+	case stDrive:
+		return OnDrive();
+	case stSettle:
+		return OnSettle();
+	case stMeasure:
+		return OnMeasure();
+	case stReturn:
+		return OnReturn();
+	}
+	return PTP_RC_OK;
+}
@@ -0,0 +1,140 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPCONTRASTAF_H__
+#define __PTPCONTRASTAF_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include "ptpconst.h"
+#include "ptpcallback.h"
+#include "ptppacing.h"
+#define PTP_CAF_MAX_MOVES			64		// the search gives up after this many focus moves
+#define PTP_CAF_MAX_BAD_FRAMES		4		// frames in a row with no JPEG scan before the search stops
+
+// Sharpness proxy of a live view frame: the size of the JPEG entropy coded
+// data. Fine detail takes more bits to code, so the scan grows as the image
+// gets sharper. Works on the raw transaction data, the JPEG is found by its
+// SOI and SOS markers whatever vendor header precedes it.
+class PTPJpegMetric : public PTPReadParser
+{
+	enum { msSOI, msSOS, msScan, msDone };
+
+	uint8_t		nStage;
+	bool		bMarker;		// the last byte was 0xFF
+	uint32_t	scanSize;
+
+public:
+	PTPJpegMetric() : nStage(msSOI), bMarker(false), scanSize(0) {};
+
+	void Reset() { nStage = msSOI; bMarker = false; scanSize = 0; };
+	bool IsValid() { return (nStage == msDone || (nStage == msScan && scanSize)); };
+	uint32_t GetValue() { return scanSize; };
+
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+struct PTPContrastAFStats
+{
+	uint16_t	numMoves;			// focus drive commands
+	uint16_t	numFrames;			// frames measured
+	uint16_t	numReversals;
+	uint16_t	numBusy;			// DeviceBusy or not-ready responses
+	uint16_t	numErrors;
+	uint32_t	timeStart;			// millis() of Start()
+	uint32_t	timeEnd;			// millis() of the search end
+	uint32_t	bestValue;			// metric at the best position
+	int16_t		bestPos;			// best position relative to the start, drive steps
+};
+
+// Contrast detect autofocus driven by the host. Live view frames are scored
+// with PTPJpegMetric while they are received and the focus is moved in a hill
+// climb: moves go on in the same direction while the score rises, once it
+// falls the direction is reversed and the step shrunk. The search ends when
+// the step falls below the fine step, the lens is then driven back to the
+// best position seen.
+//
+// The next move goes out right after the frame which decided it, in the same
+// Task() call. Live view lags behind the lens, skip_frames frames following
+// each move are not scored.
+class PTPContrastAF
+{
+	enum { stIdle, stDrive, stSettle, stMeasure, stReturn };
+
+	PTPJpegMetric		theMetric;
+
+	uint8_t				theState;
+	int16_t				stepSize;
+	int16_t				fineStep;
+	uint8_t				shrink;
+	int8_t				direction;
+	bool				bPassedPeak;	// the score has risen at least once
+	bool				bConverged;
+	uint8_t				skipFrames;
+	uint8_t				framesLeft;		// frames to receive before scoring
+	uint8_t				badFrames;
+	int16_t				curPos;			// lens position relative to the start
+	uint32_t			lastValue;
+
+	PTPBackOff			theBackOff;
+
+	PTPContrastAFStats	theStats;
+
+	bool BusyWait(uint16_t rc);
+	void Finish();
+	void Reverse(bool shrink_step);
+
+	uint16_t OnDrive();
+	uint16_t OnSettle();
+	uint16_t OnMeasure();
+	uint16_t OnReturn();
+
+protected:
+	// Drives the focus by up to steps steps, returns the number actually driven in taken.
+	// Positive steps move towards infinity.
+	virtual uint16_t DriveFocus(int16_t steps, int16_t *taken) = 0;
+	// Return PTP_RC_DeviceBusy while the lens is moving
+	virtual uint16_t FocusReady() { return PTP_RC_OK; };
+	virtual uint16_t GetFrame(PTPReadParser *parser) = 0;
+	// True if rc means the lens has reached the end of its range
+	virtual bool IsDriveEnd(uint16_t rc __attribute__ ((unused))) { return false; };
+
+public:
+	PTPContrastAF();
+
+	// coarse_step - the first step, fine_step - the smallest one,
+	// shrink_by - step divider on every reversal after the peak
+	uint16_t Start(int16_t coarse_step, int16_t fine_step = 1, uint8_t shrink_by = 2, uint8_t skip_frames = 1);
+	void Stop() { Finish(); };
+	bool IsRunning() { return (theState != stIdle); };
+	// true if the search has finished by reaching the fine step
+	bool IsConverged() { return bConverged; };
+
+	// Should be called from OnDeviceInitializedState
+	uint16_t Task();
+
+	const PTPContrastAFStats* GetStats() { return &theStats; };
+	// Start() to the end of the search, ms
+	uint32_t GetConvergenceTime() { return theStats.timeEnd - theStats.timeStart; };
+};
+
+#endif // __PTPCONTRASTAF_H__
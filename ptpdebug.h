@@ -21,6 +21,9 @@ e-mail   :  support@circuitsathome.com
 
 // #define PTPDEBUG
 
+// Binary trace into a RAM ring buffer, see ptptrace.h. Ignored if PTPDEBUG is defined.
+// #define PTPTRACEBIN
+
 //#define Message(m,r) (ErrorMessage<uint16_t>((m),(r)))
 
 #if defined( PTPDEBUG )
@@ -30,10 +33,21 @@ e-mail   :  support@circuitsathome.com
 #define PTPTRACE8(s,r)(ErrorMessage<uint8_t>(PSTR((s)),(r)))
 #define PTPTRACE2(s,r)(ErrorMessage<uint16_t>(PSTR((s)),(r)))
 #define PTPTRACE32(s,r)(ErrorMessage<uint32_t>(PSTR((s)),(r)))
+#define PTPTRACEOP(o,t)((void)0)
+#elif defined( PTPTRACEBIN )
+#include "ptptrace.h"
+#define PTPTRACEID(s)((uint16_t)(uintptr_t)PSTR((s)))
+#define PTPTRACE(s)(PTPTrace::Record(PTPTRACEID(s),0))
+#define PTPTRACE8(s,r)(PTPTrace::Record(PTPTRACEID(s),(uint8_t)(r)))
+#define PTPTRACE2(s,r)(PTPTrace::Record(PTPTRACEID(s),(uint16_t)(r)))
+#define PTPTRACE32(s,r)(PTPTrace::Record(PTPTRACEID(s),(uint32_t)(r)))
+#define PTPTRACEOP(o,t)(PTPTrace::SetTransaction((o),(t)))
 #else
 #define PTPTRACE(s)((void)0)
+#define PTPTRACE8(s,r)((void)0)
 #define PTPTRACE32(s,r)((void)0)
 #define PTPTRACE2(s,r)(delay(1))	// necessary for some PowerShot cameras to work properly
+#define PTPTRACEOP(o,t)((void)0)
 #endif
 
 #endif // __PTPDEBUG_H__
@@ -65,6 +65,7 @@ class PTPDevPropParser : public PTPReadParser
     uint8_t				varBuffer[sizeof(VALUE_TYPE)];
     uint16_t            enLen;
     uint16_t            enLenCntdn;
+    uint8_t             skipCntdn;
 
 	MultiByteValueParser				valParser;
     PTPDevicePropValue<VALUE_TYPE>     *pDPValue;
@@ -78,12 +79,13 @@ class PTPDevPropParser : public PTPReadParser
 
 public:
 	PTPDevPropParser(PTPDevicePropValue<VALUE_TYPE> *p) :
-        pDPValue(p),
 		nStage(0),
 		enStage(0),
 		formFlag(0),
         enLen(0),
-        enLenCntdn(0)
+        enLenCntdn(0),
+        skipCntdn(0),
+        pDPValue(p)
 	{
         theBuffer.valueSize = sizeof(VALUE_TYPE);
 		theBuffer.pValue = varBuffer;
@@ -91,12 +93,14 @@ public:
 	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
 };
 
+// valParser has to be initialized before the first call
 template <class VALUE_TYPE>
 bool PTPDevPropParser<VALUE_TYPE>::ParseValue(uint8_t **pp, uint16_t *pcntdn, VALUE_TYPE &val)
 {
-    val = *((VALUE_TYPE*)*pp);
-    (*pp)	+= sizeof(VALUE_TYPE);
-    (*pcntdn)	-= sizeof(VALUE_TYPE);
+    if (!valParser.Parse(pp, pcntdn))
+        return false;
+
+    val = *((VALUE_TYPE*)varBuffer);
     return true;
 }
 
@@ -127,18 +131,31 @@ void PTPDevPropParser<VALUE_TYPE>::Parse(const uint16_t len, const uint8_t *pbuf
 	switch (nStage)
 	{
 	case 0:
-		p	+= 17;
-		cntdn	-= 17;
+		// container header, property code, data type and get/set flag
+		skipCntdn = 17;
                 nStage = 1;
 	case 1:
-		if (!ParseValue(&p, &cntdn, vt))
+		for (; skipCntdn && cntdn; skipCntdn--, cntdn--, p++);
+
+		if (skipCntdn)
 			return;
+
+		theBuffer.valueSize = sizeof(VALUE_TYPE);
+		valParser.Initialize(&theBuffer);
 		nStage = 2;
 	case 2:
-		if (!ParseValue(&p, &cntdn, pDPValue->valCurrent))
+		// factory default value
+		if (!ParseValue(&p, &cntdn, vt))
 			return;
 		nStage = 3;
 	case 3:
+		if (!ParseValue(&p, &cntdn, pDPValue->valCurrent))
+			return;
+		nStage = 4;
+	case 4:
+		if (!cntdn)
+			return;
+
                 for (uint8_t i=0; i<3; i++)
                     pDPValue->arrValues[i] = pDPValue->valCurrent;
 
@@ -146,8 +163,7 @@ void PTPDevPropParser<VALUE_TYPE>::Parse(const uint16_t len, const uint8_t *pbuf
                 pDPValue->listForm = formFlag;
 		p ++;
 		cntdn --;
-		nStage = 4;
-	case 4:
+
 		if (formFlag == 1)
 			enumParser.Initialize(2, sizeof(VALUE_TYPE), &theBuffer, PTPListParser::modeRange);
                 nStage = 5;
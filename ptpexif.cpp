@@ -0,0 +1,416 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpexif.h"
+#include "ptpconst.h"
+
+// sizes of the TIFF field types 1 to 13
+static const uint8_t exifTypeSizes[] = { 1, 1, 2, 4, 8, 1, 1, 2, 4, 8, 4, 8, 4 };
+
+static uint8_t ExifTypeSize(uint16_t type)
+{
+	return (type && type <= sizeof(exifTypeSizes)) ? exifTypeSizes[type - 1] : 0;
+}
+
+void PTPExifParser::Reset()
+{
+	nStage		= psStart;
+	bMotorola	= false;
+	tiffBase	= 0;
+	segEnd		= 0xFFFFFFFF;
+	segLeft		= 0;
+	segCode		= 0;
+	numPending	= 0;
+	numMissed	= 0;
+	itemNeed	= 0;
+	itemPos		= 0;
+	entriesLeft	= 0;
+
+	curItem.kind = ikNone;
+}
+
+uint16_t PTPExifParser::Get16(const uint8_t *p)
+{
+	return (bMotorola) ? ((uint16_t)p[0] << 8) | p[1] : ((uint16_t)p[1] << 8) | p[0];
+}
+
+uint32_t PTPExifParser::Get32(const uint8_t *p)
+{
+	return (bMotorola) ?	((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3] :
+							((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+}
+
+// Keeps the list sorted by position
+void PTPExifParser::Push(uint8_t kind, uint32_t pos, uint8_t ifd, uint16_t tag, uint16_t type, uint32_t count)
+{
+	if (numPending >= PTP_EXIF_MAX_PENDING)
+	{
+		numMissed ++;
+		return;
+	}
+	uint8_t		i = numPending;
+
+	for (; i && thePending[i - 1].pos > pos; i--)
+		thePending[i] = thePending[i - 1];
+
+	thePending[i].pos	= pos;
+	thePending[i].count	= count;
+	thePending[i].tag	= tag;
+	thePending[i].type	= type;
+	thePending[i].ifd	= ifd;
+	thePending[i].kind	= kind;
+	numPending ++;
+}
+
+void PTPExifParser::Begin(uint8_t kind, uint8_t need)
+{
+	curItem.kind	= kind;
+	itemNeed		= need;
+	itemPos			= 0;
+}
+
+void PTPExifParser::OnEntry()
+{
+	uint16_t	tag		= Get16(itemBuf);
+	uint16_t	type	= Get16(itemBuf + 2);
+	uint32_t	count	= Get32(itemBuf + 4);
+	uint32_t	val		= Get32(itemBuf + 8);
+	uint8_t		unit	= ExifTypeSize(type);
+	uint32_t	size	= (count < 0x10000) ? unit * count : 0xFFFFFFFF;
+	uint8_t		ifd		= curItem.ifd;
+
+	if (!unit)
+		return;
+
+	switch (tag)
+	{
+	case PTP_EXIF_TAG_ExifIFD:
+		Push(ikIfdCount, tiffBase + val, PTP_EXIF_EXIF);
+		return;
+	case PTP_EXIF_TAG_SubIFDs:
+		if (count == 1)
+			Push(ikIfdCount, tiffBase + val, PTP_EXIF_SUBIFD);
+		else if (count <= PTP_EXIF_MAX_VALUE / 4)
+			Push(ikSubIfds, tiffBase + val, PTP_EXIF_SUBIFD, tag, type, count);
+		return;
+	}
+	if (size <= 4)
+	{
+		PTPExifField	f;
+		char			str[5];
+
+		f.ifd	= ifd;
+		f.tag	= tag;
+		f.type	= type;
+		f.count	= count;
+		f.denom	= 1;
+		f.str	= NULL;
+		f.value	= (unit == 1) ? itemBuf[8] : (unit == 2) ? Get16(itemBuf + 8) : val;
+
+		if (type == 2)
+		{
+			for (uint8_t i=0; i<4; i++)
+				str[i] = itemBuf[8 + i];
+
+			str[size] = 0;
+			f.str = str;
+		}
+		switch (tag)
+		{
+		case PTP_EXIF_TAG_Compression:
+			compression = (uint16_t)f.value;
+			break;
+		case PTP_EXIF_TAG_StripOffsets:
+			stripOffset = (count == 1) ? f.value : 0;
+			break;
+		case PTP_EXIF_TAG_StripByteCounts:
+			stripSize = (count == 1) ? f.value : 0;
+			break;
+		case PTP_EXIF_TAG_JPEGInterchangeFormat:
+			jpegOffset = f.value;
+			break;
+		case PTP_EXIF_TAG_JPEGInterchangeFormatLength:
+			jpegSize = f.value;
+			break;
+		}
+		if (pHandler)
+			pHandler->OnField(&f);
+
+		return;
+	}
+	if (size <= PTP_EXIF_MAX_VALUE && pHandler && pHandler->WantValue(ifd, tag))
+		Push(ikValue, tiffBase + val, ifd, tag, type, count);
+}
+
+void PTPExifParser::OnIfdEnd()
+{
+	if (pHandler)
+	{
+		if (jpegOffset && jpegSize)
+			pHandler->OnPreview(curItem.ifd, tiffBase + jpegOffset, jpegSize);
+
+		// CR2 keeps its large preview in IFD0 strips, JPEG compressed
+		if (stripOffset && stripSize && (compression == 6 || compression == 7))
+			pHandler->OnPreview(curItem.ifd, tiffBase + stripOffset, stripSize);
+	}
+	// IFD1 follows IFD0 only, the thumbnail
+	if (curItem.ifd == PTP_EXIF_IFD0)
+		Begin(ikIfdNext, 4);
+	else
+		curItem.kind = ikNone;
+}
+
+void PTPExifParser::OnItem()
+{
+	switch (curItem.kind)
+	{
+	case ikHeader:
+		bMotorola = (itemBuf[0] == 'M');
+
+		if (Get16(itemBuf + 2) != 42)
+		{
+			nStage = psDone;
+			return;
+		}
+		Push(ikIfdCount, tiffBase + Get32(itemBuf + 4), PTP_EXIF_IFD0);
+		curItem.kind = ikNone;
+		break;
+	case ikIfdCount:
+		entriesLeft	= Get16(itemBuf);
+		compression	= 0;
+		jpegOffset	= jpegSize		= 0;
+		stripOffset	= stripSize		= 0;
+
+		if (entriesLeft)
+			Begin(ikIfdEntry, 12);
+		else
+			OnIfdEnd();
+		break;
+	case ikIfdEntry:
+		OnEntry();
+
+		if (--entriesLeft)
+			Begin(ikIfdEntry, 12);
+		else
+			OnIfdEnd();
+		break;
+	case ikIfdNext:
+		{
+			uint32_t	next = Get32(itemBuf);
+
+			if (next)
+				Push(ikIfdCount, tiffBase + next, PTP_EXIF_IFD1);
+		}
+		curItem.kind = ikNone;
+		break;
+	case ikSubIfds:
+		for (uint8_t i=0; i<curItem.count; i++)
+			Push(ikIfdCount, tiffBase + Get32(itemBuf + (i << 2)), PTP_EXIF_SUBIFD);
+
+		curItem.kind = ikNone;
+		break;
+	case ikValue:
+		{
+			PTPExifField	f;
+			uint8_t			unit = ExifTypeSize(curItem.type);
+
+			f.ifd	= curItem.ifd;
+			f.tag	= curItem.tag;
+			f.type	= curItem.type;
+			f.count	= curItem.count;
+			f.denom	= 1;
+			f.str	= NULL;
+
+			if (curItem.type == 2)
+			{
+				itemBuf[itemNeed] = 0;
+				f.str	= (const char*)itemBuf;
+				f.value	= 0;
+			}
+			else if (curItem.type == 5 || curItem.type == 10)
+			{
+				f.value	= Get32(itemBuf);
+				f.denom	= Get32(itemBuf + 4);
+			}
+			else
+				f.value = (unit == 1) ? itemBuf[0] : (unit == 2) ? Get16(itemBuf) : Get32(itemBuf);
+
+			if (pHandler)
+				pHandler->OnField(&f);
+		}
+		curItem.kind = ikNone;
+		break;
+	}
+}
+
+void PTPExifParser::OnTiffByte(uint8_t b, uint32_t pos)
+{
+	if (curItem.kind == ikNone)
+	{
+		while (numPending && thePending[0].pos < pos)
+		{
+			numMissed ++;
+			numPending --;
+
+			for (uint8_t i=0; i<numPending; i++)
+				thePending[i] = thePending[i + 1];
+		}
+		if (!numPending)
+		{
+			nStage = psDone;
+			return;
+		}
+		if (thePending[0].pos != pos)
+			return;
+
+		curItem = thePending[0];
+		numPending --;
+
+		for (uint8_t i=0; i<numPending; i++)
+			thePending[i] = thePending[i + 1];
+
+		uint8_t		need = 2;
+
+		if (curItem.kind == ikHeader)
+			need = 8;
+		else if (curItem.kind == ikSubIfds)
+			need = (uint8_t)(curItem.count << 2);
+		else if (curItem.kind == ikValue)
+			need = (uint8_t)(ExifTypeSize(curItem.type) * curItem.count);
+
+		Begin(curItem.kind, need);
+	}
+	itemBuf[itemPos++] = b;
+
+	if (itemPos < itemNeed)
+		return;
+
+	OnItem();
+
+	if (curItem.kind == ikNone && !numPending)
+		nStage = psDone;
+}
+
+void PTPExifParser::OnByte(uint8_t b, uint32_t pos)
+{
+	switch (nStage)
+	{
+	case psStart:
+		itemBuf[itemPos++] = b;
+
+		if (itemPos < 2)
+			return;
+
+		if (itemBuf[0] == 0xFF && itemBuf[1] == 0xD8)
+		{
+			itemPos	= 0;
+			nStage	= psJpegMarker;
+		}
+		else if ((itemBuf[0] == 'I' && itemBuf[1] == 'I') || (itemBuf[0] == 'M' && itemBuf[1] == 'M'))
+		{
+			// raw files are TIFF from the first byte, the byte order is already in the buffer
+			tiffBase		= 0;
+			curItem.kind	= ikHeader;
+			itemNeed		= 8;
+			nStage			= psTiff;
+		}
+		else
+			nStage = psDone;
+		return;
+	case psJpegMarker:
+		if (b == 0xFF)
+			nStage = psJpegCode;
+		else
+			nStage = psDone;
+		return;
+	case psJpegCode:
+		if (b == 0xFF)
+			return;
+
+		// no Exif before the image data
+		if (b == 0xDA || b == 0xD9)
+		{
+			nStage = psDone;
+			return;
+		}
+		if ((b >= 0xD0 && b <= 0xD7) || b == 0x01)
+		{
+			nStage = psJpegMarker;
+			return;
+		}
+		segCode	= b;
+		itemPos	= 0;
+		nStage	= psJpegLen;
+		return;
+	case psJpegLen:
+		itemBuf[itemPos++] = b;
+
+		if (itemPos < 2)
+			return;
+
+		segLeft	= (((uint16_t)itemBuf[0] << 8) | itemBuf[1]) - 2;
+		itemPos	= 0;
+		nStage	= (segCode == 0xE1 && segLeft > 6) ? psExifId : (segLeft) ? psJpegSkip : psJpegMarker;
+		return;
+	case psJpegSkip:
+		if (!--segLeft)
+			nStage = psJpegMarker;
+		return;
+	case psExifId:
+		itemBuf[itemPos++] = b;
+		segLeft --;
+
+		if (itemPos < 6)
+			return;
+
+		if (itemBuf[0] == 'E' && itemBuf[1] == 'x' && itemBuf[2] == 'i' && itemBuf[3] == 'f' && !itemBuf[4] && !itemBuf[5])
+		{
+			tiffBase	= pos + 1;
+			segEnd		= tiffBase + segLeft;
+			nStage		= psTiff;
+			Push(ikHeader, tiffBase, PTP_EXIF_IFD0);
+		}
+		else
+			nStage = psJpegSkip;
+		return;
+	case psTiff:
+		if (pos >= segEnd)
+		{
+			nStage = psDone;
+			return;
+		}
+		OnTiffByte(b, pos);
+		return;
+	}
+}
+
+void PTPExifParser::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+{
+	uint16_t	i = 0;
+
+	// PTP container header
+	if (offset < PTP_USB_BULK_HDR_LEN)
+	{
+		if (len <= PTP_USB_BULK_HDR_LEN - offset)
+			return;
+
+		i = (uint16_t)(PTP_USB_BULK_HDR_LEN - offset);
+	}
+	uint32_t	pos = offset + i - PTP_USB_BULK_HDR_LEN;
+
+	for (; i<len && nStage != psDone; i++, pos++)
+		OnByte(pbuf[i], pos);
+}
@@ -0,0 +1,148 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPEXIF_H__
+#define __PTPEXIF_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include "ptpcallback.h"
+
+#define PTP_EXIF_MAX_PENDING		12		// IFDs and values waiting for their bytes to arrive
+#define PTP_EXIF_MAX_VALUE			32		// longest out of line value read, bytes
+
+// IFD identifiers passed to the handler
+#define PTP_EXIF_IFD0				0
+#define PTP_EXIF_IFD1				1		// thumbnail IFD
+#define PTP_EXIF_EXIF				2		// Exif sub-IFD
+#define PTP_EXIF_SUBIFD				3		// TIFF SubIFDs (NEF previews and raw data)
+
+// Tags the parser acts upon
+#define PTP_EXIF_TAG_Compression				0x0103
+#define PTP_EXIF_TAG_StripOffsets				0x0111
+#define PTP_EXIF_TAG_StripByteCounts			0x0117
+#define PTP_EXIF_TAG_SubIFDs					0x014A
+#define PTP_EXIF_TAG_JPEGInterchangeFormat		0x0201
+#define PTP_EXIF_TAG_JPEGInterchangeFormatLength	0x0202
+#define PTP_EXIF_TAG_ExifIFD					0x8769
+
+// Some tags of interest
+#define PTP_EXIF_TAG_Make						0x010F
+#define PTP_EXIF_TAG_Model						0x0110
+#define PTP_EXIF_TAG_Orientation				0x0112
+#define PTP_EXIF_TAG_ExposureTime				0x829A
+#define PTP_EXIF_TAG_FNumber					0x829D
+#define PTP_EXIF_TAG_ISOSpeed					0x8827
+#define PTP_EXIF_TAG_DateTimeOriginal			0x9003
+#define PTP_EXIF_TAG_FocalLength				0x920A
+
+struct PTPExifField
+{
+	uint8_t		ifd;
+	uint16_t	tag;
+	uint16_t	type;
+	uint32_t	count;
+	uint32_t	value;					// the first integer, or the numerator of a rational
+	uint32_t	denom;					// the denominator of a rational
+	const char	*str;					// zero terminated ASCII value, NULL for other types
+};
+
+class PTPExifHandlers
+{
+public:
+	// Values which do not fit in the IFD entry are read only for the tags
+	// wanted, each takes a place in the pending list until it arrives
+	virtual bool WantValue(uint8_t ifd __attribute__ ((unused)), uint16_t tag __attribute__ ((unused))) { return true; };
+	virtual void OnField(const PTPExifField *field) = 0;
+	// JPEG preview or thumbnail, offset from the start of the object
+	virtual void OnPreview(uint8_t ifd __attribute__ ((unused)), uint32_t offset __attribute__ ((unused)), uint32_t size __attribute__ ((unused))) {};
+};
+
+// Walks the TIFF structure of JPEG (Exif APP1), CR2 and NEF files as the
+// object data streams past, to be attached to GetObject, GetPartialObject or
+// a chunked download. Data is never read twice, IFDs and values are visited
+// in the order of their offsets and those which lie behind the current
+// position are counted as missed. IsDone() turns true as soon as nothing is
+// left to visit, which for camera files is usually within the first 64 KB.
+class PTPExifParser : public PTPReadParser
+{
+	enum { psStart, psJpegMarker, psJpegCode, psJpegLen, psJpegSkip, psExifId, psTiff, psDone };
+	enum { ikNone, ikHeader, ikIfdCount, ikIfdEntry, ikIfdNext, ikSubIfds, ikValue };
+
+	struct Pending
+	{
+		uint32_t	pos;
+		uint32_t	count;
+		uint16_t	tag;
+		uint16_t	type;
+		uint8_t		ifd;
+		uint8_t		kind;
+	};
+
+	PTPExifHandlers		*pHandler;
+
+	uint8_t				nStage;
+	bool				bMotorola;			// big endian TIFF
+	uint32_t			tiffBase;			// object offset of the TIFF header
+	uint32_t			segEnd;				// end of the Exif APP1 segment of a JPEG
+	uint16_t			segLeft;
+	uint8_t				segCode;
+
+	Pending				thePending[PTP_EXIF_MAX_PENDING];
+	uint8_t				numPending;
+	uint16_t			numMissed;			// IFDs and values behind the current position or not queued
+
+	Pending				curItem;
+	uint8_t				itemNeed;
+	uint8_t				itemPos;
+	uint8_t				itemBuf[PTP_EXIF_MAX_VALUE + 1];
+	uint16_t			entriesLeft;
+
+	// preview candidates of the IFD being read
+	uint16_t			compression;
+	uint32_t			jpegOffset, jpegSize;
+	uint32_t			stripOffset, stripSize;
+
+	uint16_t Get16(const uint8_t *p);
+	uint32_t Get32(const uint8_t *p);
+
+	void Push(uint8_t kind, uint32_t pos, uint8_t ifd, uint16_t tag = 0, uint16_t type = 0, uint32_t count = 0);
+	void Begin(uint8_t kind, uint8_t need);
+	void OnEntry();
+	void OnIfdEnd();
+	void OnItem();
+	void OnTiffByte(uint8_t b, uint32_t pos);
+	void OnByte(uint8_t b, uint32_t pos);
+
+public:
+	PTPExifParser(PTPExifHandlers *handler) : pHandler(handler) { Reset(); };
+
+	void Reset();
+	// the handler may call it once it has all it needs
+	void Finish() { nStage = psDone; };
+	bool IsDone() { return (nStage == psDone); };
+	uint16_t GetMissed() { return numMissed; };
+
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+#endif // __PTPEXIF_H__
@@ -0,0 +1,173 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpfocusstack.h"
+#include "ptpdebug.h"
+
+PTPFocusStack::PTPFocusStack() :
+	theState(stIdle),
+	numFrames(0),
+	stepSize(0),
+	stepsLeft(0),
+	timeStage(0),
+	timeFrame(0)
+{
+	memset(&theStats, 0, sizeof(theStats));
+}
+
+uint16_t PTPFocusStack::Start(int16_t start, int16_t step, uint16_t frames)
+{
+	if (!frames)
+		return PTP_RC_InvalidParameter;
+
+	memset(&theStats, 0, sizeof(theStats));
+	theStats.frameMin	= 0xFFFFFFFF;
+	theStats.timeStart	= millis();
+
+	numFrames	= frames;
+	stepSize	= step;
+	stepsLeft	= start;
+	timeStage	= theStats.timeStart;
+	theState	= stDrive;
+
+	theBackOff.Reset();
+
+	return PTP_RC_OK;
+}
+
+// Returns true if the operation has to be repeated later
+bool PTPFocusStack::BusyWait(uint16_t rc)
+{
+	if (rc != PTP_RC_DeviceBusy)
+	{
+		theBackOff.Succeeded();
+		return false;
+	}
+	theStats.numBusy ++;
+	theBackOff.Failed();
+	return true;
+}
+
+void PTPFocusStack::AddStageTime(PTPFocusStageTime *st)
+{
+	uint32_t	time_now = millis();
+	uint32_t	t = time_now - timeStage;
+
+	st->sum += t;
+
+	if (t > st->max)
+		st->max = t;
+
+	timeStage = time_now;
+}
+
+uint16_t PTPFocusStack::Task()
+{
+	if (theState == stIdle)
+		return PTP_RC_OK;
+
+	if (!theBackOff.IsDue())
+		return PTP_RC_OK;
+
+	uint16_t	ptp_error = PTP_RC_OK;
+	int16_t		taken = 0;
+
+	switch (theState)
+	{
+	case stDrive:
+		if (stepsLeft)
+		{
+			ptp_error = DriveFocus(stepsLeft, &taken);
+
+			if (BusyWait(ptp_error))
+				return PTP_RC_OK;
+
+			if (ptp_error != PTP_RC_OK)
+				break;
+
+			// the rest of the drive goes out on the next call
+			if ((stepsLeft -= taken) != 0)
+				return ptp_error;
+		}
+		AddStageTime(&theStats.stDrive);
+		theState = stSettle;
+		// fall through
+	case stSettle:
+		ptp_error = FocusReady();
+
+		if (BusyWait(ptp_error))
+			return PTP_RC_OK;
+
+		if (ptp_error != PTP_RC_OK)
+			break;
+
+		AddStageTime(&theStats.stSettle);
+		theState = stCapture;
+		// fall through
+	case stCapture:
+		ptp_error = Capture();
+
+		if (BusyWait(ptp_error))
+			return PTP_RC_OK;
+
+		if (ptp_error != PTP_RC_OK)
+			break;
+
+		if (theStats.numFrames)
+		{
+			uint32_t	t = millis() - timeFrame;
+
+			theStats.frameLast = t;
+
+			if (t < theStats.frameMin)
+				theStats.frameMin = t;
+			if (t > theStats.frameMax)
+				theStats.frameMax = t;
+		}
+		timeFrame	= millis();
+		theState	= stCaptureWait;
+		theStats.numFrames ++;
+		return ptp_error;
+
+	case stCaptureWait:
+		ptp_error = CaptureReady();
+
+		if (BusyWait(ptp_error))
+			return PTP_RC_OK;
+
+		if (ptp_error != PTP_RC_OK)
+			break;
+
+		AddStageTime(&theStats.stCapture);
+		theStats.timeEnd = millis();
+
+		if (theStats.numFrames >= numFrames)
+		{
+			Finish();
+			return ptp_error;
+		}
+		stepsLeft	= stepSize;
+		theState	= stDrive;
+		return ptp_error;
+	}
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("Focus stack error:", ptp_error);
+		theStats.numErrors ++;
+		Finish();
+	}
+	return ptp_error;
+}
@@ -0,0 +1,96 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPFOCUSSTACK_H__
+#define __PTPFOCUSSTACK_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include "ptpconst.h"
+#include "ptppacing.h"
+
+// Stage timing in milliseconds
+struct PTPFocusStageTime
+{
+	uint32_t	sum;
+	uint32_t	max;
+};
+
+struct PTPFocusStackStats
+{
+	uint16_t			numFrames;		// frames captured
+	uint16_t			numBusy;		// DeviceBusy or not-ready responses
+	uint16_t			numErrors;
+	uint32_t			timeStart;		// millis() of Start()
+	uint32_t			timeEnd;		// millis() of the last frame captured
+	uint32_t			frameLast;		// capture to capture time of the last frame
+	uint32_t			frameMin;
+	uint32_t			frameMax;
+	PTPFocusStageTime	stDrive;		// focus drive commands of one step
+	PTPFocusStageTime	stSettle;		// drive done to the camera ready for capture
+	PTPFocusStageTime	stCapture;		// capture command to the camera ready for the next drive
+};
+
+// Focus stacking. Drives the focus by a fixed number of steps between frames
+// and uses the camera's own readiness reports instead of fixed delays. The lens
+// position is not known in absolute units, so the start position is given
+// relative to the current one. Positive steps move towards infinity.
+class PTPFocusStack
+{
+	enum { stIdle, stDrive, stSettle, stCapture, stCaptureWait };
+
+	uint8_t				theState;
+	uint16_t			numFrames;		// frames requested
+	int16_t				stepSize;
+	int16_t				stepsLeft;		// of the current drive
+	PTPBackOff			theBackOff;
+	uint32_t			timeStage;		// millis() of the current stage start
+	uint32_t			timeFrame;		// millis() of the last capture command
+
+	PTPFocusStackStats	theStats;
+
+	bool BusyWait(uint16_t rc);
+	void AddStageTime(PTPFocusStageTime *st);
+	void Finish() { theState = stIdle; theStats.timeEnd = millis(); };
+
+protected:
+	// Drives the focus by up to steps steps, returns the number actually driven in taken
+	virtual uint16_t DriveFocus(int16_t steps, int16_t *taken) = 0;
+	virtual uint16_t Capture() = 0;
+	// Return PTP_RC_DeviceBusy while the camera is not ready
+	virtual uint16_t FocusReady() { return PTP_RC_OK; };
+	virtual uint16_t CaptureReady() { return PTP_RC_OK; };
+
+public:
+	PTPFocusStack();
+
+	uint16_t Start(int16_t start, int16_t step, uint16_t frames);
+	void Stop() { Finish(); };
+	bool IsRunning() { return (theState != stIdle); };
+
+	// Should be called from OnDeviceInitializedState
+	uint16_t Task();
+
+	const PTPFocusStackStats* GetStats() { return &theStats; };
+};
+
+#endif // __PTPFOCUSSTACK_H__
@@ -0,0 +1,67 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPHASH_H__
+#define __PTPHASH_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include "ptpcallback.h"
+
+// CRC-32 (IEEE 802.3, as used by zip and PNG), table driven, the table lives in program memory
+class PTPCrc32
+{
+	uint32_t	theCrc;
+
+public:
+	PTPCrc32() : theCrc(0xFFFFFFFF) {};
+
+	void Reset() { theCrc = 0xFFFFFFFF; };
+	void Update(const uint8_t *p, uint16_t len);
+	uint32_t Get() { return ~theCrc; };
+};
+
+// Download stage which hashes object data on its way to the sink, so the
+// digest is ready when the transaction ends and the file need not be read
+// back for verification. Put it in front of the sink of GetObject,
+// GetPartialObject or a chunked download. Only bytes past the ones already
+// hashed are counted, a chunk fetched again after an error is passed to the
+// sink but does not spoil the digest.
+class PTPHashParser : public PTPReadParser
+{
+	PTPReadParser	*pSink;
+	PTPCrc32		theCrc;
+	uint32_t		numBytes;			// object bytes hashed
+
+public:
+	PTPHashParser(PTPReadParser *sink = NULL) : pSink(sink), numBytes(0) {};
+
+	void SetSink(PTPReadParser *sink) { pSink = sink; };
+	void Reset() { theCrc.Reset(); numBytes = 0; };
+
+	uint32_t GetCrc32() { return theCrc.Get(); };
+	uint32_t GetSize() { return numBytes; };
+
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+#endif // __PTPHASH_H__
@@ -0,0 +1,143 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpintervalometer.h"
+#include "ptpdebug.h"
+
+PTPIntervalometer::PTPIntervalometer() :
+	timeStart(0),
+	timeInterval(0),
+	numFrames(0),
+	frameNo(0),
+	timeFired(0),
+	deadlineFired(0),
+	bRunning(false),
+	bWaitCreated(false)
+{
+}
+
+void PTPIntervalometer::Start(uint32_t interval, uint32_t frames, uint32_t start_delay)
+{
+	timeStart		= millis() + start_delay;
+	timeInterval	= interval;
+	numFrames		= frames;
+	frameNo			= 0;
+	bWaitCreated	= false;
+	bRunning		= (interval != 0);
+
+	theStats.numFrames		= 0;
+	theStats.numMissed		= 0;
+	theStats.numMeasured	= 0;
+	theStats.lagLast		= 0;
+	theStats.lagEstimate	= 0;
+	theStats.errMin			= 0x7FFFFFFF;
+	theStats.errMax			= -0x7FFFFFFF;
+	theStats.errSum			= 0;
+	theStats.errAbsSum		= 0;
+}
+
+// Lead time is limited so that a slow frame cannot make the next one fire
+// before the previous deadline.
+uint32_t PTPIntervalometer::LeadTime()
+{
+	uint32_t	max_lead = timeInterval >> 1;
+
+	return (theStats.lagEstimate < max_lead) ? theStats.lagEstimate : max_lead;
+}
+
+uint32_t PTPIntervalometer::TimeToNext()
+{
+	if (!bRunning)
+		return 0;
+
+	int32_t		left = (int32_t)(Deadline(frameNo) - LeadTime() - millis());
+
+	return (left > 0) ? (uint32_t)left : 0;
+}
+
+uint16_t PTPIntervalometer::Task()
+{
+	if (!bRunning)
+		return PTP_RC_OK;
+
+	uint32_t	fire_time = millis() + LeadTime();
+
+	if ((int32_t)(fire_time - Deadline(frameNo)) < 0)
+		return PTP_RC_OK;
+
+	// Deadlines which have already passed are skipped rather than fired
+	// back-to-back, otherwise the rest of the sequence would be shifted.
+	while ((int32_t)(fire_time - Deadline(frameNo + 1)) >= 0)
+	{
+		frameNo ++;
+		theStats.numMissed ++;
+	}
+	if (numFrames && frameNo >= numFrames)
+	{
+		bRunning = false;
+		return PTP_RC_OK;
+	}
+	timeFired		= millis();
+	deadlineFired	= Deadline(frameNo);
+
+	uint16_t	ptp_error = Fire();
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		// the camera is busy - try again on the next call
+		if (ptp_error == PTP_RC_DeviceBusy)
+			return ptp_error;
+
+		PTPTRACE2("Interval capture error:", ptp_error);
+	}
+	else
+	{
+		bWaitCreated = true;
+		theStats.numFrames ++;
+	}
+	if (++frameNo >= numFrames && numFrames)
+		bRunning = false;
+
+	return ptp_error;
+}
+
+void PTPIntervalometer::OnFrameCreated()
+{
+	// RAW+JPEG produce two objects per frame, the first one is used
+	if (!bWaitCreated)
+		return;
+
+	bWaitCreated = false;
+
+	uint32_t	time_now	= millis();
+	uint32_t	lag			= time_now - timeFired;
+	int32_t		err			= (int32_t)(time_now - deadlineFired);
+
+	if (!theStats.numMeasured)
+		theStats.lagEstimate = lag;
+	else
+		theStats.lagEstimate += ((int32_t)lag - (int32_t)theStats.lagEstimate) / PTP_INTERVAL_LAG_DIVIDER;
+
+	theStats.lagLast	= lag;
+	theStats.numMeasured ++;
+	theStats.errSum		+= err;
+	theStats.errAbsSum	+= (err < 0) ? -err : err;
+
+	if (err < theStats.errMin)
+		theStats.errMin = err;
+	if (err > theStats.errMax)
+		theStats.errMax = err;
+}
@@ -0,0 +1,89 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPINTERVALOMETER_H__
+#define __PTPINTERVALOMETER_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include "ptpconst.h"
+
+#define PTP_INTERVAL_LAG_DIVIDER		8		// lag estimate moves by 1/8 of the difference per frame
+
+struct PTPIntervalStats
+{
+	uint32_t	numFrames;			// capture commands issued
+	uint32_t	numMissed;			// deadlines skipped because the camera was late
+	uint32_t	numMeasured;		// frames with the object creation time known
+	uint32_t	lagLast;			// capture command to object creation, ms
+	uint32_t	lagEstimate;		// lead time the next command is issued with, ms
+	int32_t		errMin;				// object creation time minus deadline, ms
+	int32_t		errMax;
+	int32_t		errSum;				// errSum / numMeasured gives the mean error
+	uint32_t	errAbsSum;			// errAbsSum / numMeasured gives the mean jitter
+};
+
+// Interval shooting against absolute deadlines. Frame N is due at
+// start + N * interval no matter how late the previous frames were, so
+// callback and USB latencies never accumulate. The capture command is issued
+// early by the measured command-to-ObjectCreated lag of the camera.
+class PTPIntervalometer
+{
+	uint32_t			timeStart;		// deadline of the first frame
+	uint32_t			timeInterval;
+	uint32_t			numFrames;		// number of deadlines, 0 - unlimited
+	uint32_t			frameNo;		// frame to be fired next
+	uint32_t			timeFired;		// millis() of the last capture command
+	uint32_t			deadlineFired;	// deadline of the last fired frame
+	bool				bRunning;
+	bool				bWaitCreated;	// the last fired frame has not been reported yet
+
+	PTPIntervalStats	theStats;
+
+	uint32_t Deadline(uint32_t n) { return timeStart + n * timeInterval; };
+	uint32_t LeadTime();
+
+protected:
+	// issues the capture command
+	virtual uint16_t Fire() = 0;
+
+public:
+	PTPIntervalometer();
+
+	void Start(uint32_t interval, uint32_t frames = 0, uint32_t start_delay = 0);
+	void Stop() { bRunning = false; };
+	bool IsRunning() { return bRunning; };
+
+	// Has to be called as often as possible, i.e. from OnDeviceInitializedState
+	uint16_t Task();
+
+	// To be called when the camera reports the object of the last fired frame
+	void OnFrameCreated();
+
+	// milliseconds left until the next capture command, 0 if it is due
+	uint32_t TimeToNext();
+	uint32_t FramesLeft() { return (numFrames > frameNo) ? numFrames - frameNo : 0; };
+
+	const PTPIntervalStats* GetStats() { return &theStats; };
+};
+
+#endif // __PTPINTERVALOMETER_H__
@@ -0,0 +1,87 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPPACING_H__
+#define __PTPPACING_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#define PTP_BACKOFF_MIN				2		// first retry delay, ms
+#define PTP_BACKOFF_MAX				64		// longest retry delay, ms
+
+// Poll timing of the Task() driven engines. A failed or busy operation is
+// retried after a delay which doubles on every failure in a row, up to the
+// maximum. Engines return from Task() while IsDue() is false.
+class PTPBackOff
+{
+	uint8_t		minDelay;
+	uint8_t		maxDelay;
+	uint8_t		theDelay;
+	uint32_t	nextTime;				// millis() when the engine is due
+
+public:
+	PTPBackOff(uint8_t max_delay = PTP_BACKOFF_MAX, uint8_t min_delay = PTP_BACKOFF_MIN) :
+		minDelay(min_delay), maxDelay(max_delay), theDelay(min_delay), nextTime(0) {};
+
+	// shortest delay, due at once
+	void Reset() { theDelay = minDelay; nextTime = millis(); };
+	// the next failure waits the shortest delay again
+	void Succeeded() { theDelay = minDelay; };
+	// waits the current delay and doubles it for the next failure
+	void Failed()
+	{
+		nextTime = millis() + theDelay;
+
+		if (theDelay < maxDelay)
+			theDelay <<= 1;
+	};
+	// fixed waits, the delay is left as it is
+	void Wait(uint32_t ms) { nextTime = millis() + ms; };
+	void WaitUntil(uint32_t time) { nextTime = time; };
+
+	bool IsDue() { return ((int32_t)(millis() - nextTime) >= 0); };
+};
+
+// Frames per second multiplied by 100. Long runs move factors of ten from the
+// frame count scale to the time, so that 32 bit math is enough.
+inline uint16_t PTPFrameRate(uint32_t frames, uint32_t elapsed_ms)
+{
+	uint32_t	scale = 100000;
+
+	if (!elapsed_ms)
+		return 0;
+
+	while (scale > 1 && frames > 0xFFFFFFFF / scale)
+	{
+		scale		/= 10;
+		elapsed_ms	/= 10;
+	}
+	// the time scaled down to nothing, the rate is out of range anyway
+	if (!elapsed_ms)
+		return 0xFFFF;
+
+	uint32_t	rate = frames * scale / elapsed_ms;
+
+	return (rate < 0xFFFF) ? (uint16_t)rate : 0xFFFF;
+}
+
+#endif // __PTPPACING_H__
@@ -0,0 +1,87 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptppoller.h"
+
+PTPEventPoller::PTPEventPoller(PTP *ptp, PTPResettableParser *parser, uint32_t empty_size, uint16_t min_interval, uint16_t max_interval) :
+	pPTP(ptp),
+	pParser(parser),
+	emptySize(empty_size),
+	minInterval(min_interval),
+	maxInterval(max_interval),
+	curInterval(min_interval),
+	nextPoll(0),
+	pktSize(0)
+{
+	ResetStats();
+}
+
+void PTPEventPoller::ResetStats()
+{
+	theStats.numPolls	= 0;
+	theStats.numEmpty	= 0;
+	theStats.timeStart	= millis();
+}
+
+uint16_t PTPEventPoller::GetPollRate()
+{
+	// tenths of a second keep the product within 32 bits for hours of polling
+	uint32_t	elapsed = (millis() - theStats.timeStart) / 100;
+
+	return (elapsed) ? (uint16_t)(theStats.numPolls * 1000 / elapsed) : 0;
+}
+
+void PTPEventPoller::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+{
+	if (!offset)
+		pktSize = *((uint32_t*)pbuf);
+
+	if (pParser)
+		pParser->Parse(len, pbuf, offset);
+}
+
+uint16_t PTPEventPoller::Poll()
+{
+	pktSize = 0;
+
+	if (pParser)
+		pParser->Reset();
+
+	uint16_t	ptp_error = pPTP->EventCheck(this);
+
+	theStats.numPolls ++;
+
+	// a failed poll is counted as an empty one so that a camera in trouble is not hammered
+	if (ptp_error != PTP_RC_OK || pktSize <= emptySize)
+	{
+		theStats.numEmpty ++;
+
+		curInterval = (curInterval < (maxInterval >> 1)) ? curInterval << 1 : maxInterval;
+	}
+	else
+		curInterval = minInterval;
+
+	nextPoll = millis() + curInterval;
+	return ptp_error;
+}
+
+uint16_t PTPEventPoller::Task()
+{
+	if ((int32_t)(millis() - nextPoll) < 0)
+		return PTP_RC_OK;
+
+	return Poll();
+}
@@ -0,0 +1,78 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPPOLLER_H__
+#define __PTPPOLLER_H__
+
+#include <ptp.h>
+
+#define PTP_POLL_INTERVAL_MIN		50		// ms
+#define PTP_POLL_INTERVAL_MAX		1600	// ms
+
+// Event container sizes with no event in them
+#define EOS_EVENT_EMPTY_SIZE		0x14	// header and the terminating record
+#define NK_EVENT_EMPTY_SIZE			0x0E	// header and zero event count
+#define PS_EVENT_EMPTY_SIZE			0x0C	// header only
+
+struct PTPPollStats
+{
+	uint32_t	numPolls;
+	uint32_t	numEmpty;				// polls which returned no events
+	uint32_t	timeStart;				// millis() of the last ResetStats()
+};
+
+// Event polling with exponential back-off. Every empty poll doubles the
+// interval up to the maximum, any event or a Kick() brings it back to the
+// minimum. The parser gets the event data unchanged and is reset before every
+// poll, so that a poll cut short does not leave it in the middle of a container.
+class PTPEventPoller : public PTPReadParser
+{
+	PTP				*pPTP;
+	PTPResettableParser	*pParser;
+	uint32_t		emptySize;
+	uint16_t		minInterval;
+	uint16_t		maxInterval;
+	uint16_t		curInterval;
+	uint32_t		nextPoll;
+	uint32_t		pktSize;			// container length of the last poll
+
+	PTPPollStats	theStats;
+
+public:
+	PTPEventPoller(PTP *ptp, PTPResettableParser *parser, uint32_t empty_size,
+					uint16_t min_interval = PTP_POLL_INTERVAL_MIN, uint16_t max_interval = PTP_POLL_INTERVAL_MAX);
+
+	// Polls if the current interval has elapsed
+	uint16_t Task();
+	uint16_t Poll();
+
+	// To be called on user actions, i.e. a button press, which are likely to
+	// change the camera state. The next Task() call polls right away.
+	void Kick() { curInterval = minInterval; nextPoll = millis(); };
+
+	uint16_t GetInterval() { return curInterval; };
+	// polls per second multiplied by 100
+	uint16_t GetPollRate();
+	// share of empty polls in percent
+	uint8_t GetEmptyShare() { return (theStats.numPolls) ? (uint8_t)(theStats.numEmpty * 100 / theStats.numPolls) : 0; };
+	const PTPPollStats* GetStats() { return &theStats; };
+	void ResetStats();
+
+	// PTPReadParser implementation
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+#endif // __PTPPOLLER_H__
@@ -0,0 +1,76 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptprecorder.h"
+
+void PTPRecordHeader::Pack(uint8_t *buf) const
+{
+	buf[0] = flags;
+	buf[1] = rcode;
+	buf[2] = (uint8_t)len;
+	buf[3] = (uint8_t)(len >> 8);
+	buf[4] = (uint8_t)time;
+	buf[5] = (uint8_t)(time >> 8);
+	buf[6] = (uint8_t)(time >> 16);
+	buf[7] = (uint8_t)(time >> 24);
+}
+
+void PTPRecordHeader::Unpack(const uint8_t *buf)
+{
+	flags	= buf[0];
+	rcode	= buf[1];
+	len		= (uint16_t)buf[2] | ((uint16_t)buf[3] << 8);
+	time	= (uint32_t)buf[4] | ((uint32_t)buf[5] << 8) | ((uint32_t)buf[6] << 16) | ((uint32_t)buf[7] << 24);
+}
+
+void PTPRecorder::Start()
+{
+	uint8_t		hdr[PTP_REC_FILE_HEADER_SIZE] = { 'P', 'T', 'P', 'R', PTP_REC_VERSION };
+
+	pWriter->Write(PTP_REC_FILE_HEADER_SIZE, hdr);
+
+	numRecords	= 0;
+	numBytes	= PTP_REC_FILE_HEADER_SIZE;
+	timeLast	= micros();
+	bRecording	= true;
+}
+
+void PTPRecorder::OnTransfer(uint8_t ep_index, bool in, uint8_t rcode, uint16_t len, const uint8_t *buf)
+{
+	if (!bRecording)
+		return;
+
+	uint32_t		time_now = micros();
+	PTPRecordHeader	rec;
+	uint8_t			hdr[PTP_REC_HEADER_SIZE];
+
+	rec.flags	= (ep_index & PTP_REC_EP_MASK) | ((in) ? PTP_REC_FLAG_IN : 0);
+	rec.rcode	= rcode;
+	rec.len		= (in && rcode) ? 0 : len;
+	rec.time	= time_now - timeLast;
+	rec.Pack(hdr);
+
+	pWriter->Write(PTP_REC_HEADER_SIZE, hdr);
+
+	if (rec.len)
+		pWriter->Write(rec.len, buf);
+
+	// the time spent writing is not charged to the camera
+	timeLast = micros();
+
+	numRecords	++;
+	numBytes	+= PTP_REC_HEADER_SIZE + rec.len;
+}
@@ -0,0 +1,83 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPRECORDER_H__
+#define __PTPRECORDER_H__
+
+#include <Usb.h>
+
+// Recording format. The file starts with the 4 byte signature and a version
+// byte, followed by one record per pipe transfer:
+//
+//	uint8_t		flags		PTP_REC_FLAG_IN | endpoint index
+//	uint8_t		rcode		USB return code
+//	uint16_t	len			payload length
+//	uint32_t	time		micros() since the previous record
+//	uint8_t		payload[len]
+//
+// Multibyte fields are little endian. The payload of an OUT transfer is the
+// data sent, the payload of an IN transfer is the data received, empty if
+// the transfer failed.
+#define PTP_REC_SIGNATURE		"PTPR"
+#define PTP_REC_VERSION			1
+#define PTP_REC_FILE_HEADER_SIZE	5
+#define PTP_REC_HEADER_SIZE		8
+#define PTP_REC_FLAG_IN			0x80
+#define PTP_REC_EP_MASK			0x0F
+
+struct PTPRecordHeader
+{
+	uint8_t		flags;
+	uint8_t		rcode;
+	uint16_t	len;
+	uint32_t	time;
+
+	void Pack(uint8_t *buf) const;
+	void Unpack(const uint8_t *buf);
+};
+
+// Destination of a recording, i.e. a file on the SD card
+class PTPRecordWriter
+{
+public:
+	virtual void Write(const uint16_t len, const uint8_t *pbuf) = 0;
+};
+
+// Receives a copy of every transfer made by PTP, see PTP::SetRecorder()
+class PTPRecorder
+{
+	PTPRecordWriter		*pWriter;
+	bool				bRecording;
+	uint32_t			timeLast;
+	uint32_t			numRecords;
+	uint32_t			numBytes;			// bytes written including the headers
+
+public:
+	PTPRecorder(PTPRecordWriter *writer) : pWriter(writer), bRecording(false), timeLast(0), numRecords(0), numBytes(0) {};
+
+	// Writes the file header. Start recording before the camera is connected,
+	// so that the recording begins with OpenSession.
+	void Start();
+	void Stop() { bRecording = false; };
+	bool IsRecording() { return bRecording; };
+
+	void OnTransfer(uint8_t ep_index, bool in, uint8_t rcode, uint16_t len, const uint8_t *buf);
+
+	uint32_t GetCount() { return numRecords; };
+	uint32_t GetSize() { return numBytes; };
+};
+
+#endif // __PTPRECORDER_H__
@@ -0,0 +1,144 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpreplay.h"
+#include "ptpdebug.h"
+
+PTPReplay::PTPReplay(PTPRecordReader *reader) :
+	pReader(reader),
+	bPending(false),
+	bEnd(true),
+	timeNow(0),
+	numPlayed(0),
+	numMismatches(0)
+{
+}
+
+bool PTPReplay::Open()
+{
+	uint8_t		hdr[PTP_REC_FILE_HEADER_SIZE];
+
+	bPending		= false;
+	timeNow			= 0;
+	numPlayed		= 0;
+	numMismatches	= 0;
+
+	bEnd = !(pReader->Read(PTP_REC_FILE_HEADER_SIZE, hdr) == PTP_REC_FILE_HEADER_SIZE
+		&& hdr[0] == 'P' && hdr[1] == 'T' && hdr[2] == 'P' && hdr[3] == 'R'
+		&& hdr[4] == PTP_REC_VERSION);
+
+	return !bEnd;
+}
+
+void PTPReplay::Skip(uint16_t len)
+{
+	uint8_t		buf[16];
+
+	while (len)
+	{
+		uint16_t	n = (len < sizeof(buf)) ? len : sizeof(buf);
+
+		if (pReader->Read(n, buf) != n)
+		{
+			bEnd = true;
+			return;
+		}
+		len -= n;
+	}
+}
+
+// Returns true if the next record is the transfer requested
+bool PTPReplay::Next(uint8_t ep_index, bool in)
+{
+	if (bEnd)
+		return false;
+
+	if (!bPending)
+	{
+		uint8_t		hdr[PTP_REC_HEADER_SIZE];
+
+		if (pReader->Read(PTP_REC_HEADER_SIZE, hdr) != PTP_REC_HEADER_SIZE)
+		{
+			bEnd = true;
+			return false;
+		}
+		theRecord.Unpack(hdr);
+		bPending = true;
+	}
+	if ((theRecord.flags & PTP_REC_EP_MASK) != ep_index || ((theRecord.flags & PTP_REC_FLAG_IN) != 0) != in)
+	{
+		PTPTRACE2("Replay transfer mismatch:", theRecord.flags);
+		numMismatches ++;
+		return false;
+	}
+	bPending	= false;
+	timeNow		+= theRecord.time;
+	numPlayed	++;
+	return true;
+}
+
+uint8_t PTPReplay::OutTransfer(uint8_t ep_index, uint16_t len, uint8_t *buf)
+{
+	if (!Next(ep_index, false))
+		return hrTIMEOUT;
+
+	uint16_t	left	= theRecord.len;
+	bool		bSame	= (len == left);
+
+	while (left && !bEnd)
+	{
+		uint8_t		chunk[16];
+		uint16_t	n = (left < sizeof(chunk)) ? left : sizeof(chunk);
+
+		if (pReader->Read(n, chunk) != n)
+		{
+			bEnd = true;
+			break;
+		}
+		for (uint8_t i=0; bSame && i<n; i++)
+			bSame = (chunk[i] == buf[theRecord.len - left + i]);
+
+		left -= n;
+	}
+	if (!bSame)
+	{
+		PTPTRACE2("Replay data mismatch, record:", numPlayed);
+		numMismatches ++;
+	}
+	return theRecord.rcode;
+}
+
+uint8_t PTPReplay::InTransfer(uint8_t ep_index, uint16_t *len, uint8_t *buf)
+{
+	if (!Next(ep_index, true))
+	{
+		*len = 0;
+		return hrTIMEOUT;
+	}
+	uint16_t	n = (theRecord.len < *len) ? theRecord.len : *len;
+
+	if (pReader->Read(n, buf) != n)
+		bEnd = true;
+
+	// the buffer of the code under test is smaller than the recorded one
+	if (n < theRecord.len)
+	{
+		numMismatches ++;
+		Skip(theRecord.len - n);
+	}
+	*len = n;
+	return theRecord.rcode;
+}
@@ -0,0 +1,69 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPREPLAY_H__
+#define __PTPREPLAY_H__
+
+#include "ptptransport.h"
+#include "ptprecorder.h"
+
+// Source of a recording made by PTPRecorder
+class PTPRecordReader
+{
+public:
+	// returns the number of bytes actually read, less than len at the end of the recording
+	virtual uint16_t Read(const uint16_t len, uint8_t *pbuf) = 0;
+};
+
+// Plays a recording back to PTP, CanonEOS, NikonDSLR or any other PTP based
+// class in place of the camera. Transfers are answered in the recorded order
+// with the recorded data and return codes, regardless of time, so the same
+// recording always gives the same result.
+//
+// A transfer of different direction or endpoint than the next record does not
+// consume it and fails with hrTIMEOUT, so an extra event poll of the code under
+// test does not break the rest of the replay. Sent data differing from the
+// recorded one is counted but does not stop the replay.
+class PTPReplay : public PTPTransport
+{
+	PTPRecordReader		*pReader;
+	PTPRecordHeader		theRecord;			// next record
+	bool				bPending;			// theRecord is read but not yet played
+	bool				bEnd;
+	uint32_t			timeNow;			// recorded time of the last played record, us
+	uint32_t			numPlayed;
+	uint16_t			numMismatches;		// transfers not matching the recording
+
+	bool Next(uint8_t ep_index, bool in);
+	void Skip(uint16_t len);
+
+public:
+	PTPReplay(PTPRecordReader *reader);
+
+	// Checks the file header. Returns false if it is not a recording.
+	bool Open();
+	bool IsEnd() { return bEnd; };
+
+	// PTPTransport implementation
+	virtual uint8_t OutTransfer(uint8_t ep_index, uint16_t len, uint8_t *buf);
+	virtual uint8_t InTransfer(uint8_t ep_index, uint16_t *len, uint8_t *buf);
+
+	uint32_t GetTime() { return timeNow; };
+	uint32_t GetCount() { return numPlayed; };
+	uint16_t GetMismatches() { return numMismatches; };
+};
+
+#endif // __PTPREPLAY_H__
@@ -0,0 +1,233 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpsession.h"
+
+void PTPChunkedDownload::Setup(uint32_t handle, PTPReadParser *sink, uint32_t size, uint32_t chunk_size)
+{
+	pSink		= sink;
+	objHandle	= handle;
+	objSize		= size;
+	chunkSize	= chunk_size;
+	bytesDone	= 0;
+	chunkBytes	= 0;
+	bDone		= false;
+}
+
+uint16_t PTPChunkedDownload::Step(PTP *ptp)
+{
+	chunkBytes = 0;
+
+	uint16_t	ptp_error = ptp->GetPartialObject(objHandle, bytesDone, chunkSize, this);
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("GetPartialObject error:", ptp_error);
+		bDone = true;
+		return ptp_error;
+	}
+	bytesDone += chunkBytes;
+
+	if (chunkBytes < chunkSize || (objSize && bytesDone >= objSize))
+		bDone = true;
+
+	return ptp_error;
+}
+
+void PTPChunkedDownload::Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset)
+{
+	// container header bytes in this packet, the header may be split over several
+	uint16_t	hdr = (offset < PTP_USB_BULK_HDR_LEN) ? (uint16_t)(PTP_USB_BULK_HDR_LEN - offset) : 0;
+
+	if (hdr > len)
+		hdr = len;
+
+	chunkBytes += len - hdr;
+
+	if (!pSink)
+		return;
+
+	if (!bytesDone)
+	{
+		pSink->Parse(len, pbuf, offset);
+		return;
+	}
+	// the container header of every chunk but the first is not part of the stream
+	if (len > hdr)
+		pSink->Parse(len - hdr, pbuf + hdr, bytesDone + offset + hdr);
+}
+
+PTPSessionManager::PTPSessionManager() :
+	numSlots(0),
+	curSlot(0),
+	stepsLeft(0)
+{
+}
+
+uint8_t PTPSessionManager::Add(PTP *ptp, PTPResettableParser *evt_parser, uint16_t poll_interval, uint8_t priority)
+{
+	if (numSlots >= PTP_SESSION_MAX_CAMERAS)
+		return 0xFF;
+
+	Slot	*s = theSlots + numSlots;
+
+	s->pPTP			= ptp;
+	s->pEvtParser	= evt_parser;
+	s->pollInterval	= poll_interval;
+	s->priority		= (priority) ? priority : 1;
+	s->nextPoll		= millis();
+	s->jobHead		= 0;
+
+	for (uint8_t i=0; i<PTP_SESSION_MAX_JOBS; i++)
+		s->theJobs[i] = NULL;
+
+	memset(&s->theStats, 0, sizeof(PTPSessionStats));
+
+	if (!numSlots)
+		stepsLeft = s->priority;
+
+	return numSlots++;
+}
+
+void PTPSessionManager::ResetStats(uint8_t cam)
+{
+	if (cam >= numSlots)
+		return;
+
+	PTPSessionStats	*st		= &theSlots[cam].theStats;
+	uint8_t			depth	= st->queueDepth;
+
+	memset(st, 0, sizeof(PTPSessionStats));
+	st->queueDepth	= depth;
+	st->maxQueue	= depth;
+}
+
+bool PTPSessionManager::Submit(uint8_t cam, PTPJob *job)
+{
+	if (cam >= numSlots || !job)
+		return false;
+
+	Slot	*s = theSlots + cam;
+
+	if (s->theStats.queueDepth >= PTP_SESSION_MAX_JOBS)
+		return false;
+
+	job->timeQueued = millis();
+	s->theJobs[(s->jobHead + s->theStats.queueDepth) % PTP_SESSION_MAX_JOBS] = job;
+
+	if (++s->theStats.queueDepth > s->theStats.maxQueue)
+		s->theStats.maxQueue = s->theStats.queueDepth;
+
+	return true;
+}
+
+// Polls the camera which is the most overdue, returns false if no poll is due
+bool PTPSessionManager::PollEvents()
+{
+	uint32_t	time_now	= millis();
+	uint8_t		n			= 0xFF;
+	int32_t		late		= -1;
+
+	for (uint8_t i=0; i<numSlots; i++)
+	{
+		int32_t		t = (int32_t)(time_now - theSlots[i].nextPoll);
+
+		if (t > late && IsReady(i))
+		{
+			late	= t;
+			n		= i;
+		}
+	}
+	if (n == 0xFF)
+		return false;
+
+	Slot		*s = theSlots + n;
+
+	// a poll cut short must not leave the parser in the middle of a container
+	if (s->pEvtParser)
+		s->pEvtParser->Reset();
+
+	uint16_t	rc = s->pPTP->EventCheck(s->pEvtParser);
+
+	if (rc == PTP_RC_GeneralError)
+		s->theStats.numErrors ++;
+
+	time_now = millis();
+
+	uint32_t	lat = time_now - s->nextPoll;
+
+	s->theStats.numPolls ++;
+	s->theStats.evtLatLast = lat;
+
+	if (lat > s->theStats.evtLatMax)
+		s->theStats.evtLatMax = lat;
+
+	s->nextPoll = time_now + s->pollInterval;
+	return true;
+}
+
+// Runs one step of the job of the camera whose turn it is, returns false if no job is queued
+bool PTPSessionManager::RunStep()
+{
+	for (uint8_t i=0; i<=numSlots; i++)
+	{
+		Slot	*s = theSlots + curSlot;
+
+		if (stepsLeft && s->theStats.queueDepth && IsReady(curSlot))
+		{
+			PTPJob		*job	= s->theJobs[s->jobHead];
+			uint16_t	rc		= job->Step(s->pPTP);
+
+			s->theStats.numSteps ++;
+			stepsLeft --;
+
+			if (rc != PTP_RC_OK || job->IsDone())
+			{
+				uint32_t	lat = millis() - job->timeQueued;
+
+				if (rc != PTP_RC_OK)
+					s->theStats.numErrors ++;
+
+				s->theJobs[s->jobHead]	= NULL;
+				s->jobHead				= (s->jobHead + 1) % PTP_SESSION_MAX_JOBS;
+				s->theStats.queueDepth --;
+				s->theStats.numJobs ++;
+				s->theStats.jobLatLast	= lat;
+
+				if (lat > s->theStats.jobLatMax)
+					s->theStats.jobLatMax = lat;
+
+				job->OnComplete(rc);
+			}
+			return true;
+		}
+		curSlot		= (curSlot + 1) % numSlots;
+		stepsLeft	= theSlots[curSlot].priority;
+	}
+	return false;
+}
+
+void PTPSessionManager::Task()
+{
+	if (!numSlots)
+		return;
+
+	// event polls which are due come before any job step
+	if (PollEvents())
+		return;
+
+	RunStep();
+}
@@ -0,0 +1,136 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPSESSION_H__
+#define __PTPSESSION_H__
+
+#include <ptp.h>
+
+#define PTP_SESSION_MAX_CAMERAS		8
+#define PTP_SESSION_MAX_JOBS		4		// jobs queued per camera
+#define PTP_SESSION_CHUNK_SIZE		16384	// GetPartialObject chunk, bytes
+#define PTP_SESSION_POLL_INTERVAL	100		// default event poll interval, ms
+
+// A unit of work for one camera, split into steps of one bounded transaction each
+class PTPJob
+{
+	friend class PTPSessionManager;
+
+	uint32_t	timeQueued;				// millis() of Submit()
+
+public:
+	PTPJob() : timeQueued(0) {};
+
+	// Runs the next transaction of the job
+	virtual uint16_t Step(PTP *ptp) = 0;
+	virtual bool IsDone() = 0;
+	virtual void OnComplete(uint16_t rc __attribute__ ((unused))) {};
+};
+
+// Object download in GetPartialObject chunks. The sink sees the same data
+// stream as with a single GetObject, the 12 byte container header included
+// once at offset 0. Vendor variants derive from it and replace Step().
+class PTPChunkedDownload : public PTPJob, public PTPReadParser
+{
+protected:
+	PTPReadParser	*pSink;
+	uint32_t		objHandle;
+	uint32_t		objSize;			// 0 - unknown, the first short chunk ends the download
+	uint32_t		chunkSize;
+	uint32_t		bytesDone;			// object bytes received
+	uint32_t		chunkBytes;			// object bytes received in the current chunk
+	bool			bDone;
+
+public:
+	PTPChunkedDownload() : pSink(NULL), objHandle(0), objSize(0), chunkSize(PTP_SESSION_CHUNK_SIZE), bytesDone(0), chunkBytes(0), bDone(true) {};
+
+	void Setup(uint32_t handle, PTPReadParser *sink, uint32_t size = 0, uint32_t chunk_size = PTP_SESSION_CHUNK_SIZE);
+	uint32_t GetBytesDone() { return bytesDone; };
+
+	// PTPJob implementation
+	virtual uint16_t Step(PTP *ptp);
+	virtual bool IsDone() { return bDone; };
+
+	// PTPReadParser implementation
+	virtual void Parse(const uint16_t len, const uint8_t *pbuf, const uint32_t &offset);
+};
+
+struct PTPSessionStats
+{
+	uint16_t	numPolls;
+	uint16_t	numSteps;				// job transactions
+	uint16_t	numJobs;				// jobs completed
+	uint16_t	numErrors;
+	uint8_t		queueDepth;
+	uint8_t		maxQueue;
+	uint32_t	evtLatLast;				// poll due time to poll completion, ms
+	uint32_t	evtLatMax;
+	uint32_t	jobLatLast;				// Submit() to job completion, ms
+	uint32_t	jobLatMax;
+};
+
+// Shares the USB bus between several cameras. PTP transactions cannot be
+// interleaved below the transaction level, so long transfers have to be split
+// into bounded steps (see PTPChunkedDownload) for the manager to switch
+// cameras in between. Event polls which are due go first, most overdue camera
+// first, so event latency is bounded by one step plus the polls of the other
+// cameras. Job steps are given out round-robin, priority being the number of
+// consecutive steps a camera gets in its turn.
+//
+// Task() is to be called from loop() after Usb.Task(). OnDeviceInitializedState
+// handlers of the managed cameras must not run transactions of their own.
+class PTPSessionManager
+{
+	struct Slot
+	{
+		PTP				*pPTP;
+		PTPResettableParser	*pEvtParser;
+		uint16_t		pollInterval;
+		uint8_t			priority;
+		uint32_t		nextPoll;
+		PTPJob			*theJobs[PTP_SESSION_MAX_JOBS];
+		uint8_t			jobHead;
+		PTPSessionStats	theStats;
+	};
+
+	Slot		theSlots[PTP_SESSION_MAX_CAMERAS];
+	uint8_t		numSlots;
+	uint8_t		curSlot;				// camera whose turn it is to run job steps
+	uint8_t		stepsLeft;				// steps left in the current turn
+
+	bool IsReady(uint8_t n) { return (theSlots[n].pPTP->GetState() == PTP_STATE_DEVICE_INITIALIZED); };
+	bool PollEvents();
+	bool RunStep();
+
+public:
+	PTPSessionManager();
+
+	// returns the camera index or 0xFF if there is no room left
+	// the event parser is reset before every poll
+	uint8_t Add(PTP *ptp, PTPResettableParser *evt_parser, uint16_t poll_interval = PTP_SESSION_POLL_INTERVAL, uint8_t priority = 1);
+
+	// returns false if the camera queue is full
+	bool Submit(uint8_t cam, PTPJob *job);
+
+	// Runs one transaction at most
+	void Task();
+
+	uint8_t GetQueueDepth(uint8_t cam) { return (cam < numSlots) ? theSlots[cam].theStats.queueDepth : 0; };
+	const PTPSessionStats* GetStats(uint8_t cam) { return (cam < numSlots) ? &theSlots[cam].theStats : NULL; };
+	void ResetStats(uint8_t cam);
+};
+
+#endif // __PTPSESSION_H__
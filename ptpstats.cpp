@@ -0,0 +1,148 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpstats.h"
+#include "ptpconst.h"
+
+void PTPStats::ResetTime(PTPPhaseTime *pt)
+{
+	pt->min = 0xFFFFFFFF;
+	pt->max = 0;
+	pt->sum = 0;
+}
+
+void PTPStats::AddTime(PTPPhaseTime *pt, uint32_t t)
+{
+	pt->sum += t;
+
+	if (t < pt->min)
+		pt->min = t;
+	if (t > pt->max)
+		pt->max = t;
+}
+
+void PTPStats::Reset()
+{
+	numOps		= 0;
+	numDropped	= 0;
+
+	usbStats.numTransfers	= 0;
+	usbStats.numErrors		= 0;
+	usbStats.numNAK			= 0;
+	usbStats.lastError		= 0;
+	usbStats.bytesIn		= 0;
+	usbStats.bytesOut		= 0;
+
+	timeStart = timeCommand = timeData = 0;
+	curIn = curOut = 0;
+}
+
+const PTPOpStats* PTPStats::Find(uint16_t opcode)
+{
+	for (uint8_t i=0; i<numOps; i++)
+		if (theOps[i].opCode == opcode)
+			return theOps + i;
+
+	return NULL;
+}
+
+void PTPStats::Begin()
+{
+	timeStart	= micros();
+	timeCommand	= timeStart;
+	timeData	= timeStart;
+	curIn		= 0;
+	curOut		= 0;
+}
+
+void PTPStats::OnTransfer(bool in, uint8_t rcode, uint16_t len)
+{
+	usbStats.numTransfers ++;
+
+	if (rcode == hrNAK)
+		usbStats.numNAK ++;
+	else if (rcode)
+	{
+		usbStats.numErrors ++;
+		usbStats.lastError = rcode;
+	}
+	if (rcode)
+		return;
+
+	if (in)
+	{
+		curIn			+= len;
+		usbStats.bytesIn+= len;
+	}
+	else
+	{
+		curOut				+= len;
+		usbStats.bytesOut	+= len;
+	}
+}
+
+void PTPStats::End(uint16_t opcode, uint16_t rc)
+{
+	uint32_t	time_end = micros();
+	PTPOpStats	*op = (PTPOpStats*)Find(opcode);
+
+	if (!op)
+	{
+		if (numOps >= PTP_STATS_MAX_OPCODES)
+		{
+			numDropped ++;
+			return;
+		}
+		op = theOps + numOps++;
+
+		op->opCode		= opcode;
+		op->count		= 0;
+		op->numFailed	= 0;
+		op->bytesIn		= 0;
+		op->bytesOut	= 0;
+
+		for (uint8_t i=0; i<PTP_PHASE_COUNT; i++)
+			ResetTime(op->phaseTime + i);
+
+		ResetTime(&op->totalTime);
+
+		for (uint8_t i=0; i<PTP_STATS_BUCKETS; i++)
+			op->histogram[i] = 0;
+	}
+	uint32_t	total = time_end - timeStart;
+
+	op->count ++;
+	op->bytesIn		+= curIn;
+	op->bytesOut	+= curOut;
+
+	if (rc != PTP_RC_OK)
+		op->numFailed ++;
+
+	AddTime(op->phaseTime + PTP_PHASE_COMMAND,	timeCommand - timeStart);
+	AddTime(op->phaseTime + PTP_PHASE_DATA,		timeData - timeCommand);
+	AddTime(op->phaseTime + PTP_PHASE_RESPONSE,	time_end - timeData);
+	AddTime(&op->totalTime, total);
+
+	// GetObject and other data transactions take tens of milliseconds and more,
+	// so the histogram counts in units of 64 us rather than single microseconds
+	uint32_t	units	= total >> PTP_STATS_BUCKET_SHIFT;
+	uint8_t		bucket	= 0;
+
+	while ((units >>= 1) && bucket < PTP_STATS_BUCKETS - 1)
+		bucket ++;
+
+	op->histogram[bucket] ++;
+}
@@ -0,0 +1,100 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPSTATS_H__
+#define __PTPSTATS_H__
+
+#include <Usb.h>
+
+#define PTP_STATS_MAX_OPCODES		8		// operations tracked, the rest is counted in numDropped
+#define PTP_STATS_BUCKETS			16		// bucket n counts transactions of 2^n to 2^(n+1)-1 units, bucket 0 everything shorter
+#define PTP_STATS_BUCKET_SHIFT		6		// histogram unit of 2^6 = 64 us, the top bucket starts at about 2 s
+
+// Transaction phases
+#define PTP_PHASE_COMMAND			0		// command block sent
+#define PTP_PHASE_DATA				1		// data stage in either direction
+#define PTP_PHASE_RESPONSE			2		// end of data (or command) to the response received
+#define PTP_PHASE_COUNT				3
+
+// Times in microseconds
+struct PTPPhaseTime
+{
+	uint32_t	min;
+	uint32_t	max;
+	uint32_t	sum;					// sum / count gives the average
+};
+
+struct PTPOpStats
+{
+	uint16_t		opCode;
+	uint16_t		count;
+	uint16_t		numFailed;			// response code other than PTP_RC_OK
+	PTPPhaseTime	phaseTime[PTP_PHASE_COUNT];
+	PTPPhaseTime	totalTime;
+	uint16_t		histogram[PTP_STATS_BUCKETS];
+	uint32_t		bytesIn;
+	uint32_t		bytesOut;
+};
+
+// Bulk pipe transfers of all operations
+struct PTPUsbStats
+{
+	uint32_t	numTransfers;
+	uint16_t	numErrors;				// transfers failed for any reason but NAK
+	uint16_t	numNAK;					// transfers given up after the NAK limit
+	uint8_t		lastError;				// last USB error code
+	uint32_t	bytesIn;
+	uint32_t	bytesOut;
+};
+
+// Transaction statistics of one PTP device, see PTP::SetStats(). Costs nothing
+// unless attached.
+class PTPStats
+{
+	PTPOpStats		theOps[PTP_STATS_MAX_OPCODES];
+	uint8_t			numOps;
+	uint16_t		numDropped;			// transactions of operations not fitting in theOps
+	PTPUsbStats		usbStats;
+
+	// transaction in progress
+	uint32_t		timeStart;
+	uint32_t		timeCommand;
+	uint32_t		timeData;
+	uint32_t		curIn;
+	uint32_t		curOut;
+
+	static void AddTime(PTPPhaseTime *pt, uint32_t t);
+	static void ResetTime(PTPPhaseTime *pt);
+
+public:
+	PTPStats() { Reset(); };
+
+	// called by PTP::Transaction
+	void Begin();
+	void CommandSent() { timeData = timeCommand = micros(); };
+	void DataTransferred() { timeData = micros(); };
+	void End(uint16_t opcode, uint16_t rc);
+	void OnTransfer(bool in, uint8_t rcode, uint16_t len);
+
+	uint8_t GetCount() { return numOps; };
+	uint16_t GetDropped() { return numDropped; };
+	const PTPOpStats* GetOp(uint8_t index) { return (index < numOps) ? theOps + index : NULL; };
+	const PTPOpStats* Find(uint16_t opcode);
+	const PTPUsbStats* GetUsbStats() { return &usbStats; };
+	void Reset();
+};
+
+#endif // __PTPSTATS_H__
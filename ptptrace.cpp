@@ -0,0 +1,75 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpdebug.h"
+
+#if defined( PTPTRACEBIN )
+
+PTPTraceRecord	PTPTrace::theRecords[PTP_TRACE_SIZE];
+uint8_t			PTPTrace::theHead		= 0;
+uint32_t		PTPTrace::numRecorded	= 0;
+uint16_t		PTPTrace::curOpCode		= 0;
+uint16_t		PTPTrace::curTransID	= 0;
+
+void PTPTrace::Record(uint16_t id, uint32_t val)
+{
+	PTPTraceRecord	*p = theRecords + theHead;
+
+	p->timeStamp	= micros();
+	p->traceID		= id;
+	p->opCode		= curOpCode;
+	p->transID		= curTransID;
+	p->theValue		= val;
+
+	theHead = (theHead + 1) % PTP_TRACE_SIZE;
+	numRecorded ++;
+}
+
+void PTPTrace::Clear()
+{
+	theHead		= 0;
+	numRecorded	= 0;
+}
+
+void PTPTrace::Dump()
+{
+	uint8_t		count	= (numRecorded < PTP_TRACE_SIZE) ? (uint8_t)numRecorded : PTP_TRACE_SIZE;
+	uint8_t		index	= (theHead + PTP_TRACE_SIZE - count) % PTP_TRACE_SIZE;
+
+	E_Notify(PSTR("\r\nPTPTRACE "), 0x80);
+	PrintHex<uint32_t>(numRecorded, 0x80);
+	E_Notify(PSTR(" "), 0x80);
+	PrintHex<uint8_t>(PTP_TRACE_SIZE, 0x80);
+
+	for (; count; count--, index = (index + 1) % PTP_TRACE_SIZE)
+	{
+		PTPTraceRecord	*p = theRecords + index;
+
+		E_Notify(PSTR("\r\n"), 0x80);
+		PrintHex<uint32_t>(p->timeStamp, 0x80);
+		E_Notify(PSTR(" "), 0x80);
+		PrintHex<uint16_t>(p->traceID, 0x80);
+		E_Notify(PSTR(" "), 0x80);
+		PrintHex<uint16_t>(p->opCode, 0x80);
+		E_Notify(PSTR(" "), 0x80);
+		PrintHex<uint16_t>(p->transID, 0x80);
+		E_Notify(PSTR(" "), 0x80);
+		PrintHex<uint32_t>(p->theValue, 0x80);
+	}
+	E_Notify(PSTR("\r\n"), 0x80);
+}
+
+#endif // PTPTRACEBIN
@@ -0,0 +1,57 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPTRACE_H__
+#define __PTPTRACE_H__
+
+#include <Usb.h>
+
+#define PTP_TRACE_SIZE		16		// records in the ring buffer, 14 bytes each
+
+// One trace point hit. The message itself is not stored, traceID is its
+// address in flash, which the host decoder (tools/ptptrace.py) looks up in
+// the ELF file of the sketch.
+struct PTPTraceRecord
+{
+	uint32_t	timeStamp;			// micros()
+	uint16_t	traceID;
+	uint16_t	opCode;				// operation in progress
+	uint16_t	transID;			// its transaction ID
+	uint32_t	theValue;
+};
+
+// RAM ring buffer of trace records. Recording takes a micros() call and a
+// 14 byte copy, so tracing can be left enabled without changing the timing
+// of the camera communication.
+class PTPTrace
+{
+	static PTPTraceRecord	theRecords[PTP_TRACE_SIZE];
+	static uint8_t			theHead;			// next record to be written
+	static uint32_t			numRecorded;		// records written since the last Clear()
+	static uint16_t			curOpCode;
+	static uint16_t			curTransID;
+
+public:
+	static void Record(uint16_t id, uint32_t val);
+	static void SetTransaction(uint16_t opcode, uint16_t trans_id) { curOpCode = opcode; curTransID = trans_id; };
+
+	// Prints the records oldest first, one per line in hex:
+	// "PTPTRACE <recorded> <size>" followed by "<time> <id> <opcode> <transaction> <value>"
+	static void Dump();
+	static void Clear();
+};
+
+#endif // __PTPTRACE_H__
@@ -0,0 +1,32 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPTRANSPORT_H__
+#define __PTPTRANSPORT_H__
+
+#include <Usb.h>
+
+// Pipe level access of PTP. When attached with PTP::SetTransport() it takes
+// the place of the USB host for the bulk and interrupt pipes. Endpoints are
+// given by their PTP index: 1 - data in, 2 - data out, 3 - interrupt.
+class PTPTransport
+{
+public:
+	virtual uint8_t OutTransfer(uint8_t ep_index, uint16_t len, uint8_t *buf) = 0;
+	virtual uint8_t InTransfer(uint8_t ep_index, uint16_t *len, uint8_t *buf) = 0;
+};
+
+#endif // __PTPTRANSPORT_H__
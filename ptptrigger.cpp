@@ -0,0 +1,217 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptptrigger.h"
+#include "ptpdebug.h"
+
+PTPTriggerGroup::PTPTriggerGroup() :
+	numCameras(0),
+	pollIndex(0),
+	bWaiting(false),
+	bReorder(false),
+	timeFirst(0),
+	timeFired(0)
+{
+	for (uint8_t i=0; i<PTP_TRIGGER_MAX_CAMERAS; i++)
+	{
+		theCameras[i]	= NULL;
+		theOrder[i]		= i;
+	}
+	memset(camStats, 0, sizeof(camStats));
+	ResetStats();
+}
+
+void PTPTriggerGroup::ResetStats()
+{
+	memset(&theStats, 0, sizeof(theStats));
+}
+
+uint8_t PTPTriggerGroup::Add(PTPTriggerCamera *cam)
+{
+	if (numCameras >= PTP_TRIGGER_MAX_CAMERAS)
+		return 0xFF;
+
+	theCameras[numCameras] = cam;
+	return numCameras++;
+}
+
+uint16_t PTPTriggerGroup::Arm()
+{
+	uint16_t	ptp_error = PTP_RC_OK;
+
+	for (uint8_t i=0; i<numCameras; i++)
+	{
+		uint16_t	rc = theCameras[i]->Arm();
+
+		if (rc != PTP_RC_OK)
+		{
+			PTPTRACE2("Trigger arm error:", rc);
+			ptp_error = rc;
+		}
+	}
+	return ptp_error;
+}
+
+uint16_t PTPTriggerGroup::Fire()
+{
+	if (!numCameras || bWaiting)
+		return PTP_RC_DeviceBusy;
+
+	for (uint8_t i=0; i<numCameras; i++)
+		theCameras[i]->bCreated = false;
+
+	uint16_t	ptp_error = PTP_RC_OK;
+
+	timeFired = millis();
+	timeFirst = micros();
+
+	// only the command containers between the timestamps, the responses come later
+	for (uint8_t i=0; i<numCameras; i++)
+	{
+		uint8_t		n = theOrder[i];
+
+		camStats[n].timeFired	= micros();
+		camStats[n].rc			= theCameras[n]->BeginFire();
+	}
+	for (uint8_t i=0; i<numCameras; i++)
+	{
+		uint8_t		n = theOrder[i];
+
+		if (camStats[n].rc == PTP_RC_OK)
+			camStats[n].rc = theCameras[n]->EndFire();
+	}
+	uint32_t	cmd_first = 0xFFFFFFFF, cmd_last = 0;
+
+	for (uint8_t i=0; i<numCameras; i++)
+	{
+		PTPTriggerCamStats	*st = camStats + i;
+
+		st->timeFired	-= timeFirst;
+		st->bReported	= false;
+
+		if (st->rc != PTP_RC_OK)
+		{
+			PTPTRACE2("Trigger capture error:", st->rc);
+			ptp_error = st->rc;
+			continue;
+		}
+		if (st->timeFired < cmd_first)
+			cmd_first = st->timeFired;
+		if (st->timeFired > cmd_last)
+			cmd_last = st->timeFired;
+	}
+	theStats.cmdSkewLast = (cmd_last > cmd_first) ? cmd_last - cmd_first : 0;
+
+	if (ptp_error != PTP_RC_OK)
+		theStats.numErrors ++;
+
+	pollIndex	= 0;
+	bWaiting	= true;
+
+	return ptp_error;
+}
+
+uint16_t PTPTriggerGroup::Task()
+{
+	if (!bWaiting)
+		return PTP_RC_OK;
+
+	uint8_t		waiting = 0;
+
+	for (uint8_t i=0; i<numCameras; i++)
+		if (camStats[i].rc == PTP_RC_OK && !theCameras[i]->bCreated)
+			waiting ++;
+
+	if (!waiting || millis() - timeFired > PTP_TRIGGER_TIMEOUT)
+	{
+		Complete();
+		return PTP_RC_OK;
+	}
+	// next camera still waiting for its capture to be reported
+	while (camStats[pollIndex].rc != PTP_RC_OK || theCameras[pollIndex]->bCreated)
+		pollIndex = (pollIndex + 1) % numCameras;
+
+	uint16_t	ptp_error = theCameras[pollIndex]->Poll();
+
+	pollIndex = (pollIndex + 1) % numCameras;
+	return ptp_error;
+}
+
+void PTPTriggerGroup::Complete()
+{
+	uint32_t	evt_first = 0xFFFFFFFF, evt_last = 0;
+	bool		timeout = false;
+
+	for (uint8_t i=0; i<numCameras; i++)
+	{
+		PTPTriggerCamStats	*st = camStats + i;
+
+		if (st->rc != PTP_RC_OK)
+			continue;
+
+		if (!theCameras[i]->bCreated)
+		{
+			timeout = true;
+			continue;
+		}
+		st->bReported	= true;
+		st->timeCreated	= theCameras[i]->timeCreated - timeFirst;
+		st->lagLast		= st->timeCreated - st->timeFired;
+
+		if (!st->lagEstimate)
+			st->lagEstimate = st->lagLast;
+		else
+			st->lagEstimate += ((int32_t)st->lagLast - (int32_t)st->lagEstimate) / PTP_TRIGGER_LAG_DIVIDER;
+
+		if (st->timeCreated < evt_first)
+			evt_first = st->timeCreated;
+		if (st->timeCreated > evt_last)
+			evt_last = st->timeCreated;
+	}
+	theStats.evtSkewLast = (evt_last > evt_first) ? evt_last - evt_first : 0;
+
+	if (timeout)
+		theStats.numTimeouts ++;
+
+	theStats.numShots ++;
+	theStats.cmdSkewSum	+= theStats.cmdSkewLast;
+	theStats.evtSkewSum	+= theStats.evtSkewLast;
+
+	if (theStats.cmdSkewLast > theStats.cmdSkewMax)
+		theStats.cmdSkewMax = theStats.cmdSkewLast;
+	if (theStats.evtSkewLast > theStats.evtSkewMax)
+		theStats.evtSkewMax = theStats.evtSkewLast;
+
+	if (bReorder)
+		Reorder();
+
+	bWaiting = false;
+}
+
+// Insertion sort by descending lag estimate
+void PTPTriggerGroup::Reorder()
+{
+	for (uint8_t i=1; i<numCameras; i++)
+	{
+		uint8_t		n = theOrder[i];
+		uint8_t		j = i;
+
+		for (; j && camStats[theOrder[j-1]].lagEstimate < camStats[n].lagEstimate; j--)
+			theOrder[j] = theOrder[j-1];
+
+		theOrder[j] = n;
+	}
+}
@@ -0,0 +1,127 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPTRIGGER_H__
+#define __PTPTRIGGER_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include "ptpconst.h"
+
+#define PTP_TRIGGER_MAX_CAMERAS		4
+#define PTP_TRIGGER_TIMEOUT			5000	// longest wait for all cameras to report the capture, ms
+#define PTP_TRIGGER_LAG_DIVIDER		4		// lag estimate moves by 1/4 of the difference per shot
+
+// One camera of a trigger group. Poll() reads the camera events and calls
+// Created() once the camera reports the object or the capture complete.
+class PTPTriggerCamera
+{
+	friend class PTPTriggerGroup;
+
+	bool		bCreated;
+	uint32_t	timeCreated;			// micros() of the Created() call
+
+protected:
+	void Created() { if (!bCreated) { bCreated = true; timeCreated = micros(); } };
+
+public:
+	PTPTriggerCamera() : bCreated(false), timeCreated(0) {};
+
+	// Everything that can be done before the shot, i.e. draining the event queue
+	virtual uint16_t Arm() { return PTP_RC_OK; };
+	// The capture command in two halves, BeginFire() sends it and EndFire() waits for the response
+	virtual uint16_t BeginFire() = 0;
+	virtual uint16_t EndFire() = 0;
+	virtual uint16_t Poll() = 0;
+};
+
+struct PTPTriggerCamStats
+{
+	uint32_t	timeFired;				// capture command start relative to the first one, us
+	uint32_t	timeCreated;			// reported capture relative to the first command, us
+	uint32_t	lagLast;				// capture command to reported capture, us
+	uint32_t	lagEstimate;
+	uint16_t	rc;						// capture command response code
+	bool		bReported;
+};
+
+struct PTPTriggerStats
+{
+	uint16_t	numShots;
+	uint16_t	numErrors;				// shots with at least one capture command failed
+	uint16_t	numTimeouts;			// shots with at least one camera not reporting the capture
+	uint32_t	cmdSkewLast;			// first to last capture command, us
+	uint32_t	cmdSkewMax;
+	uint32_t	cmdSkewSum;				// cmdSkewSum / numShots gives the average
+	uint32_t	evtSkewLast;			// first to last reported capture, us
+	uint32_t	evtSkewMax;
+	uint32_t	evtSkewSum;
+};
+
+// Fires several cameras as close together as possible. The capture commands
+// go out back-to-back without waiting for the responses, which are collected
+// once every camera has its command. The command skew is then the time of one
+// bulk transfer per camera rather than one transaction. Afterwards the cameras
+// are polled in turn until each of them reports the capture. The reported
+// times are known to within one poll round only, as none of the cameras
+// timestamps its events.
+class PTPTriggerGroup
+{
+	PTPTriggerCamera	*theCameras[PTP_TRIGGER_MAX_CAMERAS];
+	PTPTriggerCamStats	camStats[PTP_TRIGGER_MAX_CAMERAS];
+	uint8_t				theOrder[PTP_TRIGGER_MAX_CAMERAS];	// send order
+	uint8_t				numCameras;
+	uint8_t				pollIndex;
+	bool				bWaiting;
+	bool				bReorder;
+	uint32_t			timeFirst;		// micros() of the first capture command
+	uint32_t			timeFired;		// millis() of the first capture command
+
+	PTPTriggerStats		theStats;
+
+	void Complete();
+	void Reorder();
+
+public:
+	PTPTriggerGroup();
+
+	// returns the camera index or 0xFF if the group is full
+	uint8_t Add(PTPTriggerCamera *cam);
+
+	// Sends the cameras with the longest measured shutter lag first
+	void SetReorder(bool reorder) { bReorder = reorder; };
+
+	uint16_t Arm();
+	uint16_t Fire();
+	bool IsWaiting() { return bWaiting; };
+
+	// Should be called from OnDeviceInitializedState of any of the cameras
+	// while IsWaiting(). Polls one camera per call.
+	uint16_t Task();
+
+	uint8_t GetCameraCount() { return numCameras; };
+	const PTPTriggerStats* GetStats() { return &theStats; };
+	const PTPTriggerCamStats* GetCameraStats(uint8_t index) { return (index < numCameras) ? camStats + index : NULL; };
+	void ResetStats();
+};
+
+#endif // __PTPTRIGGER_H__
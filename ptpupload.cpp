@@ -0,0 +1,129 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#include "ptpupload.h"
+
+PTPObjectInfoSupplier::PTPObjectInfoSupplier(uint16_t format, uint32_t size, const char *name) :
+	objFormat(format),
+	objSize(size),
+	pName(name),
+	nameLen(0),
+	thePos(0)
+{
+	uint16_t	n = strlen(name);
+
+	// PTP strings hold 255 characters at most
+	nameLen = (n) ? ((n < 254) ? n + 1 : 255) : 0;
+}
+
+uint32_t PTPObjectInfoSupplier::GetDataSize()
+{
+	// file name, empty CaptureDate, ModificationDate and Keywords
+	return PTP_OBJINFO_FIXED_LEN + 1 + ((uint16_t)nameLen << 1) + 3;
+}
+
+uint8_t PTPObjectInfoSupplier::ByteAt(uint16_t pos)
+{
+	if (pos < PTP_OBJINFO_FIXED_LEN)
+	{
+		switch (pos)
+		{
+		// StorageID and ParentObject are taken from the operation parameters
+		case 4:
+		case 5:
+			return (uint8_t)(objFormat >> ((pos - 4) << 3));
+		case 8:
+		case 9:
+		case 10:
+		case 11:
+			return (uint8_t)(objSize >> ((pos - 8) << 3));
+		}
+		// ProtectionStatus, thumbnail and image geometry, association and sequence number
+		return 0;
+	}
+	pos -= PTP_OBJINFO_FIXED_LEN;
+
+	if (!pos)
+		return nameLen;
+
+	pos --;
+
+	if (pos < ((uint16_t)nameLen << 1))
+		// UCS-2 little endian, the terminating zero included
+		return ((pos & 1) || (pos >> 1) == nameLen - 1) ? 0 : (uint8_t)pName[pos >> 1];
+
+	return 0;
+}
+
+void PTPObjectInfoSupplier::GetData(const uint16_t len, uint8_t *pbuf)
+{
+	for (uint16_t i=0; i<len; i++, thePos++)
+		pbuf[i] = ByteAt(thePos);
+}
+
+void PTPBufferSupplier::GetData(const uint16_t len, uint8_t *pbuf)
+{
+	uint16_t	n = (theSize - thePos < len) ? (uint16_t)(theSize - thePos) : len;
+
+	if (bProgmem)
+		memcpy_P(pbuf, pData + thePos, n);
+	else
+		memcpy(pbuf, pData + thePos, n);
+
+	thePos += n;
+}
+
+uint16_t PTPUpload::Send(PTP *ptp, uint32_t storage_id, uint32_t parent, PTPDataSupplier *info, PTPDataSupplier *data)
+{
+	uint16_t	ptp_error;
+	uint32_t	t = micros();
+
+	objHandle			= 0;
+	theStats.numBytes	= 0;
+	theStats.timeStart	= theStats.timeEnd = millis();
+
+	ptp->SetTxBuffer(pBuffer, bufSize);
+
+	if ((ptp_error = ptp->SendObjectInfo(storage_id, parent, info, objHandle)) != PTP_RC_OK)
+	{
+		ptp->SetTxBuffer(NULL, 0);
+		PTPTRACE2("Upload SendObjectInfo error:", ptp_error);
+		return ptp_error;
+	}
+	theStats.timeInfo	= micros() - t;
+	theStats.timeStart	= millis();
+
+	ptp_error = ptp->SendObject(data);
+
+	ptp->SetTxBuffer(NULL, 0);
+	theStats.timeEnd = millis();
+
+	if (ptp_error != PTP_RC_OK)
+	{
+		PTPTRACE2("Upload SendObject error:", ptp_error);
+		return ptp_error;
+	}
+	theStats.numBytes = data->GetDataSize();
+
+	return ptp_error;
+}
+
+uint32_t PTPUpload::GetRate()
+{
+	uint32_t	elapsed = theStats.timeEnd - theStats.timeStart;
+
+	return (elapsed) ? (uint32_t)((uint64_t)theStats.numBytes * 1000 / 1024 / elapsed) : 0;
+}
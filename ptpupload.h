@@ -0,0 +1,106 @@
+/* Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+
+This software may be distributed and modified under the terms of the GNU
+General Public License version 2 (GPL2) as published by the Free Software
+Foundation and appearing in the file GPL2.TXT included in the packaging of
+this file. Please note that GPL2 Section 2[b] requires that all works based
+on this software must also be made publicly available under the terms of
+the GPL2 ("Copyleft").
+
+Contact information
+-------------------
+
+Circuits At Home, LTD
+Web      :  http://www.circuitsathome.com
+e-mail   :  support@circuitsathome.com
+*/
+#ifndef __PTPUPLOAD_H__
+#define __PTPUPLOAD_H__
+
+#include <inttypes.h>
+
+#if defined(ARDUINO) && ARDUINO >=100
+#include <Arduino.h>
+#else
+#include <WProgram.h>
+#endif
+
+#include "ptp.h"
+
+#define PTP_OBJINFO_FIXED_LEN		52		// ObjectInfo dataset up to the file name
+
+// ObjectInfo dataset for SendObjectInfo, produced in pieces of any size.
+// The name has to stay in place until the transaction is over.
+class PTPObjectInfoSupplier : public PTPDataSupplier
+{
+	uint16_t	objFormat;
+	uint32_t	objSize;
+	const char	*pName;
+	uint8_t		nameLen;				// characters including the terminating zero
+	uint16_t	thePos;					// next byte of the dataset
+
+	uint8_t ByteAt(uint16_t pos);
+
+public:
+	PTPObjectInfoSupplier(uint16_t format, uint32_t size, const char *name);
+
+	void Reset() { thePos = 0; };
+
+	// PTPDataSupplier implementation
+	virtual uint32_t GetDataSize();
+	virtual void GetData(const uint16_t len, uint8_t *pbuf);
+};
+
+// Object held in memory, program memory on AVR if bProgmem is set
+class PTPBufferSupplier : public PTPDataSupplier
+{
+	const uint8_t	*pData;
+	uint32_t		theSize;
+	uint32_t		thePos;
+	bool			bProgmem;
+
+public:
+	PTPBufferSupplier(const uint8_t *data, uint32_t size, bool progmem = false) : pData(data), theSize(size), thePos(0), bProgmem(progmem) {};
+
+	void Reset() { thePos = 0; };
+
+	// PTPDataSupplier implementation
+	virtual uint32_t GetDataSize() { return theSize; };
+	virtual void GetData(const uint16_t len, uint8_t *pbuf);
+};
+
+struct PTPUploadStats
+{
+	uint32_t	numBytes;			// object bytes sent
+	uint32_t	timeInfo;			// SendObjectInfo transaction, microseconds
+	uint32_t	timeStart;			// millis() at the start of SendObject
+	uint32_t	timeEnd;			// millis() at the end of SendObject
+};
+
+// Object upload, SendObjectInfo followed by SendObject. The object data go
+// out in chunks of the buffer size, one GetData() call each, so a file
+// supplier reads whole blocks ahead of the transfer instead of 64 bytes at
+// a time. The buffer should be a multiple of the bulk packet size, 512 bytes
+// make 8 full speed packets per transfer.
+class PTPUpload
+{
+	uint8_t				*pBuffer;
+	uint16_t			bufSize;
+	uint32_t			objHandle;
+	PTPUploadStats		theStats;
+
+public:
+	PTPUpload(uint8_t *buf, uint16_t size) : pBuffer(buf), bufSize(size), objHandle(0) {};
+
+	// storage_id and parent as for PTP::SendObjectInfo()
+	uint16_t Send(PTP *ptp, uint32_t storage_id, uint32_t parent, PTPDataSupplier *info, PTPDataSupplier *data);
+
+	// handle reserved by the camera, valid after a successful SendObjectInfo
+	uint32_t GetHandle() { return objHandle; };
+
+	const PTPUploadStats* GetStats() { return &theStats; };
+	// kilobytes per second of the SendObject transaction
+	uint32_t GetRate();
+};
+
+#endif // __PTPUPLOAD_H__
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+# Copyright (C) 2011 Circuits At Home, LTD. All rights reserved.
+#
+# This software may be distributed and modified under the terms of the GNU
+# General Public License version 2 (GPL2) as published by the Free Software
+# Foundation and appearing in the file GPL2.TXT included in the packaging of
+# this file. Please note that GPL2 Section 2[b] requires that all works based
+# on this software must also be made publicly available under the terms of
+# the GPL2 ("Copyleft").
+#
+# Decodes the output of PTPTrace::Dump().
+#
+#   ptptrace.py sketch.elf dump.txt [library_dir]
+#
+# Trace IDs are flash addresses of the trace messages, which are read from
+# the ELF file the sketch was built into. Operation codes are named after the
+# *_OC_* definitions found in the library headers.
+
+import os
+import re
+import struct
+import sys
+
+SHT_PROGBITS = 1
+AVR_DATA_VMA = 0x800000
+
+
+def load_flash_sections(path):
+    with open(path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF' or elf[4] != 1:
+        raise ValueError('%s: not a 32 bit ELF file' % path)
+    shoff, = struct.unpack_from('<I', elf, 0x20)
+    shentsize, shnum = struct.unpack_from('<HH', elf, 0x2E)
+    sections = []
+    for i in range(shnum):
+        (name, stype, flags, addr, offset, size) = struct.unpack_from('<IIIIII', elf, shoff + i * shentsize)
+        if stype == SHT_PROGBITS and addr < AVR_DATA_VMA and size:
+            sections.append((addr, elf[offset:offset + size]))
+    return sections
+
+
+def flash_string(sections, addr):
+    for base, data in sections:
+        if base <= addr < base + len(data):
+            end = data.find(b'\0', addr - base)
+            return data[addr - base:end].decode('ascii', 'replace').strip()
+    return '<id %04X>' % addr
+
+
+def load_opcode_names(lib_dir):
+    names = {}
+    pattern = re.compile(r'#define\s+(\w*_OC_\w+)\s+(0x[0-9A-Fa-f]+)')
+    for fname in sorted(os.listdir(lib_dir)):
+        if not fname.endswith('.h'):
+            continue
+        with open(os.path.join(lib_dir, fname), errors='replace') as f:
+            for m in pattern.finditer(f.read()):
+                names.setdefault(int(m.group(2), 16), m.group(1))
+    return names
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write('usage: %s sketch.elf dump.txt [library_dir]\n' % argv[0])
+        return 1
+    lib_dir = argv[3] if len(argv) > 3 else os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+    sections = load_flash_sections(argv[1])
+    opnames = load_opcode_names(lib_dir)
+
+    with open(argv[2], errors='replace') as f:
+        lines = [l.split() for l in f if l.strip()]
+
+    start = None
+    for fields in lines:
+        if fields[0] == 'PTPTRACE':
+            recorded, size = int(fields[1], 16), int(fields[2], 16)
+            lost = recorded - size if recorded > size else 0
+            print('%d records, %d overwritten' % (recorded, lost))
+            start = None
+            continue
+        if len(fields) != 5:
+            continue
+        try:
+            t, tid, op, trans, val = [int(x, 16) for x in fields]
+        except ValueError:
+            continue
+        if start is None:
+            start = t
+        print('%10d us  %-32s %04X  %-40s %08X' % ((t - start) & 0xFFFFFFFF,
+              opnames.get(op, '%04X' % op), trans, flash_string(sections, tid), val))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -96,7 +96,7 @@ class EEPROMByteList
         uint16_t tail = listOffset+listSize+2;
                 
 		for (uint16_t i=listOffset+1; i<tail; i++)
-			if (eeprom_read_byte((uint8_t*)i) == val)
+			if (eeprom_read_byte((uint8_t*)(uintptr_t)i) == val)
                                 return i;
 
 		return 0xffff;
@@ -118,8 +118,8 @@ public:
     {
             listSize = (size < maxListSize) ? size : maxListSize;
             
-            if (eeprom_read_byte((uint8_t*) listOffset) != listSize) 
-                    eeprom_write_byte((uint8_t*) listOffset, listSize);
+            if (eeprom_read_byte((uint8_t*)(uintptr_t)listOffset) != listSize) 
+                    eeprom_write_byte((uint8_t*)(uintptr_t)listOffset, listSize);
     };
         
     uint8_t GetSize()
@@ -130,7 +130,7 @@ public:
     
     uint8_t Get(uint8_t i)
     {
-         return (eeprom_read_byte((uint8_t*)(listOffset + 1 + ((i < listSize) ? i : listOffset+listSize-1))));
+         return (eeprom_read_byte((uint8_t*)(uintptr_t)(listOffset + 1 + ((i < listSize) ? i : listOffset+listSize-1))));
     };
     
     void Set(uint8_t i, uint8_t val)
@@ -139,8 +139,8 @@ public:
         {
             uint16_t pos = listOffset + i + 1;
             
-            if (eeprom_read_byte((uint8_t*) pos) != val)
-                eeprom_write_byte((uint8_t*) pos, val);
+            if (eeprom_read_byte((uint8_t*)(uintptr_t)pos) != val)
+                eeprom_write_byte((uint8_t*)(uintptr_t)pos, val);
         }
     };
         
@@ -151,11 +151,11 @@ public:
 		uint16_t tail = listOffset+listSize;
 
 		if (addr == 0xffff)
-			return eeprom_read_byte((uint8_t*)tail);
+			return eeprom_read_byte((uint8_t*)(uintptr_t)tail);
 
 		addr += di;
 
-    	return eeprom_read_byte((uint8_t*)((addr > tail) ? tail : addr));
+    	return eeprom_read_byte((uint8_t*)(uintptr_t)((addr > tail) ? tail : addr));
 	};
 
 	uint8_t GetPrev(uint8_t val, uint8_t di=1)
@@ -163,11 +163,11 @@ public:
 		uint16_t addr = GetValueAddress(val);
 
 		if (addr == 0xffff)
-			return eeprom_read_byte((uint8_t*)(listOffset+1));
+			return eeprom_read_byte((uint8_t*)(uintptr_t)(listOffset+1));
 
 		addr -= di;
 
-    	return eeprom_read_byte((uint8_t*)((addr <= listOffset) ? listOffset+1 : addr));
+    	return eeprom_read_byte((uint8_t*)(uintptr_t)((addr <= listOffset) ? listOffset+1 : addr));
 	};
 };
 